@@ -0,0 +1,190 @@
+/*
+ Title: ApplyDelta.cpp
+ Description: Updates an AVL tree built from one release of the enzyme database to the next by applying only the
+        change, and compares that with rebuilding the tree from scratch. The same delta is then applied to a
+        PersistentAvlTree, keeping both releases as versions, and the releases are compared with diff().
+ Usage: ApplyDelta <database filename> <new database filename>
+        ApplyDelta <database filename> -changes <change filename>
+        The first form diffs the two databases; the second reads '+'/'-' lines as described in DatabaseDelta.h.
+ Build with: make ApplyDelta
+ Modifications:
+    10.19.2026: The database loader moves each SequenceMap into the tree instead of copying it.
+    10.19.2026: The delta-applied tree is checked against the rebuilt one pair by pair, not only by node count.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <fstream>
+#include <chrono>
+#include <stdlib.h>
+#include "SequenceMap.h"
+#include "AvlTree.h"
+#include "DatabaseDelta.h"
+#include "PersistentAvlTree.h"
+
+/**
+  * Checks to make sure a file opens and issues an error message if not.
+ */
+void CheckFile(const std::string& filename);
+
+/**
+  * FillTree() takes the input from db_filename, parses it and stores it in a_tree as SequenceMap objects.
+  * Pre-Condition: a_tree is empty.
+  * Pre-Condition: Each line in db_filename in this format: EnzymeAcronym/Sequence1/Sequence2/.../Sequence n//
+  * Pre-Condition: The file provided has a 10 line header that will be skipped over.
+ */
+template <typename TreeType>
+void FillTree(const std::string& db_filename, TreeType &a_tree);
+
+/**
+  * GetEnzymeAcronym() takes a line from a file and returns the Enzyme Acronym.
+ */
+std::string GetEnzymeAcronym(const std::string& db_line, size_t first_slash);
+
+/**
+  * Parses the db_line string to pull out the next sequence after first_slash. Returns false when none remain.
+ */
+bool GetNextRecognitionSequence(const std::string& db_line, std::string& a_reco_seq, size_t& first_slash);
+
+/**
+  * Returns every (recognition sequence, enzyme acronym) pair in a_tree, sorted. A delta appends an acronym after
+  * those a sequence already has while a rebuild keeps file order, so two trees are compared by their pairs.
+ */
+std::vector<std::pair<std::string, std::string> > TreePairs(const AvlTree<SequenceMap>& a_tree);
+
+/**
+  * Seconds elapsed since start.
+ */
+double SecondsSince(std::chrono::steady_clock::time_point start);
+
+/**
+  * Builds a PersistentAvlTree version from db_filename, applies delta to a copy of it to make the next version, and
+  * prints what diff() finds between the two versions and how much of the trees it had to visit.
+ */
+void CompareVersions(const std::string& db_filename, const DatabaseDelta& delta);
+
+int main(int argc, char **argv) {
+    bool from_changes = argc == 4 && std::string(argv[2]) == "-changes";
+    if (argc != 3 && !from_changes) {
+        std::cout << "Usage: " << argv[0] << " <databasefilename> <newdatabasefilename>" << std::endl;
+        std::cout << "       " << argv[0] << " <databasefilename> -changes <changefilename>" << std::endl;
+        return 0;
+    }
+    std::string db_filename(argv[1]);
+    std::string delta_filename(from_changes ? argv[3] : argv[2]);
+    CheckFile(db_filename);
+    CheckFile(delta_filename);
+
+    AvlTree<SequenceMap> a_tree;
+    auto start = std::chrono::steady_clock::now();
+    FillTree(db_filename, a_tree);
+    std::cout << "Built " << a_tree.count_Nodes() << " nodes from " << db_filename << " in "
+              << SecondsSince(start) << " s." << std::endl;
+
+    DatabaseDelta delta;
+    start = std::chrono::steady_clock::now();
+    if (from_changes)
+        delta.load_Changes(delta_filename);
+    else
+        delta.load_Diff(db_filename, delta_filename);
+    std::cout << "Read " << delta.additions() << " additions and " << delta.removals() << " removals from "
+              << delta_filename << " in " << SecondsSince(start) << " s." << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    DatabaseDelta::ApplyResult result = delta.apply(a_tree);
+    double apply_seconds = SecondsSince(start);
+    std::cout << "Applied in " << apply_seconds << " s: " << result.nodes_inserted << " sequences inserted, "
+              << result.acronyms_merged << " acronyms merged, " << result.acronyms_removed << " acronyms removed, "
+              << result.nodes_removed << " sequences removed, " << result.not_found << " removals not found." << std::endl;
+    std::cout << "Tree now has " << a_tree.count_Nodes() << " nodes." << std::endl;
+
+    if (!from_changes) {
+        AvlTree<SequenceMap> fresh_tree;
+        start = std::chrono::steady_clock::now();
+        FillTree(delta_filename, fresh_tree);
+        std::cout << "A full rebuild from " << delta_filename << " takes " << SecondsSince(start) << " s and has "
+                  << fresh_tree.count_Nodes() << " nodes." << std::endl;
+        bool match = TreePairs(a_tree) == TreePairs(fresh_tree);
+        std::cout << "The delta-applied tree " << (match ? "holds" : "does NOT hold")
+                  << " the same sequences and acronyms as the rebuilt one." << std::endl;
+    }
+    CompareVersions(db_filename, delta);
+    return 0;
+}
+
+void CompareVersions(const std::string& db_filename, const DatabaseDelta& delta) {
+    PersistentAvlTree<SequenceMap> old_release;
+    FillTree(db_filename, old_release);
+    PersistentAvlTree<SequenceMap> new_release = old_release;
+    auto start = std::chrono::steady_clock::now();
+    delta.apply(new_release);
+    std::cout << "Versioned: made the new release in " << SecondsSince(start) << " s; the old release still has "
+              << old_release.count_Nodes() << " nodes, the new one " << new_release.count_Nodes() << "." << std::endl;
+
+    long added = 0, removed = 0, changed = 0;
+    start = std::chrono::steady_clock::now();
+    long expanded = PersistentAvlTree<SequenceMap>::diff(old_release, new_release,
+        [&](const SequenceMap *in_old, const SequenceMap *in_new) {
+            if (in_old == nullptr) added++;
+            else if (in_new == nullptr) removed++;
+            else changed++;
+        });
+    std::cout << "Versioned: diff found " << added << " added, " << removed << " removed and " << changed
+              << " changed sequences in " << SecondsSince(start) << " s, visiting " << expanded << " of "
+              << old_release.count_Nodes() + new_release.count_Nodes() << " nodes." << std::endl;
+}
+
+std::vector<std::pair<std::string, std::string> > TreePairs(const AvlTree<SequenceMap>& a_tree) {
+    std::vector<std::pair<std::string, std::string> > pairs;
+    a_tree.for_Each([&](const SequenceMap& element) {
+        for (const std::string& acronym : element.getEnzymeAcronyms())
+            pairs.emplace_back(element.getRecSequence(), acronym);
+    });
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+void CheckFile(const std::string& filename) {
+    ifstream inStream(filename);
+    if (inStream.fail()) {
+        std::cerr << "Filename not found." << std::endl;
+        exit(1);
+    }
+}
+
+template <typename TreeType>
+void FillTree(const std::string& db_filename, TreeType &a_tree) {
+    ifstream inStream(db_filename);
+    std::string db_line, an_enz_acro, a_reco_seq, garbage_line;
+    for (int i = 0; i < 10; i ++)                               //Skip over the header and begin reading on line 11.
+        getline(inStream, garbage_line);
+    while (std::getline (inStream, db_line)) {
+        if (db_line.empty()) continue;
+        size_t first_slash = db_line.find("/");
+        an_enz_acro = GetEnzymeAcronym(db_line, first_slash);
+        while (GetNextRecognitionSequence(db_line, a_reco_seq, first_slash)) {
+            SequenceMap new_sequence_map(a_reco_seq, an_enz_acro);
+            a_tree.insert(std::move(new_sequence_map));
+        }
+    }
+}
+
+std::string GetEnzymeAcronym(const std::string& db_line, size_t first_slash) {
+    return db_line.substr(0, first_slash);
+}
+
+bool GetNextRecognitionSequence(const std::string& db_line, std::string& a_reco_seq, size_t& first_slash) {
+    size_t next_slash = db_line.find("/", first_slash+1);
+    if (next_slash == first_slash + 1)    //see if there are two '/' in a row
+        return false;                     //there are no more recognition sequences (all db_lines end in "//")
+    a_reco_seq = db_line.substr(first_slash+1, next_slash-first_slash-1);
+    first_slash = next_slash;
+    return true;
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
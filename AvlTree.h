@@ -4,6 +4,29 @@ Modifications Log:
                         all Comparables have a Merge() function.
     3.6.16 Emma Kimlin: Added find_and_print(), find(), countNodes(), calculate_IPL(), calculate_Avg_Depth() and calculate_ratio()
     3.8.16 Emma Kimlin: Added print_Between(). 
+    10.19.26: Added enable_Filter(), disable_Filter() and filter_Bits_Per_Key(). insert() and remove() keep the filter
+              current; find() and find_and_print() consult it first.
+    10.19.26: Added enable_Acronym_Index() and find_Acronym(). insert(), Merge() and remove() keep the index current.
+    10.19.26: Added the NodeLayout template parameter; AvlTree<T, IndexedNodes> is in IndexedAvlTree.h.
+    10.19.26: Added remove_Acronym() for applying database deltas.
+    10.19.26: Added a const print_Between() that writes to a given stream, for ShardedIndex's parallel range queries.
+    10.19.26: Added find_Coro() for interleaved lookups (C++20).
+    10.19.26: clone(), makeEmpty(), count_Nodes(), calculate_IPL() and printTree() walk the tree with ParallelFold()
+              and ParallelInorder() from ForkJoin.h.
+    10.19.26: Added rotation_Count().
+    10.19.26: Added dump_stats() and reset_stats(). With TREE_STATS defined, insert(), find(), remove() and
+              print_Between() record their latency and probe depth (see OpStats.h).
+    10.19.26: Added find_and_print( x, out ), which writes to a given stream.
+    10.19.26: Added print_Prefix() for QueryDaemon's prefix queries.
+    10.19.26: Added merge_Batch(), find_Element() and for_Each_Between() for BufferedAvlTree.
+    10.19.26: Added compact_Step() and compact(), which move the nodes into a NodeArena; nodes are freed through it.
+    10.19.26: Added the Cursor type and find( x, i, c ), which searches from where cursor c's last search ended.
+    10.19.26: Added for_Each() for building a LearnedIndex.
+    10.19.26: Added emplace() and upsert(). insert( Comparable && ) Merge()s a duplicate by move.
+    10.19.26: insert() returns whether the key was new, and remove_Acronym( x, a, e ) whether x went, for DatabaseDelta.
+    10.19.26: remove( x, i ), and so remove_Acronym(), rebalances on the way back up as remove( x ) does.
+    10.19.26: merge_Batch() adds the new keys to the filter after joining them to the tree, so a rebuild keeps them.
+    10.19.26: remove_Acronym() keeps x under acronym in the acronym index while x still lists another copy of it.
 */
 #ifndef AVL_TREE_H
 #define AVL_TREE_H
@@ -11,20 +34,40 @@ Modifications Log:
 #include "dsexceptions.h"
 #include <algorithm>
 #include <iostream> 
+#include <cmath>
+#include <utility>
 #include "SequenceMap.h"
+#include "CuckooFilter.h"
+#include "EnzymeIndex.h"
+#include "CoroLookup.h"
+#include "ForkJoin.h"
+#include "OpStats.h"
+#include "NodeArena.h"
+#include "TreeCursor.h"
 using namespace std;
 
 // AvlTree class
 //
-// CONSTRUCTION: zero parameter
+// CONSTRUCTION: zero parameter. The optional second template parameter selects the node storage:
+//               PointerNodes (default) allocates each node separately; IndexedNodes (IndexedAvlTree.h) keeps
+//               nodes in one vector linked by 32-bit indices.
 //
 // ******************PUBLIC OPERATIONS*********************
-// void insert( x )       --> Insert x
+// bool insert( x )       --> Insert x; returns false if x was Merge()d into the element already with its key
+// void emplace( k, args )--> Insert the element built from key k and args, in the node that will hold it
+// void upsert( k, m, f ) --> Insert m( ) if no element has key k, else call f( element ); m( ) only runs if needed
+// void merge_Batch( v )  --> Insert the sorted elements of vector v, whose keys are all different, in one pass
 // void remove( x )       --> Remove x (unimplemented)
 // bool remove( x, i)     --> If x is found in tree, it is removed and call returns true.
+// bool remove_Acronym( x, a )--> Remove acronym a from x's element; x is removed once it has no acronyms left
+// bool remove_Acronym( x, a, e )--> Same; e is set to whether x was removed
 // bool contains( x )     --> Return true if x is present
 // void find_and_print( x)--> Prints vector associated with x if x is present
+// find_and_print( x, out )-> same, written to stream out
 // bool find( x )         --> Returns true if x is present
+// bool find( x, i, c )   --> find( x, i ) from where Cursor c's last search ended; for keys in sorted order
+// find_Element( x )      --> Return a pointer to the element whose key is x, or nullptr
+// find_Coro( x, i )     --> find( x, i ) as a coroutine for InterleavedFind( ) (C++20 only)
 // Comparable findMin( )  --> Return smallest item
 // Comparable findMax( )  --> Return largest item
 // boolean isEmpty( )     --> Return true if empty; else false
@@ -34,30 +77,62 @@ using namespace std;
 // int calculate_IPL()    --> Return Internal Path Length
 // int calculate_Avg_Depth()-> Return Average Depth of all Nodes
 // double calculate_ratio()-> Return Ratio of Avg Depth to log2n
+// long rotation_Count( ) --> Return number of single rotations done so far
+// bool compact_Step( n ) --> Move up to n nodes into contiguous storage (see NodeArena.h); true when all are moved
+// void compact( )        --> Move every node into contiguous storage at once
+// void enable_Filter( ) --> Build a membership filter that find( ) and find_and_print( ) consult first
+// void disable_Filter( )--> Drop the membership filter
+// double filter_Bits_Per_Key( )-> Return filter memory per stored key, in bits
+// void enable_Acronym_Index( )--> Build an index from enzyme acronym to recognition sequences
+// find_Acronym( a )     --> Return the recognition sequences of acronym a, or nullptr
 // print_Between(k1, k2)  --> prints all elements with keys between k1 and k2
+// print_Between(k1, k2, out)--> same, written to stream out
+// print_Prefix( p, out ) --> Writes all elements whose keys start with p to out
+// for_Each_Between( k1, k2, f )--> Calls f( element ) for the elements print_Between( k1, k2 ) would print
+// for_Each( f )          --> Calls f( element ) for every element, in key order
+// void dump_stats( out ) --> Write per-operation latency and probe-depth statistics to out as JSON (TREE_STATS)
+// void reset_stats( )    --> Clear the statistics
 // ******************ERRORS********************************
 // Throws UnderflowException as warranted
 
-template <typename Comparable>
+// Node storage layouts for AvlTree's second template parameter.
+struct PointerNodes { };
+struct IndexedNodes { };
+
+template <typename Comparable, typename NodeLayout = PointerNodes>
 class AvlTree
 {
+  private:
+    struct AvlNode;
+
   public:
-    AvlTree( ) : root_{ nullptr }
+    typedef TreeCursor<AvlNode> Cursor;     // A finger for find( x, i, c ); see TreeCursor.h
+
+    AvlTree( ) : root_{ nullptr }, filter_{ nullptr }, acronym_index_{ nullptr }, rotations_{ 0 }
       { }
     
-    AvlTree( const AvlTree & rhs ) : root_{ nullptr }
+    AvlTree( const AvlTree & rhs ) : root_{ nullptr }, filter_{ nullptr }, acronym_index_{ nullptr }, rotations_{ 0 }
     {
         root_ = clone( rhs.root_ );
+        if( rhs.filter_ != nullptr )
+            filter_ = new CuckooFilter{ *rhs.filter_ };
+        if( rhs.acronym_index_ != nullptr )
+            acronym_index_ = new EnzymeIndex{ *rhs.acronym_index_ };
     }
 
-    AvlTree( AvlTree && rhs ) : root_{ rhs.root_ }
+    AvlTree( AvlTree && rhs ) : root_{ rhs.root_ }, filter_{ rhs.filter_ }, acronym_index_{ rhs.acronym_index_ },
+                                rotations_{ rhs.rotations_ }, arena_{ std::move( rhs.arena_ ) }
     {
         rhs.root_ = nullptr;
+        rhs.filter_ = nullptr;
+        rhs.acronym_index_ = nullptr;
     }
     
     ~AvlTree( )
     {
         makeEmpty( );
+        delete filter_;
+        delete acronym_index_;
     }
 
     /**
@@ -76,6 +151,10 @@ class AvlTree
     AvlTree & operator=( AvlTree && rhs )
     {
         std::swap( root_, rhs.root_ );
+        std::swap( filter_, rhs.filter_ );
+        std::swap( acronym_index_, rhs.acronym_index_ );
+        std::swap( rotations_, rhs.rotations_ );
+        std::swap( arena_, rhs.arena_ );
         
         return *this;
     }
@@ -116,16 +195,77 @@ class AvlTree
       * find() is called.
      */
     bool find(const std::string & x, int& recursion_calls) const {
+        OpStats::Timer timer{ stats_, OpStats::FIND, &recursion_calls };
         recursion_calls = 0;
+        if (filter_ != nullptr && !filter_->contains(x))
+            return false;   // Rejected by the filter without touching the tree; recursion_calls stays 0
         return find(x, root_, recursion_calls);
     }
+    /**
+      * find() starting from where cursor's last search ended, climbing only as far as the key needs. recursion_calls
+      * counts the nodes climbed past as well as those visited. Pre-Condition: the tree has not changed since cursor
+      * was last used on it.
+     */
+    bool find(const std::string & x, int& recursion_calls, Cursor& cursor) const {
+        OpStats::Timer timer{ stats_, OpStats::FIND, &recursion_calls };
+        recursion_calls = 0;
+        if (filter_ != nullptr && !filter_->contains(x))
+            return false;
+        return cursor.seek(root_, x, recursion_calls) != nullptr;
+    }
+
+#if defined( __cpp_impl_coroutine )
+    /**
+      * find() as a coroutine for InterleavedFind() (see CoroLookup.h). It visits the same nodes and counts
+      * recursion_calls the same way, but prefetches each node and suspends before comparing against it.
+      * Pre-Condition: x and recursion_calls outlive the returned task.
+     */
+    LookupTask find_Coro(const std::string & x, int& recursion_calls) const {
+        recursion_calls = 0;
+        if (filter_ != nullptr && !filter_->contains(x))
+            co_return false;
+        for (AvlNode *t = root_; ; ) {
+            ++recursion_calls;
+            if (t == nullptr)
+                co_return false;
+            co_await PrefetchNode{ t };
+            if (x < t->element_.getRecSequence())
+                t = t->left_;
+            else if (t->element_.getRecSequence() < x)
+                t = t->right_;
+            else
+                co_return true;     // Match
+        }
+    }
+#endif
+
+    /**
+      * Returns the element whose key is x, or nullptr if there is none.
+     */
+    const Comparable * find_Element(const std::string & x) const {
+        if (filter_ != nullptr && !filter_->contains(x))
+            return nullptr;
+        AvlNode *t = root_;
+        while (t != nullptr && t->element_.getRecSequence() != x)
+            t = x < t->element_.getRecSequence() ? t->left_ : t->right_;
+        return t == nullptr ? nullptr : &t->element_;
+    }
 
     /**
       * If x is located in the tree, its associated vector is printed
       * This assumes that T has a data member that is a vector. 
      */
     void find_and_print(const std::string& x) const {
-         find_and_print(x, root_);
+        find_and_print(x, std::cout);
+    }
+    /**
+      * find_and_print() written to stream out, for callers such as CachedTree that keep the output.
+     */
+    void find_and_print(const std::string& x, std::ostream& out) const {
+         if (filter_ != nullptr && !filter_->contains(x))
+             out << "Not found in this tree." << std::endl;
+         else
+             find_and_print(x, root_, out);
     }
     /**
      * Test if the tree is logically empty.
@@ -154,29 +294,82 @@ class AvlTree
     void makeEmpty( )
     {
         makeEmpty( root_ );
+        arena_.clear( );
+        if( filter_ != nullptr )
+            filter_->clear( );
+        if( acronym_index_ != nullptr )
+            acronym_index_->clear( );
     }
 
     /**
-     * Insert x into the tree; duplicates are ignored.
+     * Insert x into the tree. Returns false if x's key was already there and x was Merge()d into its element.
      */
-    void insert( const Comparable & x )
+    bool insert( const Comparable & x )
     {
-        insert( x, root_ );
+        OpStats::Timer timer{ stats_, OpStats::INSERT };
+        return insert( x, root_ );
     }
      
     /**
-     * Insert x into the tree; duplicates are ignored.
+     * Insert x into the tree. Returns false if x's key was already there and x was Merge()d into its element.
      */
-    void insert( Comparable && x )
+    bool insert( Comparable && x )
     {
-        insert( std::move( x ), root_ );
+        OpStats::Timer timer{ stats_, OpStats::INSERT };
+        return insert( std::move( x ), root_ );
+    }
+
+    /**
+     * Insert the element built from key x and args, whose key must be x. The tree is searched for x first, and the
+     * element is constructed inside the new node only once an empty place for it has been found. A duplicate is
+     * built as a temporary and Merge()d into the element with its key by move; no node is allocated for it.
+     */
+    template <typename... Args>
+    void emplace( const std::string & x, Args &&... args )
+    {
+        OpStats::Timer timer{ stats_, OpStats::INSERT };
+        emplace( root_, x, std::forward<Args>( args )... );
+    }
+
+    /**
+     * If no element has key x, insert the element make( ) returns, whose key must be x; otherwise call
+     * merge( element ) on the element with key x. Nothing is built for a key already in the tree.
+     * merge may only append acronyms to the element, as Merge() and Add_Acronym() do; just the appended ones are
+     * added to the acronym index.
+     */
+    template <typename Make, typename MergeFunction>
+    void upsert( const std::string & x, Make make, MergeFunction merge )
+    {
+        OpStats::Timer timer{ stats_, OpStats::INSERT };
+        upsert( x, root_, make, merge );
     }
      
+    /**
+     * Insert every element of batch, which must be sorted with no two keys equal, in one pass. The batch is split
+     * at each node's key on the way down, so subtrees that gain nothing are never entered, and each node is joined
+     * back to its new subtrees on the way up. An element whose key is already in the tree is Merge()d into it, as
+     * insert() would. Costs O( m log( n / m + 1 ) ) for m elements instead of m descents of O( log n ).
+     * Post-Condition: the elements of batch have been moved from.
+     */
+    void merge_Batch( std::vector<Comparable> & batch )
+    {
+        std::vector<const AvlNode *> built;
+        root_ = mergeBatch( root_, batch.data( ), batch.data( ) + batch.size( ), filter_ != nullptr ? &built : nullptr );
+        for( const AvlNode *t : built )     // Only now, as a full filter is rebuilt from root_
+            if( !filter_->insert( t->element_.getRecSequence( ) ) )
+            {
+                rebuildFilter( filter_->capacity( ) * 2 );
+                break;
+            }
+    }
+
     /**
      * Remove x from the tree. Nothing is done if x is not found.
      */
     void remove( const Comparable & x )
     {
+        OpStats::Timer timer{ stats_, OpStats::REMOVE };
+        forgetKey( x.getRecSequence( ) );
         remove( x, root_ );
     }
     /** 
@@ -185,13 +378,67 @@ class AvlTree
       * recursion calls it took to run remove().
      */
     bool remove(const std::string & x, int& recursion_calls) {
+        OpStats::Timer timer{ stats_, OpStats::REMOVE, &recursion_calls };
         recursion_calls = 0;
+        forgetKey(x);
         return remove(x, root_, recursion_calls);
     }
 
+    /**
+      * Removes acronym from the element whose key is x. An element left with no acronyms is removed from the tree.
+      * Assumes T has Remove_Acronym() and getEnzymeAcronyms() functions.
+      * Post-Condition: Returns false, and changes nothing, if x is not in the tree or its element does not list acronym.
+     */
+    bool remove_Acronym(const std::string & x, const std::string & acronym) {
+        bool emptied;
+        return remove_Acronym(x, acronym, emptied);
+    }
+
+    /**
+      * remove_Acronym() that sets emptied to true if the element had no acronyms left and x was removed.
+     */
+    bool remove_Acronym(const std::string & x, const std::string & acronym, bool & emptied) {
+        emptied = false;
+        AvlNode *t = root_;
+        while (t != nullptr && t->element_.getRecSequence() != x)
+            t = x < t->element_.getRecSequence() ? t->left_ : t->right_;
+        if (t == nullptr || !t->element_.Remove_Acronym(acronym))
+            return false;
+        const std::vector<std::string> & left = t->element_.getEnzymeAcronyms();
+        if (acronym_index_ != nullptr && std::find(left.begin(), left.end(), acronym) == left.end())
+            acronym_index_->remove(acronym, x);     // Only once x lists no copy of acronym
+        if (left.empty()) {
+            int recursion_calls = 0;
+            remove(x, recursion_calls);
+            emptied = true;
+        }
+        return true;
+    }
+
     int heightOfTree() const {
       return heightOfNode(root_);
     }
+    /**
+     * Returns the number of single rotations done by insert() and remove() so far; a double rotation counts as two.
+     */
+    long rotation_Count() const {
+        return rotations_;
+    }
+    /**
+     * Moves up to max_nodes nodes into contiguous storage, continuing the compaction the last call started, and
+     * returns true once every node has been moved. Bounds the pause, so a serving process can compact a little
+     * between requests; the tree may be changed between calls.
+     */
+    bool compact_Step(size_t max_nodes) {
+        return arena_.compact_Step(root_, max_nodes);
+    }
+    /**
+     * Compacts the whole tree in one go.
+     */
+    void compact() {
+        while (!arena_.compact_Step(root_, NodeArena<AvlNode>::kChunkNodes))
+            ;
+    }
     /**
      * Returns number of nodes in tree.
      */
@@ -220,12 +467,90 @@ class AvlTree
         int avg_depth = calculate_Avg_Depth();
         return avg_depth / log2(nodes);
     }
+    /**
+      * Builds a CuckooFilter over the keys in the tree. From then on insert() and remove() keep it current, and
+      * find() and find_and_print() answer most misses from the filter without descending the tree.
+     */
+    void enable_Filter() {
+        rebuildFilter(count_Nodes(root_));
+    }
+    /**
+      * Drops the filter; lookups go straight to the tree again.
+     */
+    void disable_Filter() {
+        delete filter_;
+        filter_ = nullptr;
+    }
+    /**
+      * Returns the filter's memory per key in the tree, in bits. Returns 0 if no filter is enabled.
+     */
+    double filter_Bits_Per_Key() const {
+        if (filter_ == nullptr || filter_->size() == 0)
+            return 0;
+        return filter_->memory_Bytes() * 8.0 / filter_->size();
+    }
+    /**
+      * Builds an EnzymeIndex from the acronyms of every element. From then on insert(), Merge() and remove() keep it
+      * current. Assumes T has a getEnzymeAcronyms() function.
+     */
+    void enable_Acronym_Index() {
+        delete acronym_index_;
+        acronym_index_ = new EnzymeIndex;
+        fillAcronymIndex(root_);
+    }
+    /**
+      * Returns the recognition sequences of the enzyme acronym, or nullptr if it is unknown or no index is enabled.
+     */
+    const std::vector<std::string> * find_Acronym(const std::string & acronym) const {
+        return acronym_index_ == nullptr ? nullptr : acronym_index_->find(acronym);
+    }
     /**
       * Prints all elements in tree between the value str1 and str2. 
       * Assumes T has a string data member.
      */
     void print_Between(std::string str1, std::string str2) {
-        print_Between(str1, str2, root_);
+        OpStats::Timer timer{ stats_, OpStats::RANGE };
+        print_Between(str1, str2, root_, std::cout);
+    }
+    /**
+      * Writes all elements in tree between the value str1 and str2 to out. Does not modify the tree, so readers
+      * may run it concurrently.
+     */
+    void print_Between(const std::string & str1, const std::string & str2, std::ostream & out) const {
+        OpStats::Timer timer{ stats_, OpStats::RANGE };
+        print_Between(str1, str2, root_, out);
+    }
+    /**
+      * Calls visit( element ) for every element with a key strictly between str1 and str2, in key order.
+     */
+    template <typename Visit>
+    void for_Each_Between(const std::string & str1, const std::string & str2, Visit visit) const {
+        for_Each_Between(str1, str2, root_, visit);
+    }
+    /**
+      * Calls visit( element ) for every element, in key order.
+     */
+    template <typename Visit>
+    void for_Each(Visit visit) const {
+        for_Each(root_, visit);
+    }
+    /**
+      * Writes all elements whose keys begin with prefix to out, in key order. Unlike print_Between(), the bound is
+      * inclusive: the element whose key is prefix itself is written too.
+     */
+    void print_Prefix(const std::string & prefix, std::ostream & out) const {
+        OpStats::Timer timer{ stats_, OpStats::RANGE };
+        print_Prefix(prefix, root_, out);
+    }
+    /**
+      * Writes the latency percentiles, throughput and probe-depth distribution of each operation as JSON.
+      * Writes { "enabled": false } unless compiled with TREE_STATS.
+     */
+    void dump_stats(std::ostream & out = std::cout) const {
+        stats_.dump(out);
+    }
+    void reset_stats() {
+        stats_.reset();
     }
 
   private:
@@ -241,9 +566,18 @@ class AvlTree
         
         AvlNode( Comparable && ele, AvlNode *lt, AvlNode *rt, int h = 0 )
           : element_{ std::move( ele ) }, left_{ lt }, right_{ rt }, height_{ h } { }
+
+        template <typename... Args>
+        AvlNode( std::in_place_t, Args &&... args )
+          : element_( std::forward<Args>( args )... ), left_{ nullptr }, right_{ nullptr }, height_{ 0 } { }
     };
 
     AvlNode *root_;
+    CuckooFilter *filter_;     // Optional; nullptr unless enable_Filter() was called
+    EnzymeIndex *acronym_index_;  // Optional; nullptr unless enable_Acronym_Index() was called
+    long rotations_;
+    mutable OpStats stats_;
+    NodeArena<AvlNode> arena_;      // Holds the nodes compact() moved; nodes are freed through it
 
 
     /**
@@ -251,22 +585,30 @@ class AvlTree
      * x is the item to insert.
      * t is the node that roots the subtree.
      * Set the new root of the subtree.
+     * Returns false if x was Merge()d into a duplicate.
      * This function assumes all Comparables have a Merge() function.
      */
-    void insert( const Comparable & x, AvlNode * & t )
+    bool insert( const Comparable & x, AvlNode * & t )
     {
+        bool added = true;
         if( t == nullptr )
+        {
             t = new AvlNode{ x, nullptr, nullptr };
+            addToFilter( t->element_.getRecSequence( ) );
+            indexAcronyms( t->element_ );
+        }
         else if( x < t->element_ )
-            insert( x, t->left_ );
+            added = insert( x, t->left_ );
         else if( t->element_ < x )
-            insert( x, t->right_ );
+            added = insert( x, t->right_ );
         else 
         {
             t->element_.Merge(x);
-            return;
+            indexAcronyms( x );
+            return false;
         }
         balance( t );
+        return added;
     }
 
     /**
@@ -274,19 +616,80 @@ class AvlTree
      * x is the item to insert.
      * t is the node that roots the subtree.
      * Set the new root of the subtree.
+     * Returns false if x was Merge()d into a duplicate.
      * This function assumes all Comparables have a Merge() function. 
      */
-    void insert( Comparable && x, AvlNode * & t )
+    bool insert( Comparable && x, AvlNode * & t )
     {
+        bool added = true;
         if( t == nullptr )
+        {
             t = new AvlNode{ std::move( x ), nullptr, nullptr };
+            addToFilter( t->element_.getRecSequence( ) );
+            indexAcronyms( t->element_ );
+        }
         else if( x < t->element_ )
-            insert( std::move( x ), t->left_ );
+            added = insert( std::move( x ), t->left_ );
         else if( t->element_ < x )
-            insert( std::move( x ), t->right_ );
+            added = insert( std::move( x ), t->right_ );
          else 
         {
-            t->element_.Merge(x);  // Duplicate;
+            indexAcronyms( x );
+            t->element_.Merge( std::move( x ) );  // Duplicate;
+            return false;
+        }
+        balance( t );
+        return added;
+    }
+
+    /**
+     * Internal method for emplace(): builds the element from x and args in a new node at the empty place for key x
+     * in subtree t, or Merge()s it into the element with key x.
+     */
+    template <typename... Args>
+    void emplace( AvlNode * & t, const std::string & x, Args &&... args )
+    {
+        if( t == nullptr )
+        {
+            t = new AvlNode{ std::in_place, x, std::forward<Args>( args )... };
+            addToFilter( t->element_.getRecSequence( ) );
+            indexAcronyms( t->element_ );
+        }
+        else if( x < t->element_.getRecSequence( ) )
+            emplace( t->left_, x, std::forward<Args>( args )... );
+        else if( t->element_.getRecSequence( ) < x )
+            emplace( t->right_, x, std::forward<Args>( args )... );
+        else
+        {
+            Comparable duplicate( x, std::forward<Args>( args )... );
+            indexAcronyms( duplicate );
+            t->element_.Merge( std::move( duplicate ) );
+            return;
+        }
+        balance( t );
+    }
+
+    /**
+     * Internal method for upsert() on subtree t.
+     */
+    template <typename Make, typename MergeFunction>
+    void upsert( const std::string & x, AvlNode * & t, Make & make, MergeFunction & merge )
+    {
+        if( t == nullptr )
+        {
+            t = new AvlNode{ std::in_place, make( ) };
+            addToFilter( t->element_.getRecSequence( ) );
+            indexAcronyms( t->element_ );
+        }
+        else if( x < t->element_.getRecSequence( ) )
+            upsert( x, t->left_, make, merge );
+        else if( t->element_.getRecSequence( ) < x )
+            upsert( x, t->right_, make, merge );
+        else
+        {
+            size_t indexed = t->element_.getEnzymeAcronyms( ).size( );
+            merge( t->element_ );
+            indexAcronyms( t->element_, indexed );
             return;
         }
         balance( t );
@@ -316,35 +719,109 @@ class AvlTree
         {
             AvlNode *oldNode = t;
             t = ( t->left_ != nullptr ) ? t->left_ : t->right_;
-            delete oldNode;
+            arena_.release( oldNode );
         }
         
         balance( t );
     }
     /**
       * Internal method to remove x from subtree while counting number of recursion calls to do so. 
+      * Set the new root of the subtree.
      */
 
     bool remove(const std::string & x, AvlNode * & t, int& recursion_calls) {
         ++recursion_calls;
         if( t == nullptr )
             return false;   // Item not found; do nothing
+        bool removed = true;
         if( x < t->element_.getRecSequence() )
-            return remove( x, t->left_, recursion_calls);
+            removed = remove( x, t->left_, recursion_calls);
         else if( t->element_.getRecSequence() < x )
-            return remove( x, t->right_, recursion_calls);
+            removed = remove( x, t->right_, recursion_calls);
         else if( t->left_ != nullptr && t->right_ != nullptr ) // Two children
         {
             t->element_ = findMin( t->right_ )->element_;
-            return remove( t->element_.getRecSequence(), t->right_ ,recursion_calls);
+            remove( t->element_.getRecSequence(), t->right_ ,recursion_calls);
         } else {
             AvlNode *oldNode = t;
             t = ( t->left_ != nullptr ) ? t->left_ : t->right_;
-            delete oldNode;
+            arena_.release( oldNode );
             return true;
         }
+        if( removed )
+            balance( t );
+        return removed;
     }
     
+    /**
+     * Internal method for merge_Batch(): inserts the sorted elements in [first, last) into subtree t and returns
+     * the new root of the subtree. The new nodes are appended to built, unless it is nullptr.
+     */
+    AvlNode * mergeBatch( AvlNode *t, Comparable *first, Comparable *last, std::vector<const AvlNode *> *built )
+    {
+        if( first == last )
+            return t;
+        if( t == nullptr )
+            return buildBalanced( first, last, built );
+        __builtin_prefetch( t->left_ );     // join() reads both children's heights, and one of them may be
+        __builtin_prefetch( t->right_ );    // reached only after the other side's whole merge
+        Comparable *middle = std::lower_bound( first, last, t->element_ );
+        bool duplicate = middle != last && !( t->element_ < *middle );
+        AvlNode *left = mergeBatch( t->left_, first, middle, built );
+        if( duplicate )
+        {
+            indexAcronyms( *middle );
+            t->element_.Merge( std::move( *middle ) );
+        }
+        AvlNode *right = mergeBatch( t->right_, duplicate ? middle + 1 : middle, last, built );
+        return join( left, t, right );
+    }
+
+    /**
+     * Internal method to build a perfectly balanced subtree from the sorted elements in [first, last), moving them.
+     * The new nodes are appended to built, unless it is nullptr.
+     */
+    AvlNode * buildBalanced( Comparable *first, Comparable *last, std::vector<const AvlNode *> *built )
+    {
+        if( first == last )
+            return nullptr;
+        Comparable *middle = first + ( last - first ) / 2;
+        AvlNode *left = buildBalanced( first, middle, built );
+        AvlNode *right = buildBalanced( middle + 1, last, built );
+        AvlNode *t = new AvlNode{ std::move( *middle ), left, right };
+        t->height_ = max( heightOfNode( left ), heightOfNode( right ) ) + 1;
+        if( built != nullptr )
+            built->push_back( t );
+        indexAcronyms( t->element_ );
+        return t;
+    }
+
+    /**
+     * Internal method to make node the root of an AVL tree holding left, node and right, where every key in left
+     * is smaller than node's and every key in right larger, and return it. left and right may differ in height by
+     * any amount: node is hung from the spine of the taller one where the heights meet, and each step back up the
+     * spine needs at most one single or double rotation.
+     */
+    AvlNode * join( AvlNode *left, AvlNode *node, AvlNode *right )
+    {
+        if( heightOfNode( left ) > heightOfNode( right ) + ALLOWED_IMBALANCE )
+        {
+            left->right_ = join( left->right_, node, right );
+            balance( left );
+            return left;
+        }
+        if( heightOfNode( right ) > heightOfNode( left ) + ALLOWED_IMBALANCE )
+        {
+            right->left_ = join( left, node, right->left_ );
+            balance( right );
+            return right;
+        }
+        node->left_ = left;
+        node->right_ = right;
+        node->height_ = max( heightOfNode( left ), heightOfNode( right ) ) + 1;
+        return node;
+    }
+
     static const int ALLOWED_IMBALANCE = 1;
 
     // Assume t is balanced or within one of being balanced
@@ -414,15 +891,15 @@ class AvlTree
       * If x is found in the tree, its associated vector is printed. 
       * Assumes type T has a Printe_Vector() function, a vector data member, and an enzyme_acronym_ data member.
      */
-    void find_and_print(const std::string& x, AvlNode *t) const {
+    void find_and_print(const std::string& x, AvlNode *t, std::ostream& out) const {
         if( t == nullptr )
-            std::cout << "Not found in this tree." << std::endl;
+            out << "Not found in this tree." << std::endl;
         else if( x < t->element_.getRecSequence())
-            return find_and_print( x, t->left_ );
+            return find_and_print( x, t->left_, out );
         else if( t->element_.getRecSequence() < x )
-            return find_and_print( x, t->right_ );
+            return find_and_print( x, t->right_, out );
         else 
-            t->element_.Print_Vector();
+            t->element_.Print_Vector(out);
     }
     /**
      * Internal method to test if an item is in a subtree is present.
@@ -456,16 +933,90 @@ class AvlTree
 *****************************************************/
 
     /**
-     * Internal method to make subtree empty.
+     * Internal method to record a newly inserted key in the filter, if there is one. A full filter is rebuilt
+     * with twice the capacity.
      */
-    void makeEmpty( AvlNode * & t )
+    void addToFilter( const std::string & key )
+    {
+        if( filter_ != nullptr && !filter_->insert( key ) )
+            rebuildFilter( filter_->capacity( ) * 2 );
+    }
+
+    /**
+     * Internal method to replace the filter with one sized for expected_keys that holds every key in the tree.
+     */
+    void rebuildFilter( size_t expected_keys )
+    {
+        CuckooFilter *fresh = new CuckooFilter{ expected_keys };
+        if( !fillFilter( root_, *fresh ) )
+        {
+            delete fresh;
+            rebuildFilter( expected_keys * 2 );
+            return;
+        }
+        delete filter_;
+        filter_ = fresh;
+    }
+
+    /**
+     * Internal method to insert every key of subtree t into filter. Returns false if filter overflowed.
+     */
+    bool fillFilter( AvlNode *t, CuckooFilter & filter ) const
+    {
+        if( t == nullptr )
+            return true;
+        return filter.insert( t->element_.getRecSequence( ) ) && fillFilter( t->left_, filter ) && fillFilter( t->right_, filter );
+    }
+
+    /**
+     * Internal method to add x's acronyms to the acronym index, if there is one, skipping the first from of them.
+     */
+    void indexAcronyms( const Comparable & x, size_t from = 0 )
+    {
+        if( acronym_index_ != nullptr )
+            for( size_t i = from; i < x.getEnzymeAcronyms( ).size( ); ++i )
+                acronym_index_->add( x.getEnzymeAcronyms( )[ i ], x.getRecSequence( ) );
+    }
+
+    /**
+     * Internal method to index the acronyms of every element in subtree t.
+     */
+    void fillAcronymIndex( AvlNode *t )
     {
         if( t != nullptr )
         {
-            makeEmpty( t->left_ );
-            makeEmpty( t->right_ );
-            delete t;
+            indexAcronyms( t->element_ );
+            fillAcronymIndex( t->left_ );
+            fillAcronymIndex( t->right_ );
         }
+    }
+
+    /**
+     * Internal method to drop key from the filter and the acronym index before its node is removed.
+     * Does nothing if key is not in the tree.
+     */
+    void forgetKey( const std::string & key )
+    {
+        if( filter_ == nullptr && acronym_index_ == nullptr )
+            return;
+        AvlNode *t = root_;
+        while( t != nullptr && t->element_.getRecSequence( ) != key )
+            t = key < t->element_.getRecSequence( ) ? t->left_ : t->right_;
+        if( t == nullptr )
+            return;
+        if( filter_ != nullptr )
+            filter_->remove( key );
+        if( acronym_index_ != nullptr )
+            for( const std::string & acronym : t->element_.getEnzymeAcronyms( ) )
+                acronym_index_->remove( acronym, key );
+    }
+
+    /**
+     * Internal method to make subtree empty.
+     */
+    void makeEmpty( AvlNode * & t )
+    {
+        ParallelFold<int>( t, 0, [ this ]( AvlNode *node, int, int, int ) { arena_.discard( node ); return 0; } );
         t = nullptr;
     }
 
@@ -474,12 +1025,7 @@ class AvlTree
      */
     void printTree( AvlNode *t ) const
     {
-        if( t != nullptr )
-        {
-            printTree( t->left_ );
-            cout << t->element_ << " ";
-            printTree( t->right_ );
-        }
+        ParallelInorder( t, cout, [ ]( const AvlNode *node, ostream & out ) { out << node->element_ << " "; } );
     }
 
     /**
@@ -487,10 +1033,8 @@ class AvlTree
      */
     AvlNode * clone( AvlNode *t ) const
     {
-        if( t == nullptr )
-            return nullptr;
-        else
-            return new AvlNode{ t->element_, clone( t->left_ ), clone( t->right_ ), t->height_ };
+        return ParallelFold<AvlNode *>( t, 0, [ ]( AvlNode *node, int, AvlNode *lt, AvlNode *rt )
+            { return new AvlNode{ node->element_, lt, rt, node->height_ }; } );
     }
         // Avl manipulations
 
@@ -514,6 +1058,7 @@ class AvlTree
      */
     void rotateWithLeftChild( AvlNode * & k2 )
     {
+        ++rotations_;
         AvlNode *k1 = k2->left_;
         k2->left_ = k1->right_;
         k1->right_ = k2;
@@ -529,6 +1074,7 @@ class AvlTree
      */
     void rotateWithRightChild( AvlNode * & k1 )
     {
+        ++rotations_;
         AvlNode *k2 = k1->right_;
         k1->right_ = k2->left_;
         k2->left_ = k1;
@@ -564,25 +1110,51 @@ class AvlTree
      * Internal function to count nodes.
      */
     int count_Nodes(AvlNode *t) const {
-        if( t != nullptr ) return count_Nodes(t->left_) + count_Nodes(t->right_) + 1; 
-        else return 0; 
+        return ParallelFold<int>(t, 0, [](AvlNode *, int, int left_count, int right_count) { return left_count + right_count + 1; });
     }
     /**
       * Internal function to sum depth of each node in tree.
      */
     int calculate_IPL(AvlNode *t, int depth) const {
-        if (t == NULL) return 0;
-        else return calculate_IPL(t->left_, depth+1) + calculate_IPL(t->right_, depth+1) + depth;
+        return ParallelFold<int>(t, depth, [](AvlNode *, int node_depth, int left_ipl, int right_ipl) { return left_ipl + right_ipl + node_depth; });
     }
 
-    void print_Between(const std::string str1, const std::string str2, const AvlNode *t) {
+    void print_Between(const std::string & str1, const std::string & str2, const AvlNode *t, std::ostream & out) const {
+        auto print = [ &out ]( const Comparable & element ) { out << element << " "; };
+        for_Each_Between( str1, str2, t, print );
+    }
+    template <typename Visit>
+    void for_Each_Between(const std::string & str1, const std::string & str2, const AvlNode *t, Visit & visit) const {
         if( t != nullptr ) {
           if (t->element_.getRecSequence() > str1)
-              print_Between( str1, str2, t->left_ );
+              for_Each_Between( str1, str2, t->left_, visit );
           if ((t->element_.getRecSequence() > str1) && (t->element_.getRecSequence()< str2))
-              std::cout << t->element_<< " ";
+              visit( t->element_ );
           if (t->element_.getRecSequence()<= str2)
-              print_Between( str1, str2, t->right_ );
+              for_Each_Between( str1, str2, t->right_, visit );
+        }
+    }
+    template <typename Visit>
+    void for_Each(const AvlNode *t, Visit & visit) const {
+        if( t != nullptr ) {
+          for_Each( t->left_, visit );
+          visit( t->element_ );
+          for_Each( t->right_, visit );
+        }
+    }
+    /**
+      * Internal method for print_Prefix(). Keys that start with prefix are contiguous in key order, so a subtree is
+      * only entered on the side where they can be.
+     */
+    void print_Prefix(const std::string & prefix, const AvlNode *t, std::ostream & out) const {
+        if( t != nullptr ) {
+          int order = t->element_.getRecSequence().compare(0, prefix.size(), prefix);
+          if (order >= 0)
+              print_Prefix( prefix, t->left_, out );
+          if (order == 0)
+              out << t->element_ << " ";
+          if (order <= 0)
+              print_Prefix( prefix, t->right_, out );
         }
     }
 };
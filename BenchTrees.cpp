@@ -0,0 +1,1419 @@
+/*
+ Title: BenchTrees.cpp
+ Description: Benchmarks for the tree types. The database is parsed into each tree being compared, the query file is
+        read into memory, and the chosen workload is timed so that file I/O is not part of the measurement.
+ Usage: BenchTrees <database filename> <queries filename> <mode>
+        Modes: layout   find() latency of AvlTree against InlineKeyAvlTree
+               storage  build time and find() latency of AvlTree with PointerNodes against IndexedNodes
+               reload   find() latency percentiles before, during and after a ReloadableTree reload
+               sharded  insert and find() throughput of ShardedIndex from 1 to 64 threads, on synthetic keys, then
+                        print_Between() across shards while another thread refills, counts and empties the index
+               pool     speed-up of answering the queries on a WorkStealingPool from 1 to 16 threads
+               coro     find() against InterleavedFind() with group sizes 1 to 64 (needs a C++20 build)
+               walks    copy, count_Nodes(), calculate_IPL(), printTree() and teardown of a tree; set TREES_THREADS
+                        to choose how many threads ForkJoin.h uses
+               skew     recursion calls and find() latency of AvlTree and SplayTree on Zipf and uniform query traces
+               writes   rotations per operation and throughput of AvlTree and RedBlackTree on mixed insert/remove traces
+               cache    find_and_print() latency and throughput of AvlTree with and without a CachedTree in front, on
+                        Zipf and uniform query traces
+               disk     bulk load, find() and range scans of DiskBPlusTree with memory budgets of 1/2 to 1/16 of
+                        its file, with and without read-ahead, and a build by insert() for comparison
+               buffer   insert throughput of AvlTree against BufferedAvlTree with write buffers of 64 to 1M keys,
+                        and what the buffer costs find() and print_Between(); also with the tree's filter on from the
+                        start, which must not change the hits
+               compact  find() and walk times of AvlTree and BinarySearchTree after insert/remove churn, before and
+                        after compacting them with compact_Step(), and the longest pause of a step
+               skiplist insert, merge and mixed throughput of LockFreeSkipList against ShardedIndex with 1 and 64
+                        shards, from 1 thread up to the number of cores, on synthetic keys
+               finger   find() against find() with a Cursor on AvlTree and BinarySearchTree, for random and sorted
+                        batches of 1k to 1M queries
+               learned  build time, model size, find() and range scans of LearnedIndex with error bounds of 8 to 128,
+                        against the AvlTree it is built from
+               compressed heap footprint, build time, find(), find_and_print(), range scans and a full walk of
+                        FrontCodedIndex with blocks of 16 to 64 keys, against the AvlTree it is built from
+               ingest   heap allocations and time per database record when AvlTree and BinarySearchTree are built by
+                        insert() of a copy, insert() of a temporary, emplace() and upsert()
+ Build with: make BenchTrees
+ Modifications:
+ */
+
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <random>
+#include <iomanip>
+#include <sstream>
+#include <unordered_set>
+#include <stdlib.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "SequenceMap.h"
+#include "AvlTree.h"
+#include "BinarySearchTree.h"
+#include "SplayTree.h"
+#include "RedBlackTree.h"
+#include "IndexedAvlTree.h"
+#include "InlineKeyAvlTree.h"
+#include "ReloadableTree.h"
+#include "ShardedIndex.h"
+#include "WorkStealingPool.h"
+#include "LookupCache.h"
+#include "DiskBPlusTree.h"
+#include "BufferedAvlTree.h"
+#include "LockFreeSkipList.h"
+#include "LearnedIndex.h"
+#include "FrontCodedIndex.h"
+
+/**
+  * Checks to make sure a file opens and issues an error message if not.
+ */
+void CheckFile(const std::string& filename);
+
+/**
+  * FillTree() takes the input from db_filename, parses it and stores it in a_tree as SequenceMap objects.
+  * Pre-Condition: a_tree is empty.
+  * Pre-Condition: Each line in db_filename in this format: EnzymeAcronym/Sequence1/Sequence2/.../Sequence n//
+  * Pre-Condition: The file provided has a 10 line header that will be skipped over.
+ */
+template <typename TreeType>
+void FillTree(const std::string& db_filename, TreeType &a_tree);
+
+/**
+  * GetEnzymeAcronym() takes a line from a file and returns the Enzyme Acronym.
+ */
+std::string GetEnzymeAcronym(const std::string& db_line, size_t first_slash);
+
+/**
+  * Parses the db_line string to pull out the next sequence after first_slash. Returns false when none remain.
+ */
+bool GetNextRecognitionSequence(const std::string& db_line, std::string& a_reco_seq, size_t& first_slash);
+
+/**
+  * Returns the non-empty lines of query_filename.
+ */
+std::vector<std::string> ReadQueries(const std::string& query_filename);
+
+/**
+  * Seconds elapsed since start.
+ */
+double SecondsSince(std::chrono::steady_clock::time_point start);
+
+/**
+  * Runs find() on every query rounds times and prints the mean latency, hit count and average recursion calls.
+ */
+template <typename TreeType>
+void TimeFinds(const std::string& name, const TreeType& a_tree, const std::vector<std::string>& queries, int rounds);
+
+/**
+  * Builds a TreeType from db_filename, prints the build time, then times find() on the queries.
+ */
+template <typename TreeType>
+void TimeFillAndFinds(const std::string& name, const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Compares find() latency of the pointer-per-string AvlTree layout with InlineKeyAvlTree's inline key layout.
+ */
+void BenchLayout(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Compares AvlTree's node storage modes on the same workload.
+ */
+void BenchStorage(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Sorts latencies (in ns) and prints their count, p50, p99, p99.9 and max under label.
+ */
+void PrintPercentiles(const std::string& label, std::vector<long>& latencies);
+
+/**
+  * Runs reader threads against a ReloadableTree and reloads it from db_filename midway, then prints the query
+  * latency percentiles before, during and after the reload.
+ */
+void BenchReload(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Returns count random recognition sequences of 6 to 14 bases.
+ */
+std::vector<std::string> SyntheticKeys(size_t count, unsigned seed);
+
+/**
+  * Runs work(t) on threads t = 0 .. num_threads - 1 and returns the seconds until all have finished.
+ */
+template <typename Work>
+double RunThreads(int num_threads, Work work);
+
+/**
+  * Inserts synthetic keys into a ShardedIndex with 1 and with 64 shards, then looks them up, using 1 to 64 threads,
+  * and prints the throughput of each phase. Then runs print_Between() over every shard against a writer that
+  * refills, counts and empties the index, the mix that once deadlocked on ForkJoinPool( ).
+ */
+void BenchSharded();
+
+/**
+  * Answers the queries in blocks on a WorkStealingPool of 1 to 16 threads and prints the speed-up over one thread.
+ */
+void BenchPool(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Times sequential find() and InterleavedFind() with several group sizes on AvlTree and BinarySearchTree, checking
+  * that every run finds the same keys with the same total recursion calls.
+ */
+void BenchCoro(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * BenchCoro() on one tree type.
+ */
+template <typename TreeType>
+void TimeInterleavedFinds(const std::string& name, const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Times the whole-tree operations of AvlTree and BinarySearchTree built from db_filename.
+ */
+void BenchWalks(const std::string& db_filename);
+
+/**
+  * BenchWalks() on one tree type.
+ */
+template <typename TreeType>
+void TimeWalks(const std::string& name, const std::string& db_filename);
+
+/**
+  * Returns length queries drawn from keys with replacement: uniformly if zipf_exponent is 0, else with the key of
+  * rank r (in a random ranking) drawn with probability proportional to 1 / r^zipf_exponent.
+ */
+std::vector<std::string> MakeTrace(const std::vector<std::string>& keys, size_t length, double zipf_exponent, unsigned seed);
+
+/**
+  * Compares AvlTree and SplayTree on a uniform and on Zipf query traces over the query file's sequences.
+ */
+void BenchSkew(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Runs find() on every query of trace and prints the average recursion calls and the latency.
+ */
+template <typename TreeType>
+void TimeTrace(const std::string& name, TreeType& a_tree, const std::vector<std::string>& trace);
+
+/**
+  * Compares AvlTree and RedBlackTree on building the database, on remove_Sequences()' workload (removing every
+  * other query) and on a trace that alternates inserting new sequences with removing old ones.
+ */
+void BenchWrites(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Applies the operations of trace to a_tree, inserting where insert[ i ] is true and removing otherwise, and prints
+  * the rotations per operation and the throughput.
+ */
+template <typename TreeType>
+void TimeWrites(const std::string& name, TreeType& a_tree, const std::vector<std::string>& trace, const std::vector<bool>& insert);
+
+/**
+  * Compares find_and_print() on an AvlTree with the same tree behind a CachedTree, on Zipf and uniform traces over
+  * the query file's sequences, without and with 1% of the operations being inserts that invalidate cache entries.
+  * Then measures the cached tree's throughput from 1 to 8 threads.
+ */
+void BenchCache(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Calls find_and_print() for every key of trace, rendering into a string stream. Where write[ i ] is true it first
+  * changes that key's element: the acronym "NewC" is added with insert(), or taken out again with remove_Acronym()
+  * if an earlier write added it. Returns the mean time per operation in ns.
+ */
+template <typename TreeType>
+double TimePrints(TreeType& a_tree, const std::vector<std::string>& trace, const std::vector<bool>& write);
+
+/**
+  * Builds a_tree from db_filename with its bulk loader, parsing as FillTree() does.
+ */
+template <typename TreeType>
+void BulkLoadTree(const std::string& db_filename, TreeType &a_tree);
+
+/**
+  * Compares DiskBPlusTree under memory budgets from half to a sixteenth of its file size: bulk load time, find()
+  * latency and pages read per query, and range scans with read-ahead off and on. Then builds the tree with insert()
+  * under a quarter of the file size. The file stays in the operating system's cache, so reads are system calls
+  * and copies rather than device reads; the pages read show what a cold cache would cost.
+ */
+void BenchDisk(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Runs find() on every query and prints the latency, the pool's hit rate and the pages read per query.
+ */
+void TimeDiskFinds(const std::string& name, DiskBPlusTree<SequenceMap>& a_tree, const std::vector<std::string>& queries);
+
+/**
+  * Runs print_Between() over the two-character prefix of every 500th query, into a string, with the pool emptied
+  * first, and prints the time and the number of reads.
+ */
+void TimeDiskScans(const std::string& name, DiskBPlusTree<SequenceMap>& a_tree, const std::vector<std::string>& queries, size_t budget);
+
+/**
+  * Throughputs and latencies measured by TimeBufferedTree().
+ */
+struct BufferResult {
+    double build_rate = 0, stream_rate = 0;     // Millions of insert()s per second
+    double find_ns = 0, range_us = 0;
+    long hits = 0;
+};
+
+/**
+  * Parses db_filename into the SequenceMaps FillTree() would insert, in the same order.
+ */
+std::vector<SequenceMap> ReadRecords(const std::string& db_filename);
+
+/**
+  * Compares AvlTree with BufferedAvlTree at several buffer capacities: the time to insert every record of the
+  * database, then a stream of a million new synthetic keys, and afterwards the latency of find() over the queries
+  * and of print_Between() over ranges starting at every 160th query, with whatever the buffer still holds.
+ */
+void BenchBuffer(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Runs BenchBuffer()'s workload on a_tree, which starts empty.
+ */
+template <typename TreeType>
+BufferResult TimeBufferedTree(TreeType& a_tree, const std::vector<SequenceMap>& records, const std::vector<std::string>& fresh, const std::vector<std::string>& queries);
+
+/**
+  * Builds AvlTree and BinarySearchTree from db_filename, churns them as remove_Sequences() does (removing every other
+  * query) and with a stream of synthetic inserts and removes, then compares find() and the walks before and after
+  * compaction.
+ */
+void BenchCompact(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * BenchCompact() on one tree type. Compacts with compact_Step( 1000 ), answering a query and, every fourth step,
+  * inserting and removing a synthetic key between steps, and prints the step pauses; then times compact( ) in one go.
+ */
+template <typename TreeType>
+void TimeCompaction(const std::string& name, const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Prints how long count_Nodes() and calculate_IPL() take on a_tree.
+ */
+template <typename TreeType>
+void TimeTraversals(const std::string& name, const TreeType& a_tree);
+
+/**
+  * Compares LockFreeSkipList with ShardedIndex<AvlTree> behind 1 and 64 locks, with 1, 2, 4, ... threads up to the
+  * number of cores.
+ */
+void BenchSkipList();
+
+/**
+  * BenchSkipList() on one structure, which make() returns empty. Prints the throughput of inserting keys, of
+  * inserting them again (every insert a Merge()), and of a mix of 80% find(), 10% insert() and 10% remove().
+ */
+template <typename IndexType, typename Make>
+void TimeConcurrentIndex(const std::string& name, Make make, const std::vector<std::string>& keys,
+                         const std::vector<std::string>& lookups, const std::vector<int>& thread_counts);
+
+/**
+  * Compares find() with find() from a Cursor on AvlTree and BinarySearchTree.
+ */
+void BenchFinger(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * BenchFinger() on one tree type. Draws batches of 1k to 1M queries at random and prints the find() latency and
+  * average recursion calls with and without a Cursor, on the batch as drawn and sorted.
+ */
+template <typename TreeType>
+void TimeFingerSearch(const std::string& name, const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Builds LearnedIndexes with several error bounds from an AvlTree and compares them with the tree.
+ */
+void BenchLearned(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Times for_Each_Between() over the keys that start with the first prefix_length characters of every 16th query,
+  * and prints the time per range and the keys per range.
+ */
+template <typename TreeType>
+void TimeRanges(const std::string& name, const TreeType& a_tree, const std::vector<std::string>& queries, size_t prefix_length);
+
+/**
+  * Builds FrontCodedIndexes with several block sizes from an AvlTree and compares their memory and speed with the
+  * tree's.
+ */
+void BenchCompressed(const std::string& db_filename, const std::vector<std::string>& queries);
+
+/**
+  * Times find_and_print() into a string stream on every 4th query, then a for_Each() over the whole of a_tree.
+ */
+template <typename TreeType>
+void TimePrintsAndWalk(const std::string& name, const TreeType& a_tree, const std::vector<std::string>& queries);
+
+/**
+  * Returns the bytes of heap in use, or 0 where the C library cannot tell.
+ */
+size_t HeapInUse();
+
+/**
+  * Builds AvlTree and BinarySearchTree from the records of db_filename in each of the ways the trees offer.
+ */
+void BenchIngest(const std::string& db_filename);
+
+/**
+  * BenchIngest() on one tree type. Prints the heap allocations and time per record of each way of building it.
+ */
+template <typename TreeType>
+void TimeIngest(const std::string& name, const std::vector<std::pair<std::string, std::string> >& records);
+
+/**
+  * Heap allocations made so far by the calling thread, counted by the operator new below.
+ */
+thread_local long thread_allocations = 0;
+
+void* operator new(size_t size) {
+    thread_allocations++;
+    if (void* p = malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {    //Kept out of line so GCC does not see free()
+    free(p);                                                            //meet a new-expression and warn of a mismatch
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <databasefilename> <queryfilename> <mode>" << std::endl;
+        return 0;
+    }
+    std::string db_filename(argv[1]);
+    std::string query_filename(argv[2]);
+    std::string mode(argv[3]);
+    CheckFile(db_filename);
+    CheckFile(query_filename);
+    std::vector<std::string> queries = ReadQueries(query_filename);
+    std::cout << "Input file is " << db_filename << ", and query file is " << query_filename
+              << " (" << queries.size() << " queries)" << std::endl;
+
+    if (mode == "layout")
+        BenchLayout(db_filename, queries);
+    else if (mode == "storage")
+        BenchStorage(db_filename, queries);
+    else if (mode == "reload")
+        BenchReload(db_filename, queries);
+    else if (mode == "sharded")
+        BenchSharded();
+    else if (mode == "pool")
+        BenchPool(db_filename, queries);
+    else if (mode == "coro")
+        BenchCoro(db_filename, queries);
+    else if (mode == "walks")
+        BenchWalks(db_filename);
+    else if (mode == "skew")
+        BenchSkew(db_filename, queries);
+    else if (mode == "writes")
+        BenchWrites(db_filename, queries);
+    else if (mode == "cache")
+        BenchCache(db_filename, queries);
+    else if (mode == "disk")
+        BenchDisk(db_filename, queries);
+    else if (mode == "buffer")
+        BenchBuffer(db_filename, queries);
+    else if (mode == "compact")
+        BenchCompact(db_filename, queries);
+    else if (mode == "skiplist")
+        BenchSkipList();
+    else if (mode == "finger")
+        BenchFinger(db_filename, queries);
+    else if (mode == "learned")
+        BenchLearned(db_filename, queries);
+    else if (mode == "compressed")
+        BenchCompressed(db_filename, queries);
+    else if (mode == "ingest")
+        BenchIngest(db_filename);
+    else
+        std::cout << "Unknown mode " << mode << " (User should provide layout, storage, reload, sharded, pool, coro, walks, skew, writes, cache, disk, buffer, compact, skiplist, finger, learned, compressed or ingest)" << std::endl;
+    return 0;
+}
+
+void BenchLayout(const std::string& db_filename, const std::vector<std::string>& queries) {
+    TimeFillAndFinds<AvlTree<SequenceMap> >("AvlTree", db_filename, queries);
+    TimeFillAndFinds<InlineKeyAvlTree<SequenceMap> >("InlineKeyAvlTree", db_filename, queries);
+}
+
+void BenchStorage(const std::string& db_filename, const std::vector<std::string>& queries) {
+    TimeFillAndFinds<AvlTree<SequenceMap, PointerNodes> >("AvlTree<PointerNodes>", db_filename, queries);
+    TimeFillAndFinds<AvlTree<SequenceMap, IndexedNodes> >("AvlTree<IndexedNodes>", db_filename, queries);
+}
+
+template <typename TreeType>
+void TimeFillAndFinds(const std::string& name, const std::string& db_filename, const std::vector<std::string>& queries) {
+    TreeType a_tree;
+    auto start = std::chrono::steady_clock::now();
+    FillTree(db_filename, a_tree);
+    std::cout << name << ": built " << a_tree.count_Nodes() << " nodes in " << SecondsSince(start) << " s." << std::endl;
+    TimeFinds(name, a_tree, queries, 5);
+}
+
+template <typename TreeType>
+void TimeFinds(const std::string& name, const TreeType& a_tree, const std::vector<std::string>& queries, int rounds) {
+    long hits = 0, sum_recursion_calls = 0;
+    int recursion_calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++)
+        for (size_t i = 0; i < queries.size(); i++) {
+            if (a_tree.find(queries[i], recursion_calls))
+                hits++;
+            sum_recursion_calls += recursion_calls;
+        }
+    double seconds = SecondsSince(start);
+    long lookups = long(queries.size()) * rounds;
+    std::cout << name << ": " << seconds * 1e9 / lookups << " ns per find(), " << hits / rounds << " hits, "
+              << double(sum_recursion_calls) / lookups << " recursion calls on average." << std::endl;
+}
+
+void BenchReload(const std::string& db_filename, const std::vector<std::string>& queries) {
+    typedef AvlTree<SequenceMap> TreeType;
+    const int num_readers = 2;
+    std::shared_ptr<TreeType> initial = std::make_shared<TreeType>();
+    FillTree(db_filename, *initial);
+    ReloadableTree<TreeType> trees(initial);
+    initial.reset();
+
+    std::atomic<int> phase(0);                                  // 0 before, 1 during, 2 after the reload
+    std::atomic<bool> stop(false);
+    std::vector<std::vector<long> > latencies(num_readers * 3);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < num_readers; r++)
+        readers.emplace_back([&, r]() {
+            int recursion_calls = 0;
+            for (size_t i = r; !stop.load(); i = (i + 1) % queries.size()) {
+                int current_phase = phase.load();
+                auto start = std::chrono::steady_clock::now();
+                std::shared_ptr<const TreeType> a_tree = trees.acquire();
+                a_tree->find(queries[i], recursion_calls);
+                a_tree.reset();
+                long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                latencies[r * 3 + current_phase].push_back(ns);
+            }
+        });
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    phase.store(1);
+    auto start = std::chrono::steady_clock::now();
+    trees.reload([&db_filename](TreeType& a_tree) { FillTree(db_filename, a_tree); });
+    trees.waitForReload();
+    std::cout << "Reload (build, swap and retire) took " << SecondsSince(start) << " s." << std::endl;
+    phase.store(2);
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    stop.store(true);
+    for (size_t r = 0; r < readers.size(); r++)
+        readers[r].join();
+
+    const char *labels[] = { "before reload", "during reload", "after reload" };
+    for (int p = 0; p < 3; p++) {
+        std::vector<long> merged;
+        for (int r = 0; r < num_readers; r++)
+            merged.insert(merged.end(), latencies[r * 3 + p].begin(), latencies[r * 3 + p].end());
+        PrintPercentiles(labels[p], merged);
+    }
+}
+
+void BenchSharded() {
+    typedef AvlTree<SequenceMap> TreeType;
+    std::vector<std::string> keys = SyntheticKeys(400000, 1);
+    std::vector<std::string> lookups = SyntheticKeys(400000, 2);      // Mostly misses
+    lookups.insert(lookups.end(), keys.begin(), keys.end());
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937(3));
+    std::cout << "shards threads  insert Mops/s  find Mops/s" << std::endl;
+    for (size_t num_shards : { 1, 64 })
+        for (int num_threads = 1; num_threads <= 64; num_threads *= 2) {
+            ShardedIndex<TreeType> index(ShardedIndex<TreeType>::sample_Splitters(keys, num_shards));
+            double insert_seconds = RunThreads(num_threads, [&](int t) {
+                for (size_t i = t; i < keys.size(); i += num_threads)
+                    index.insert(SequenceMap(keys[i], "SynI"));
+            });
+            std::atomic<long> hits(0);
+            double find_seconds = RunThreads(num_threads, [&](int t) {
+                int recursion_calls = 0;
+                long my_hits = 0;
+                for (size_t i = t; i < lookups.size(); i += num_threads)
+                    my_hits += index.find(lookups[i], recursion_calls);
+                hits += my_hits;
+            });
+            std::cout << std::setw(6) << index.shard_Count() << std::setw(8) << num_threads
+                      << std::setw(15) << keys.size() / insert_seconds / 1e6
+                      << std::setw(13) << lookups.size() / find_seconds / 1e6 << std::endl;
+        }
+
+    // Both sides fork tree walks on ForkJoinPool( ) while holding shard locks: 10000 keys a shard is above the grain
+    keys.resize(40000);
+    ShardedIndex<TreeType> index(ShardedIndex<TreeType>::sample_Splitters(keys, 4));
+    std::atomic<bool> stop(false);
+    std::atomic<long> refills(0), ranges(0);
+    std::ofstream discard("/dev/null");
+    std::streambuf *console = std::cout.rdbuf(discard.rdbuf());
+    double seconds = RunThreads(3, [&](int t) {
+        if (t == 0) {
+            std::this_thread::sleep_for(std::chrono::seconds(5));
+            stop = true;
+        } else if (t == 1) {
+            while (!stop) {
+                for (size_t i = 0; i < keys.size() && !stop; i++)
+                    index.insert(SequenceMap(keys[i], "SynI"));
+                index.count_Nodes();
+                index.makeEmpty();
+                refills++;
+            }
+        } else {
+            while (!stop) {
+                index.print_Between("A", "TTTTTTTTTTTTTTT");
+                ranges++;
+            }
+        }
+    });
+    std::cout.rdbuf(console);
+    std::cout << "4 shards: " << refills << " refills and " << ranges << " print_Between() over all shards in "
+              << seconds << " s" << std::endl;
+}
+
+void BenchPool(const std::string& db_filename, const std::vector<std::string>& queries) {
+    AvlTree<SequenceMap> a_tree;
+    FillTree(db_filename, a_tree);
+    const int rounds = 5;
+    double one_thread_seconds = 0;
+    std::cout << "threads  ns per find()  speed-up  hits" << std::endl;
+    for (int num_threads = 1; num_threads <= 16; num_threads *= 2) {
+        WorkStealingPool pool(num_threads - 1);
+        std::vector<long> hits(pool.slot_Count() * 8);               // Eight longs apart, so slots do not share a line
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; round++)
+            pool.parallel_For(0, queries.size(), 1024, [&](size_t first, size_t last, size_t slot) {
+                int recursion_calls = 0;
+                for (size_t i = first; i < last; i++)
+                    hits[slot * 8] += a_tree.find(queries[i], recursion_calls);
+            });
+        double seconds = SecondsSince(start);
+        if (num_threads == 1)
+            one_thread_seconds = seconds;
+        long total_hits = 0;
+        for (size_t i = 0; i < hits.size(); i++)
+            total_hits += hits[i];
+        std::cout << std::setw(7) << num_threads << std::setw(15) << seconds * 1e9 / (double(queries.size()) * rounds)
+                  << std::setw(10) << one_thread_seconds / seconds << std::setw(8) << total_hits / rounds << std::endl;
+    }
+}
+
+void BenchCoro(const std::string& db_filename, const std::vector<std::string>& queries) {
+#if defined(__cpp_impl_coroutine)
+    TimeInterleavedFinds<AvlTree<SequenceMap> >("AvlTree", db_filename, queries);
+    TimeInterleavedFinds<BinarySearchTree<SequenceMap> >("BinarySearchTree", db_filename, queries);
+#else
+    std::cout << "The coro mode needs coroutines; rebuild BenchTrees with -std=c++20." << std::endl;
+#endif
+}
+
+template <typename TreeType>
+void TimeInterleavedFinds(const std::string& name, const std::string& db_filename, const std::vector<std::string>& queries) {
+#if defined(__cpp_impl_coroutine)
+    TreeType a_tree;
+    FillTree(db_filename, a_tree);
+    std::cout << name << ": " << a_tree.count_Nodes() << " nodes." << std::endl;
+    long hits = 0, sum_recursion_calls = 0;
+    int recursion_calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); i++) {
+        hits += a_tree.find(queries[i], recursion_calls);
+        sum_recursion_calls += recursion_calls;
+    }
+    double sequential_seconds = SecondsSince(start);
+    std::cout << "  find():            " << sequential_seconds * 1e9 / queries.size() << " ns per lookup, " << hits
+              << " hits, " << sum_recursion_calls << " recursion calls" << std::endl;
+    for (size_t group_size = 1; group_size <= 64; group_size *= 2) {
+        long group_hits = 0, group_recursion_calls = 0;
+        start = std::chrono::steady_clock::now();
+        InterleavedFind(a_tree, queries, group_size, [&](size_t, bool found, int calls) {
+            group_hits += found;
+            group_recursion_calls += calls;
+        });
+        double seconds = SecondsSince(start);
+        std::cout << "  G = " << std::setw(2) << group_size << ":          " << seconds * 1e9 / queries.size()
+                  << " ns per lookup (" << sequential_seconds / seconds << "x)"
+                  << (group_hits == hits && group_recursion_calls == sum_recursion_calls ? "" : ", COUNTS DIFFER")
+                  << std::endl;
+    }
+#endif
+}
+
+void BenchWalks(const std::string& db_filename) {
+    std::cout << "Fork-join walks use " << ForkJoinPool().slot_Count() << " threads." << std::endl;
+    TimeWalks<AvlTree<SequenceMap> >("AvlTree", db_filename);
+    TimeWalks<BinarySearchTree<SequenceMap> >("BinarySearchTree", db_filename);
+}
+
+template <typename TreeType>
+void TimeWalks(const std::string& name, const std::string& db_filename) {
+    TreeType *a_tree = new TreeType;
+    FillTree(db_filename, *a_tree);
+    auto start = std::chrono::steady_clock::now();
+    TreeType *copy = new TreeType(*a_tree);
+    double copy_seconds = SecondsSince(start);
+    start = std::chrono::steady_clock::now();
+    int nodes = copy->count_Nodes();
+    double count_seconds = SecondsSince(start);
+    start = std::chrono::steady_clock::now();
+    int ipl = copy->calculate_IPL();
+    double ipl_seconds = SecondsSince(start);
+    std::ofstream discard("/dev/null");
+    std::streambuf *console = std::cout.rdbuf(discard.rdbuf());
+    start = std::chrono::steady_clock::now();
+    copy->printTree();
+    double print_seconds = SecondsSince(start);
+    std::cout.rdbuf(console);
+    start = std::chrono::steady_clock::now();
+    delete copy;
+    double teardown_seconds = SecondsSince(start);
+    delete a_tree;
+    std::cout << name << ": " << nodes << " nodes, IPL " << ipl << ". copy " << copy_seconds << " s, count_Nodes() "
+              << count_seconds << " s, calculate_IPL() " << ipl_seconds << " s, printTree() " << print_seconds
+              << " s, teardown " << teardown_seconds << " s." << std::endl;
+}
+
+void BenchSkew(const std::string& db_filename, const std::vector<std::string>& queries) {
+    AvlTree<SequenceMap> avl_tree;
+    SplayTree<SequenceMap> splay_tree;
+    FillTree(db_filename, avl_tree);
+    FillTree(db_filename, splay_tree);
+    const double exponents[] = { 0, 0.8, 1.0, 1.2 };
+    for (double exponent : exponents) {
+        std::vector<std::string> trace = MakeTrace(queries, 2000000, exponent, 4);
+        std::cout << (exponent == 0 ? std::string("Uniform trace") : "Zipf trace, s = " + std::to_string(exponent).substr(0, 3))
+                  << ":" << std::endl;
+        TimeTrace("  AvlTree  ", avl_tree, trace);
+        TimeTrace("  SplayTree", splay_tree, trace);
+    }
+}
+
+template <typename TreeType>
+void TimeTrace(const std::string& name, TreeType& a_tree, const std::vector<std::string>& trace) {
+    long hits = 0, sum_recursion_calls = 0;
+    int recursion_calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < trace.size(); i++) {
+        hits += a_tree.find(trace[i], recursion_calls);
+        sum_recursion_calls += recursion_calls;
+    }
+    double seconds = SecondsSince(start);
+    std::cout << name << ": " << double(sum_recursion_calls) / trace.size() << " recursion calls, "
+              << seconds * 1e9 / trace.size() << " ns per find(), " << hits << " hits" << std::endl;
+}
+
+void BenchWrites(const std::string& db_filename, const std::vector<std::string>& queries) {
+    AvlTree<SequenceMap> avl_tree;
+    RedBlackTree<SequenceMap> rb_tree;
+    auto start = std::chrono::steady_clock::now();
+    FillTree(db_filename, avl_tree);
+    double avl_seconds = SecondsSince(start);
+    start = std::chrono::steady_clock::now();
+    FillTree(db_filename, rb_tree);
+    double rb_seconds = SecondsSince(start);
+    int nodes = avl_tree.count_Nodes();
+    std::cout << "Build (" << nodes << " nodes):" << std::endl;
+    std::cout << "  AvlTree     : " << double(avl_tree.rotation_Count()) / nodes << " rotations per node, "
+              << avl_seconds << " s, height " << avl_tree.heightOfTree() << std::endl;
+    std::cout << "  RedBlackTree: " << double(rb_tree.rotation_Count()) / nodes << " rotations per node, "
+              << rb_seconds << " s, height " << rb_tree.heightOfTree() << std::endl;
+
+    std::vector<std::string> removals;
+    for (size_t i = 0; i < queries.size(); i += 2)
+        removals.push_back(queries[i]);
+    std::cout << "remove_Sequences() workload (" << removals.size() << " removes):" << std::endl;
+    TimeWrites("  AvlTree     ", avl_tree, removals, std::vector<bool>(removals.size(), false));
+    TimeWrites("  RedBlackTree", rb_tree, removals, std::vector<bool>(removals.size(), false));
+
+    // Churn: each step inserts a new synthetic sequence and removes the one inserted 1000 steps earlier, so the tree
+    // keeps its size while every operation changes its shape.
+    const size_t kSteps = 1000000, kLag = 1000;
+    std::vector<std::string> keys = SyntheticKeys(kSteps, 9);
+    std::vector<std::string> trace;
+    std::vector<bool> insert;
+    for (size_t i = 0; i < kSteps; i++) {
+        trace.push_back(keys[i]);
+        insert.push_back(true);
+        if (i >= kLag) {
+            trace.push_back(keys[i - kLag]);
+            insert.push_back(false);
+        }
+    }
+    std::cout << "Mixed insert/remove trace (" << trace.size() << " operations):" << std::endl;
+    TimeWrites("  AvlTree     ", avl_tree, trace, insert);
+    TimeWrites("  RedBlackTree", rb_tree, trace, insert);
+}
+
+template <typename TreeType>
+void TimeWrites(const std::string& name, TreeType& a_tree, const std::vector<std::string>& trace, const std::vector<bool>& insert) {
+    std::vector<SequenceMap> elements;
+    for (size_t i = 0; i < trace.size(); i++)
+        elements.push_back(SequenceMap(insert[i] ? trace[i] : std::string(), "NewI"));
+    long rotations_before = a_tree.rotation_Count();
+    int recursion_calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < trace.size(); i++) {
+        if (insert[i])
+            a_tree.insert(std::move(elements[i]));
+        else
+            a_tree.remove(trace[i], recursion_calls);
+    }
+    double seconds = SecondsSince(start);
+    std::cout << name << ": " << double(a_tree.rotation_Count() - rotations_before) / trace.size()
+              << " rotations per operation, " << trace.size() / seconds / 1e6 << " M operations/s" << std::endl;
+}
+
+void BenchCache(const std::string& db_filename, const std::vector<std::string>& queries) {
+    const size_t kCacheEntries = 16384, kTraceLength = 2000000;
+    std::cout << "Cache of " << kCacheEntries << " entries." << std::endl;
+    std::cout << "trace           writes  AvlTree ns  cached ns  hit rate  evictions  invalidations" << std::endl;
+    const double exponents[] = { 0, 0.8, 1.0, 1.2 };
+    for (double exponent : exponents)
+        for (int write_percent : { 0, 1 }) {
+            std::vector<std::string> trace = MakeTrace(queries, kTraceLength, exponent, 5);
+            std::vector<bool> write(trace.size(), false);
+            std::mt19937 random(6);
+            for (size_t i = 0; i < write.size(); i++)
+                write[i] = int(random() % 100) < write_percent;
+            AvlTree<SequenceMap> avl_tree;
+            CachedTree<AvlTree<SequenceMap> > cached_tree(kCacheEntries);
+            FillTree(db_filename, avl_tree);
+            FillTree(db_filename, cached_tree);
+            const LookupCache<std::shared_ptr<const std::string> >& cache = cached_tree.cache();
+            uint64_t fill_invalidations = cache.invalidations();
+            double avl_ns = TimePrints(avl_tree, trace, write);
+            double cached_ns = TimePrints(cached_tree, trace, write);
+            std::cout << std::left << std::setw(16) << (exponent == 0 ? std::string("uniform") : "Zipf s = " + std::to_string(exponent).substr(0, 3))
+                      << std::right << std::setw(5) << write_percent << "%" << std::setw(12) << avl_ns
+                      << std::setw(11) << cached_ns << std::setw(10) << double(cache.hits()) / (cache.hits() + cache.misses())
+                      << std::setw(11) << cache.evictions() << std::setw(15) << cache.invalidations() - fill_invalidations << std::endl;
+        }
+
+    std::vector<std::string> trace = MakeTrace(queries, kTraceLength, 1.0, 7);
+    CachedTree<AvlTree<SequenceMap> > cached_tree(kCacheEntries);
+    FillTree(db_filename, cached_tree);
+    std::cout << "threads  Zipf s = 1.0 cached Mops/s" << std::endl;
+    for (int num_threads = 1; num_threads <= 8; num_threads *= 2) {
+        double seconds = RunThreads(num_threads, [&](int t) {
+            std::ostringstream out;
+            for (size_t i = t; i < trace.size(); i += num_threads) {
+                out.str("");
+                cached_tree.find_and_print(trace[i], out);
+            }
+        });
+        std::cout << std::setw(7) << num_threads << std::setw(29) << trace.size() / seconds / 1e6 << std::endl;
+    }
+}
+
+template <typename TreeType>
+double TimePrints(TreeType& a_tree, const std::vector<std::string>& trace, const std::vector<bool>& write) {
+    std::ostringstream out;
+    std::unordered_set<std::string> written;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < trace.size(); i++) {
+        if (write[i]) {
+            if (written.erase(trace[i]) > 0)
+                a_tree.remove_Acronym(trace[i], "NewC");
+            else {
+                a_tree.insert(SequenceMap(trace[i], "NewC"));
+                written.insert(trace[i]);
+            }
+        }
+        out.str("");
+        a_tree.find_and_print(trace[i], out);
+    }
+    return SecondsSince(start) * 1e9 / trace.size();
+}
+
+std::vector<std::string> MakeTrace(const std::vector<std::string>& keys, size_t length, double zipf_exponent, unsigned seed) {
+    std::mt19937 random(seed);
+    std::vector<size_t> ranking(keys.size());
+    for (size_t i = 0; i < ranking.size(); i++)
+        ranking[i] = i;
+    std::shuffle(ranking.begin(), ranking.end(), random);
+    std::vector<double> cumulative(keys.size());
+    double total = 0;
+    for (size_t r = 0; r < keys.size(); r++)
+        cumulative[r] = total += 1.0 / std::pow(double(r + 1), zipf_exponent);
+    std::uniform_real_distribution<double> pick(0, total);
+    std::vector<std::string> trace(length);
+    for (size_t i = 0; i < length; i++) {
+        size_t rank = std::lower_bound(cumulative.begin(), cumulative.end(), pick(random)) - cumulative.begin();
+        trace[i] = keys[ranking[std::min(rank, keys.size() - 1)]];
+    }
+    return trace;
+}
+
+std::vector<std::string> SyntheticKeys(size_t count, unsigned seed) {
+    std::mt19937 random(seed);
+    std::vector<std::string> keys(count);
+    for (size_t i = 0; i < count; i++) {
+        size_t length = 6 + random() % 9;
+        for (size_t j = 0; j < length; j++)
+            keys[i].push_back("ACGT"[random() % 4]);
+    }
+    return keys;
+}
+
+template <typename Work>
+double RunThreads(int num_threads, Work work) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < num_threads; t++)
+        threads.emplace_back(work, t);
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+    return SecondsSince(start);
+}
+
+void PrintPercentiles(const std::string& label, std::vector<long>& latencies) {
+    if (latencies.empty()) {
+        std::cout << label << ": no queries." << std::endl;
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    size_t n = latencies.size();
+    std::cout << label << ": " << n << " queries, p50 " << latencies[n / 2] << " ns, p99 " << latencies[n * 99 / 100]
+              << " ns, p99.9 " << latencies[n * 999 / 1000] << " ns, max " << latencies[n - 1] << " ns." << std::endl;
+}
+
+void BenchDisk(const std::string& db_filename, const std::vector<std::string>& queries) {
+    size_t file_bytes;
+    {
+        DiskBPlusTree<SequenceMap> a_tree;
+        BulkLoadTree(db_filename, a_tree);
+        file_bytes = size_t(a_tree.page_Count()) * DiskBPlusTree<SequenceMap>::kDefaultPageSize;
+        std::cout << "DiskBPlusTree: " << a_tree.count_Nodes() << " elements, height " << a_tree.heightOfTree() << ", "
+                  << file_bytes / 1024 << " KiB file." << std::endl;
+    }
+    {
+        AvlTree<SequenceMap> avl_tree;
+        FillTree(db_filename, avl_tree);
+        TimeFinds("AvlTree (in memory)", avl_tree, queries, 1);
+    }
+    for (size_t divisor : {2, 4, 8, 16}) {
+        size_t budget = file_bytes / divisor;
+        std::ostringstream name;
+        name << "budget 1/" << divisor << " (" << budget / 1024 << " KiB)";
+        DiskBPlusTree<SequenceMap> a_tree("", budget);
+        auto start = std::chrono::steady_clock::now();
+        BulkLoadTree(db_filename, a_tree);
+        std::cout << name.str() << ": bulk load " << SecondsSince(start) << " s." << std::endl;
+        TimeDiskFinds("  find()", a_tree, queries);
+        a_tree.set_Read_Ahead(0);
+        TimeDiskScans("  scans, no read-ahead      ", a_tree, queries, budget);
+        a_tree.set_Read_Ahead(DiskBPlusTree<SequenceMap>::kDefaultReadAhead);
+        TimeDiskScans("  scans, read-ahead 32 pages", a_tree, queries, budget);
+    }
+    DiskBPlusTree<SequenceMap> a_tree("", file_bytes / 4);
+    auto start = std::chrono::steady_clock::now();
+    FillTree(db_filename, a_tree);
+    std::cout << "Built by insert() with budget 1/4: " << SecondsSince(start) << " s, "
+              << size_t(a_tree.page_Count()) * DiskBPlusTree<SequenceMap>::kDefaultPageSize / 1024 << " KiB file." << std::endl;
+    TimeDiskFinds("  find()", a_tree, queries);
+    TimeDiskScans("  scans, read-ahead 32 pages", a_tree, queries, file_bytes / 4);
+}
+
+void TimeDiskFinds(const std::string& name, DiskBPlusTree<SequenceMap>& a_tree, const std::vector<std::string>& queries) {
+    a_tree.reset_stats();
+    int recursion_calls = 0, hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); i++)
+        hits += a_tree.find(queries[i], recursion_calls);
+    double seconds = SecondsSince(start);
+    BufferPool::Stats stats = a_tree.pool_Stats();
+    std::cout << name << ": " << seconds * 1e9 / queries.size() << " ns per query, " << hits << " hits, pool hit rate "
+              << double(stats.hits) / (stats.hits + stats.misses) << ", "
+              << double(stats.pages_read) / queries.size() << " pages read per query." << std::endl;
+}
+
+void TimeDiskScans(const std::string& name, DiskBPlusTree<SequenceMap>& a_tree, const std::vector<std::string>& queries, size_t budget) {
+    a_tree.set_Memory_Budget(budget);                   //Empties the pool, so every scan starts cold
+    a_tree.reset_stats();
+    size_t scans = 0, bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); i += 500) {
+        std::string lower = queries[i].substr(0, 2);
+        std::ostringstream out;
+        a_tree.print_Between(lower, lower + "~", out);
+        bytes += out.str().size();
+        scans++;
+    }
+    double seconds = SecondsSince(start);
+    BufferPool::Stats stats = a_tree.pool_Stats();
+    std::cout << name << ": " << seconds * 1000 / scans << " ms per scan (" << bytes / scans << " bytes), "
+              << double(stats.reads) / scans << " reads and " << double(stats.pages_read) / scans << " pages per scan, "
+              << stats.prefetch_hits << " of " << stats.prefetched << " pages read ahead were used." << std::endl;
+}
+
+void BenchBuffer(const std::string& db_filename, const std::vector<std::string>& queries) {
+    std::vector<SequenceMap> records = ReadRecords(db_filename);
+    std::vector<std::string> fresh = SyntheticKeys(1000000, 11);
+    std::cout << records.size() << " records, then " << fresh.size() << " new synthetic keys." << std::endl;
+    std::cout << "buffer   build M/s  stream M/s  merges  buffered  find ns  range us  hits" << std::endl;
+    auto print = [](const std::string& name, const BufferResult& result, long merges, size_t buffered) {
+        std::cout << std::setw(7) << name << std::fixed << std::setprecision(2) << std::setw(11) << result.build_rate
+                  << std::setw(12) << result.stream_rate << std::setw(8) << merges << std::setw(10) << buffered
+                  << std::setprecision(0) << std::setw(9) << result.find_ns << std::setprecision(1)
+                  << std::setw(10) << result.range_us << std::setw(7) << result.hits << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+    };
+    long hits = 0;
+    {
+        AvlTree<SequenceMap> a_tree;
+        BufferResult result = TimeBufferedTree(a_tree, records, fresh, queries);
+        print("none", result, 0, 0);
+        hits = result.hits;
+    }
+    for (size_t capacity : {64, 1024, 4096, 65536, 1048576}) {
+        BufferedAvlTree<SequenceMap> a_tree(capacity);
+        BufferResult result = TimeBufferedTree(a_tree, records, fresh, queries);
+        print(std::to_string(capacity), result, a_tree.merge_Count(), a_tree.buffered_Count());
+    }
+    // The filter starts empty, so merges overflow it and rebuild it many times
+    for (size_t capacity : {64, 65536}) {
+        BufferedAvlTree<SequenceMap> a_tree(capacity);
+        a_tree.enable_Filter();
+        BufferResult result = TimeBufferedTree(a_tree, records, fresh, queries);
+        print(std::to_string(capacity) + "+f", result, a_tree.merge_Count(), a_tree.buffered_Count());
+        if (result.hits != hits)
+            std::cout << "  The filter lost keys: " << result.hits << " hits instead of " << hits << "." << std::endl;
+    }
+}
+
+template <typename TreeType>
+BufferResult TimeBufferedTree(TreeType& a_tree, const std::vector<SequenceMap>& records, const std::vector<std::string>& fresh, const std::vector<std::string>& queries) {
+    BufferResult result;
+    std::vector<SequenceMap> elements(records);
+    auto start = std::chrono::steady_clock::now();
+    for (SequenceMap& element : elements)
+        a_tree.insert(std::move(element));
+    result.build_rate = elements.size() / SecondsSince(start) / 1e6;
+    elements.clear();
+    for (const std::string& key : fresh)
+        elements.push_back(SequenceMap(key, "NewI"));
+    start = std::chrono::steady_clock::now();
+    for (SequenceMap& element : elements)
+        a_tree.insert(std::move(element));
+    result.stream_rate = elements.size() / SecondsSince(start) / 1e6;
+
+    int recursion_calls = 0;
+    start = std::chrono::steady_clock::now();
+    for (const std::string& query : queries)
+        result.hits += a_tree.find(query, recursion_calls);
+    result.find_ns = SecondsSince(start) * 1e9 / queries.size();
+    std::ostringstream out;
+    size_t ranges = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); i += 160, ranges++) {
+        out.str("");
+        a_tree.print_Between(queries[i], queries[i] + "~", out);
+    }
+    result.range_us = SecondsSince(start) * 1e6 / ranges;
+    return result;
+}
+
+void BenchCompact(const std::string& db_filename, const std::vector<std::string>& queries) {
+    TimeCompaction<AvlTree<SequenceMap> >("AvlTree", db_filename, queries);
+    TimeCompaction<BinarySearchTree<SequenceMap> >("BinarySearchTree", db_filename, queries);
+}
+
+template <typename TreeType>
+void TimeCompaction(const std::string& name, const std::string& db_filename, const std::vector<std::string>& queries) {
+    TreeType a_tree;
+    FillTree(db_filename, a_tree);
+    std::vector<std::string> fresh = SyntheticKeys(600000, 17);
+    int recursion_calls = 0;
+    for (size_t i = 0; i < queries.size(); i += 2)
+        a_tree.remove(queries[i], recursion_calls);
+    for (size_t i = 0; i < fresh.size(); i++) {
+        a_tree.insert(SequenceMap(fresh[i], "Churn"));
+        if (i % 2 == 1)
+            a_tree.remove(fresh[i - 1], recursion_calls);
+    }
+    std::cout << name << ": " << a_tree.count_Nodes() << " nodes after churn." << std::endl;
+    TimeFinds("  churned   find()", a_tree, queries, 3);
+    TimeTraversals("  churned  ", a_tree);
+
+    std::vector<long> pauses;
+    size_t next = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (bool done = false; !done; ) {
+        auto step_start = std::chrono::steady_clock::now();
+        done = a_tree.compact_Step(1000);
+        pauses.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - step_start).count());
+        a_tree.find(queries[next % queries.size()], recursion_calls);
+        if (next % 4 == 0) {
+            a_tree.insert(SequenceMap(fresh[next % fresh.size()], "Churn"));
+            a_tree.remove(fresh[(next + 1) % fresh.size()], recursion_calls);
+        }
+        next++;
+    }
+    double seconds = SecondsSince(start);
+    std::sort(pauses.begin(), pauses.end());
+    std::cout << "  compact_Step(1000): " << pauses.size() << " steps in " << seconds << " s, pause p50 "
+              << pauses[pauses.size() / 2] / 1000 << " us, p99 " << pauses[pauses.size() * 99 / 100] / 1000
+              << " us, max " << pauses.back() / 1000 << " us." << std::endl;
+    TimeFinds("  compacted find()", a_tree, queries, 3);
+    TimeTraversals("  compacted", a_tree);
+    start = std::chrono::steady_clock::now();
+    a_tree.compact();
+    std::cout << "  compact() in one go: " << SecondsSince(start) << " s." << std::endl;
+}
+
+template <typename TreeType>
+void TimeTraversals(const std::string& name, const TreeType& a_tree) {
+    auto start = std::chrono::steady_clock::now();
+    int nodes = a_tree.count_Nodes();
+    double count_seconds = SecondsSince(start);
+    start = std::chrono::steady_clock::now();
+    int ipl = a_tree.calculate_IPL();
+    double ipl_seconds = SecondsSince(start);
+    std::cout << name << " count_Nodes() " << count_seconds * 1000 << " ms (" << nodes << "), calculate_IPL() "
+              << ipl_seconds * 1000 << " ms (" << ipl << ")." << std::endl;
+}
+
+void BenchSkipList() {
+    typedef ShardedIndex<AvlTree<SequenceMap> > LockedIndex;
+    std::vector<std::string> keys = SyntheticKeys(400000, 1);
+    std::vector<std::string> lookups = SyntheticKeys(400000, 2);      // Mostly misses
+    lookups.insert(lookups.end(), keys.begin(), keys.end());
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937(3));
+    int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> thread_counts;
+    for (int num_threads = 1; num_threads < cores; num_threads *= 2)
+        thread_counts.push_back(num_threads);
+    thread_counts.push_back(cores);
+    std::cout << cores << " cores." << std::endl;
+    std::cout << "structure          threads  insert Mops/s  merge Mops/s  mixed Mops/s" << std::endl;
+    TimeConcurrentIndex<LockFreeSkipList<SequenceMap> >("LockFreeSkipList", [] {
+        return std::unique_ptr<LockFreeSkipList<SequenceMap> >(new LockFreeSkipList<SequenceMap>);
+    }, keys, lookups, thread_counts);
+    for (size_t num_shards : { 1, 64 })
+        TimeConcurrentIndex<LockedIndex>(num_shards == 1 ? "AvlTree, one lock" : "AvlTree, 64 locks", [&] {
+            return std::unique_ptr<LockedIndex>(new LockedIndex(LockedIndex::sample_Splitters(keys, num_shards)));
+        }, keys, lookups, thread_counts);
+}
+
+template <typename IndexType, typename Make>
+void TimeConcurrentIndex(const std::string& name, Make make, const std::vector<std::string>& keys,
+                         const std::vector<std::string>& lookups, const std::vector<int>& thread_counts) {
+    for (int num_threads : thread_counts) {
+        std::unique_ptr<IndexType> index = make();
+        double insert_seconds = RunThreads(num_threads, [&](int t) {
+            for (size_t i = t; i < keys.size(); i += num_threads)
+                index->insert(SequenceMap(keys[i], "SynI"));
+        });
+        double merge_seconds = RunThreads(num_threads, [&](int t) {
+            for (size_t i = t; i < keys.size(); i += num_threads)
+                index->insert(SequenceMap(keys[keys.size() - 1 - i], "SynM"));
+        });
+        double mixed_seconds = RunThreads(num_threads, [&](int t) {
+            int recursion_calls = 0;
+            for (size_t i = t; i < lookups.size(); i += num_threads) {
+                if (i % 10 == 0)
+                    index->insert(SequenceMap(lookups[i], "SynX"));
+                else if (i % 10 == 5)
+                    index->remove(lookups[i], recursion_calls);
+                else
+                    index->find(lookups[i], recursion_calls);
+            }
+        });
+        std::cout << std::left << std::setw(19) << name << std::right << std::setw(7) << num_threads
+                  << std::setw(15) << keys.size() / insert_seconds / 1e6 << std::setw(14) << keys.size() / merge_seconds / 1e6
+                  << std::setw(14) << lookups.size() / mixed_seconds / 1e6 << std::endl;
+    }
+}
+
+void BenchFinger(const std::string& db_filename, const std::vector<std::string>& queries) {
+    TimeFingerSearch<AvlTree<SequenceMap> >("AvlTree", db_filename, queries);
+    TimeFingerSearch<BinarySearchTree<SequenceMap> >("BinarySearchTree", db_filename, queries);
+}
+
+template <typename TreeType>
+void TimeFingerSearch(const std::string& name, const std::string& db_filename, const std::vector<std::string>& queries) {
+    TreeType a_tree;
+    FillTree(db_filename, a_tree);
+    std::cout << name << " (" << a_tree.count_Nodes() << " nodes): ns per query, with average recursion calls" << std::endl;
+    std::cout << std::setw(10) << "batch" << std::setw(24) << "random find()" << std::setw(24) << "sorted find()"
+              << std::setw(24) << "random Cursor" << std::setw(24) << "sorted Cursor" << std::endl;
+    std::mt19937 rng(47);
+    for (size_t batch_size : {size_t(1000), size_t(10000), size_t(100000), size_t(1000000)}) {
+        std::vector<std::string> batch(batch_size);
+        std::uniform_int_distribution<size_t> pick(0, queries.size() - 1);
+        for (std::string& query : batch)
+            query = queries[pick(rng)];
+        std::vector<std::string> sorted = batch;
+        std::sort(sorted.begin(), sorted.end());
+        int rounds = std::max(size_t(1), size_t(2000000) / batch_size);
+        std::cout << std::setw(10) << batch_size;
+        for (int with_cursor = 0; with_cursor < 2; with_cursor++)
+            for (const std::vector<std::string>* order : {&batch, &sorted}) {
+                long found = 0, total_calls = 0;
+                auto start = std::chrono::steady_clock::now();
+                for (int round = 0; round < rounds; round++) {
+                    typename TreeType::Cursor cursor;
+                    for (const std::string& query : *order) {
+                        int recursion_calls = 0;
+                        found += with_cursor ? a_tree.find(query, recursion_calls, cursor) : a_tree.find(query, recursion_calls);
+                        total_calls += recursion_calls;
+                    }
+                }
+                double lookups = double(rounds) * batch_size;
+                std::ostringstream cell;
+                cell << std::fixed << std::setprecision(0) << SecondsSince(start) * 1e9 / lookups << " ns ("
+                     << std::setprecision(1) << total_calls / lookups << ")";
+                std::cout << std::setw(24) << cell.str();
+                if (found == 0)
+                    std::cout << "?";
+            }
+        std::cout << std::endl;
+    }
+}
+
+void BenchLearned(const std::string& db_filename, const std::vector<std::string>& queries) {
+    AvlTree<SequenceMap> a_tree;
+    FillTree(db_filename, a_tree);
+    std::cout << "AvlTree: " << a_tree.count_Nodes() << " nodes." << std::endl;
+    TimeFinds("  find()", a_tree, queries, 3);
+    TimeRanges("  for_Each_Between()", a_tree, queries, 6);
+    TimeRanges("  for_Each_Between()", a_tree, queries, 3);
+    for (size_t max_error : {8, 32, 128}) {
+        auto start = std::chrono::steady_clock::now();
+        LearnedIndex<SequenceMap> index(a_tree, max_error);
+        double seconds = SecondsSince(start);
+        std::cout << "LearnedIndex, error bound " << max_error << ": built in " << seconds * 1000 << " ms, "
+                  << index.knot_Count() << " knots, model " << index.model_Bytes() / 1024.0 << " KiB, packed keys "
+                  << index.key_Bytes() / 1048576.0 << " MiB, measured error " << index.max_Error() << "." << std::endl;
+        TimeFinds("  find()", index, queries, 3);
+        TimeRanges("  for_Each_Between()", index, queries, 6);
+        TimeRanges("  for_Each_Between()", index, queries, 3);
+    }
+}
+
+template <typename TreeType>
+void TimeRanges(const std::string& name, const TreeType& a_tree, const std::vector<std::string>& queries, size_t prefix_length) {
+    long keys = 0, ranges = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); i += 16, ranges++) {
+        std::string prefix = queries[i].substr(0, prefix_length);
+        a_tree.for_Each_Between(prefix, prefix + "~", [&keys](const auto&) { keys++; });
+    }
+    std::cout << name << " on " << prefix_length << "-character prefixes: " << SecondsSince(start) * 1e9 / ranges
+              << " ns per range, " << double(keys) / ranges << " keys per range." << std::endl;
+}
+
+void BenchCompressed(const std::string& db_filename, const std::vector<std::string>& queries) {
+    size_t heap_before = HeapInUse();
+    auto a_tree = std::make_unique<AvlTree<SequenceMap> >();
+    FillTree(db_filename, *a_tree);
+    size_t tree_bytes = HeapInUse() - heap_before;
+    std::cout << "AvlTree: " << a_tree->count_Nodes() << " nodes, " << tree_bytes / 1048576.0 << " MiB of heap." << std::endl;
+    TimeFinds("  find()", *a_tree, queries, 3);
+    TimePrintsAndWalk("  ", *a_tree, queries);
+    TimeRanges("  for_Each_Between()", *a_tree, queries, 6);
+    TimeRanges("  for_Each_Between()", *a_tree, queries, 3);
+    for (size_t block_size : {16, 32, 64}) {
+        heap_before = HeapInUse();
+        auto start = std::chrono::steady_clock::now();
+        auto index = std::make_unique<FrontCodedIndex>(*a_tree, block_size);
+        double seconds = SecondsSince(start);
+        size_t index_bytes = HeapInUse() - heap_before;
+        std::cout << "FrontCodedIndex, blocks of " << block_size << ": built in " << seconds * 1000 << " ms, "
+                  << index_bytes / 1048576.0 << " MiB of heap (keys " << index->key_Bytes() / 1048576.0
+                  << ", acronyms " << index->acronym_Bytes() / 1048576.0 << ", acronym lists "
+                  << index->payload_Bytes() / 1048576.0 << ")";
+        if (index_bytes > 0)
+            std::cout << ", " << double(tree_bytes) / index_bytes << " times smaller than the tree";
+        std::cout << "." << std::endl;
+        TimeFinds("  find()", *index, queries, 3);
+        TimePrintsAndWalk("  ", *index, queries);
+        TimeRanges("  for_Each_Between()", *index, queries, 6);
+        TimeRanges("  for_Each_Between()", *index, queries, 3);
+    }
+}
+
+template <typename TreeType>
+void TimePrintsAndWalk(const std::string& name, const TreeType& a_tree, const std::vector<std::string>& queries) {
+    std::ostringstream out;
+    size_t prints = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); i += 4, prints++) {
+        out.str("");
+        a_tree.find_and_print(queries[i], out);
+    }
+    double print_seconds = SecondsSince(start);
+    size_t elements = 0, key_bytes = 0;
+    start = std::chrono::steady_clock::now();
+    a_tree.for_Each([&](const auto& element) {
+        elements++;
+        key_bytes += element.getRecSequence().size();
+    });
+    std::cout << name << "find_and_print() " << print_seconds * 1e9 / prints << " ns, for_Each() over "
+              << elements << " elements (" << key_bytes << " key bytes) " << SecondsSince(start) * 1000 << " ms." << std::endl;
+}
+
+void BenchIngest(const std::string& db_filename) {
+    std::vector<std::pair<std::string, std::string> > records;
+    ifstream inStream(db_filename);
+    std::string db_line, an_enz_acro, a_reco_seq, garbage_line;
+    for (int i = 0; i < 10; i ++)                               //Skip over the header and begin reading on line 11.
+        getline(inStream, garbage_line);
+    while (std::getline (inStream, db_line)) {
+        if (db_line.empty()) continue;
+        size_t first_slash = db_line.find("/");
+        an_enz_acro = GetEnzymeAcronym(db_line, first_slash);
+        while (GetNextRecognitionSequence(db_line, a_reco_seq, first_slash))
+            records.emplace_back(a_reco_seq, an_enz_acro);
+    }
+    std::cout << records.size() << " records." << std::endl;
+    TimeIngest<AvlTree<SequenceMap> >("AvlTree", records);
+    TimeIngest<BinarySearchTree<SequenceMap> >("BinarySearchTree", records);
+}
+
+template <typename TreeType>
+void TimeIngest(const std::string& name, const std::vector<std::pair<std::string, std::string> >& records) {
+    static const char* const ways[] = {"insert(copy)", "insert(temporary)", "emplace()", "upsert()"};
+    std::cout << name << ":" << std::endl;
+    for (int way = 0; way < 4; way++) {
+        double best_seconds = 0;
+        long allocations = 0;
+        int nodes = 0;
+        for (int round = 0; round < 2; round++) {                  //The faster of two builds, each on a fresh tree
+            TreeType a_tree;
+            allocations = thread_allocations;
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& record : records) {
+                const std::string& sequence = record.first;
+                const std::string& acronym = record.second;
+                if (way == 0) {
+                    SequenceMap new_sequence_map(sequence, acronym);
+                    a_tree.insert(new_sequence_map);
+                } else if (way == 1) {
+                    a_tree.insert(SequenceMap(sequence, acronym));
+                } else if (way == 2) {
+                    a_tree.emplace(sequence, acronym);
+                } else {
+                    a_tree.upsert(sequence, [&]() { return SequenceMap(sequence, acronym); },
+                                  [&](SequenceMap& element) { element.Add_Acronym(acronym); });
+                }
+            }
+            double seconds = SecondsSince(start);
+            allocations = thread_allocations - allocations;
+            nodes = a_tree.count_Nodes();
+            if (round == 0 || seconds < best_seconds)
+                best_seconds = seconds;
+        }
+        std::cout << "  " << std::left << std::setw(18) << ways[way] << std::right << std::fixed << std::setprecision(2)
+                  << double(allocations) / records.size() << " allocations and " << std::setprecision(0)
+                  << best_seconds * 1e9 / records.size() << " ns per record, " << nodes << " nodes." << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+    }
+}
+
+size_t HeapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+std::vector<SequenceMap> ReadRecords(const std::string& db_filename) {
+    std::vector<SequenceMap> records;
+    ifstream inStream(db_filename);
+    std::string db_line, an_enz_acro, a_reco_seq, garbage_line;
+    for (int i = 0; i < 10; i ++)                               //Skip over the header and begin reading on line 11.
+        getline(inStream, garbage_line);
+    while (std::getline (inStream, db_line)) {
+        if (db_line.empty()) continue;
+        size_t first_slash = db_line.find("/");
+        an_enz_acro = GetEnzymeAcronym(db_line, first_slash);
+        while (GetNextRecognitionSequence(db_line, a_reco_seq, first_slash))
+            records.push_back(SequenceMap(a_reco_seq, an_enz_acro));
+    }
+    return records;
+}
+
+template <typename TreeType>
+void BulkLoadTree(const std::string& db_filename, TreeType &a_tree) {
+    auto loader = a_tree.bulk_Loader();
+    ifstream inStream(db_filename);
+    std::string db_line, an_enz_acro, a_reco_seq, garbage_line;
+    for (int i = 0; i < 10; i ++)                               //Skip over the header and begin reading on line 11.
+        getline(inStream, garbage_line);
+    while (std::getline (inStream, db_line)) {
+        if (db_line.empty()) continue;
+        size_t first_slash = db_line.find("/");
+        an_enz_acro = GetEnzymeAcronym(db_line, first_slash);
+        while (GetNextRecognitionSequence(db_line, a_reco_seq, first_slash)) {
+            SequenceMap new_sequence_map(a_reco_seq, an_enz_acro);
+            loader.add(std::move(new_sequence_map));
+        }
+    }
+    loader.finish();
+}
+
+void CheckFile(const std::string& filename) {
+    ifstream inStream(filename);
+    if (inStream.fail()) {
+        std::cerr << "Filename not found." << std::endl;
+        exit(1);
+    }
+}
+
+template <typename TreeType>
+void FillTree(const std::string& db_filename, TreeType &a_tree) {
+    ifstream inStream(db_filename);
+    std::string db_line, an_enz_acro, a_reco_seq, garbage_line;
+    for (int i = 0; i < 10; i ++)                               //Skip over the header and begin reading on line 11.
+        getline(inStream, garbage_line);
+    while (std::getline (inStream, db_line)) {
+        if (db_line.empty()) continue;
+        size_t first_slash = db_line.find("/");
+        an_enz_acro = GetEnzymeAcronym(db_line, first_slash);
+        while (GetNextRecognitionSequence(db_line, a_reco_seq, first_slash)) {
+            SequenceMap new_sequence_map(a_reco_seq, an_enz_acro);
+            a_tree.insert(std::move(new_sequence_map));
+        }
+    }
+}
+
+std::string GetEnzymeAcronym(const std::string& db_line, size_t first_slash) {
+    return db_line.substr(0, first_slash);
+}
+
+bool GetNextRecognitionSequence(const std::string& db_line, std::string& a_reco_seq, size_t& first_slash) {
+    size_t next_slash = db_line.find("/", first_slash+1);
+    if (next_slash == first_slash + 1)    //see if there are two '/' in a row
+        return false;                     //there are no more recognition sequences (all db_lines end in "//")
+    a_reco_seq = db_line.substr(first_slash+1, next_slash-first_slash-1);
+    first_slash = next_slash;
+    return true;
+}
+
+std::vector<std::string> ReadQueries(const std::string& query_filename) {
+    ifstream inStream(query_filename);
+    std::vector<std::string> queries;
+    std::string sequence;
+    while (std::getline(inStream, sequence))
+        if (!sequence.empty())
+            queries.push_back(sequence);
+    return queries;
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -3,6 +3,18 @@ Modifications Log:
     3.2.16 Emma Kimlin: Modified private Insert() so that it calls Merge() if a duplicate is located. This assumes that 
                         all Comparables have a Merge() function.
     3.6.16 Emma Kimlin: Added find_and_print(), find(), countNodes(), calculate_IPL(), calculate_Avg_Depth() and calculate_ratio()
+    10.19.26: Added enable_Filter(), disable_Filter() and filter_Bits_Per_Key(). insert() and remove() keep the filter
+              current; find() and find_and_print() consult it first.
+    10.19.26: Added enable_Acronym_Index() and find_Acronym(). insert(), Merge() and remove() keep the index current.
+    10.19.26: Added find_Coro() for interleaved lookups (C++20).
+    10.19.26: clone(), makeEmpty(), count_Nodes(), calculate_IPL() and printTree() walk the tree with ParallelFold()
+              and ParallelInorder() from ForkJoin.h.
+    10.19.26: Added dump_stats() and reset_stats(). With TREE_STATS defined, insert(), find() and remove() record
+              their latency and probe depth (see OpStats.h).
+    10.19.26: Added find_and_print( x, out ), which writes to a given stream.
+    10.19.26: Added compact_Step() and compact(), which move the nodes into a NodeArena; nodes are freed through it.
+    10.19.26: Added the Cursor type and find( x, i, c ), which searches from where cursor c's last search ended.
+    10.19.26: Added emplace() and upsert(). insert( Comparable && ) Merge()s a duplicate by move.
 */
 #ifndef BINARY_SEARCH_TREE_H
 #define BINARY_SEARCH_TREE_H
@@ -11,7 +23,15 @@ Modifications Log:
 #include <algorithm>
 #include <iostream>
 #include "SequenceMap.h"
+#include "CuckooFilter.h"
+#include "EnzymeIndex.h"
+#include "CoroLookup.h"
+#include "ForkJoin.h"
+#include "OpStats.h"
+#include "NodeArena.h"
+#include "TreeCursor.h"
 #include <cmath>
+#include <utility>
 using namespace std;
 
 // BinarySearchTree class
@@ -20,11 +40,16 @@ using namespace std;
 //
 // ******************PUBLIC OPERATIONS*********************
 // void insert( x )       --> Insert x
+// void emplace( k, args )--> Insert the element built from key k and args, in the node that will hold it
+// void upsert( k, m, f ) --> Insert m( ) if no element has key k, else call f( element ); m( ) only runs if needed
 // void remove( x )       --> Remove x
 // void remove( x, i)     --> If x is found in tree, it is removed and call returns true.
 // bool contains( x )     --> Return true if x is present
 // void find_and_print( x)--> Prints vector associated with x if x is present
+// find_and_print( x, out )-> same, written to stream out
 // bool find( x )         --> Returns true if x is present
+// bool find( x, i, c )   --> find( x, i ) from where Cursor c's last search ended; for keys in sorted order
+// find_Coro( x, i )     --> find( x, i ) as a coroutine for InterleavedFind( ) (C++20 only)
 // Comparable findMin( )  --> Return smallest item
 // Comparable findMax( )  --> Return largest item
 // boolean isEmpty( )     --> Return true if empty; else false
@@ -34,29 +59,50 @@ using namespace std;
 // int calculate_IPL()    --> Return Internal Path Length
 // int calculate_Avg_Depth()-> Return Average Depth of all Nodes
 // double calculate_ratio()-> Return Ratio of Avg Depth to log2n
+// bool compact_Step( n ) --> Move up to n nodes into contiguous storage (see NodeArena.h); true when all are moved
+// void compact( )        --> Move every node into contiguous storage at once
+// void enable_Filter( ) --> Build a membership filter that find( ) and find_and_print( ) consult first
+// void disable_Filter( )--> Drop the membership filter
+// double filter_Bits_Per_Key( )-> Return filter memory per stored key, in bits
+// void enable_Acronym_Index( )--> Build an index from enzyme acronym to recognition sequences
+// find_Acronym( a )     --> Return the recognition sequences of acronym a, or nullptr
+// void dump_stats( out ) --> Write per-operation latency and probe-depth statistics to out as JSON (TREE_STATS)
+// void reset_stats( )    --> Clear the statistics
 // ******************ERRORS********************************
 // Throws UnderflowException as warranted
 
 template <typename Comparable>
 class BinarySearchTree
 {
+private:
+    struct BinaryNode;
+
 public:
-    BinarySearchTree( ) : root_{ nullptr } {}
+    typedef TreeCursor<BinaryNode> Cursor;     // A finger for find( x, i, c ); see TreeCursor.h
+
+    BinarySearchTree( ) : root_{ nullptr }, filter_{ nullptr }, acronym_index_{ nullptr } {}
     
     /**
      * Copy constructor
      */
-    BinarySearchTree( const BinarySearchTree & rhs ) : root_{ nullptr }
+    BinarySearchTree( const BinarySearchTree & rhs ) : root_{ nullptr }, filter_{ nullptr }, acronym_index_{ nullptr }
     {
         root_ = clone( rhs.root_ );
+        if( rhs.filter_ != nullptr )
+            filter_ = new CuckooFilter{ *rhs.filter_ };
+        if( rhs.acronym_index_ != nullptr )
+            acronym_index_ = new EnzymeIndex{ *rhs.acronym_index_ };
     }
     
     /**
      * Move constructor
      */
-    BinarySearchTree( BinarySearchTree && rhs ) : root_{ rhs.root_ }
+    BinarySearchTree( BinarySearchTree && rhs ) : root_{ rhs.root_ }, filter_{ rhs.filter_ }, acronym_index_{ rhs.acronym_index_ },
+                                                  arena_{ std::move( rhs.arena_ ) }
     {
         rhs.root_ = nullptr;
+        rhs.filter_ = nullptr;
+        rhs.acronym_index_ = nullptr;
     }
     
     /**
@@ -65,6 +111,8 @@ public:
     ~BinarySearchTree( )
     {
         makeEmpty( );
+        delete filter_;
+        delete acronym_index_;
     }
     
     /**
@@ -83,6 +131,9 @@ public:
     BinarySearchTree & operator=( BinarySearchTree && rhs )
     {
         std::swap( root_, rhs.root_ );
+        std::swap( filter_, rhs.filter_ );
+        std::swap( acronym_index_, rhs.acronym_index_ );
+        std::swap( arena_, rhs.arena_ );
         return *this;
     }
     
@@ -123,15 +174,64 @@ public:
       * find() is called.
      */
     bool find(const std::string & x, int& recursion_calls) const {
+        OpStats::Timer timer{ stats_, OpStats::FIND, &recursion_calls };
         recursion_calls = 0;
+        if (filter_ != nullptr && !filter_->contains(x))
+            return false;   // Rejected by the filter without touching the tree; recursion_calls stays 0
         return find(x, root_, recursion_calls);
     }
+    /**
+      * find() starting from where cursor's last search ended, climbing only as far as the key needs. recursion_calls
+      * counts the nodes climbed past as well as those visited. Pre-Condition: the tree has not changed since cursor
+      * was last used on it.
+     */
+    bool find(const std::string & x, int& recursion_calls, Cursor& cursor) const {
+        OpStats::Timer timer{ stats_, OpStats::FIND, &recursion_calls };
+        recursion_calls = 0;
+        if (filter_ != nullptr && !filter_->contains(x))
+            return false;
+        return cursor.seek(root_, x, recursion_calls) != nullptr;
+    }
+
+#if defined( __cpp_impl_coroutine )
+    /**
+      * find() as a coroutine for InterleavedFind() (see CoroLookup.h). It visits the same nodes and counts
+      * recursion_calls the same way, but prefetches each node and suspends before comparing against it.
+      * Pre-Condition: x and recursion_calls outlive the returned task.
+     */
+    LookupTask find_Coro(const std::string & x, int& recursion_calls) const {
+        recursion_calls = 0;
+        if (filter_ != nullptr && !filter_->contains(x))
+            co_return false;
+        for (BinaryNode *t = root_; ; ) {
+            ++recursion_calls;
+            if (t == nullptr)
+                co_return false;
+            co_await PrefetchNode{ t };
+            if (x < t->element_.getRecSequence())
+                t = t->left_;
+            else if (t->element_.getRecSequence() < x)
+                t = t->right_;
+            else
+                co_return true;     // Match
+        }
+    }
+#endif
 
     /**
       * If x is found in the tree, object is printed. Assumes Object T has a printevector() utility. 
      */
     void find_and_print(const std::string& x) const {
-         find_and_print(x, root_);
+        find_and_print(x, std::cout);
+    }
+    /**
+      * find_and_print() written to stream out, for callers such as CachedTree that keep the output.
+     */
+    void find_and_print(const std::string& x, std::ostream& out) const {
+         if (filter_ != nullptr && !filter_->contains(x))
+             out << "Not found in this tree." << std::endl;
+         else
+             find_and_print(x, root_, out);
     }
     
     /**
@@ -161,6 +261,11 @@ public:
     void makeEmpty( )
     {
         makeEmpty( root_ );
+        arena_.clear( );
+        if( filter_ != nullptr )
+            filter_->clear( );
+        if( acronym_index_ != nullptr )
+            acronym_index_->clear( );
     }
     
     /**
@@ -168,6 +273,7 @@ public:
      */
     void insert( const Comparable & x )
     {
+        OpStats::Timer timer{ stats_, OpStats::INSERT };
         insert( x, root_ );
     }
     
@@ -176,14 +282,42 @@ public:
      */
     void insert( Comparable && x )
     {
+        OpStats::Timer timer{ stats_, OpStats::INSERT };
         insert( std::move( x ), root_ );
     }
+
+    /**
+     * Insert the element built from key x and args, whose key must be x. The tree is searched for x first, and the
+     * element is constructed inside the new node only once an empty place for it has been found. A duplicate is
+     * built as a temporary and Merge()d into the element with its key by move; no node is allocated for it.
+     */
+    template <typename... Args>
+    void emplace( const std::string & x, Args &&... args )
+    {
+        OpStats::Timer timer{ stats_, OpStats::INSERT };
+        emplace( root_, x, std::forward<Args>( args )... );
+    }
+
+    /**
+     * If no element has key x, insert the element make( ) returns, whose key must be x; otherwise call
+     * merge( element ) on the element with key x. Nothing is built for a key already in the tree.
+     * merge may only append acronyms to the element, as Merge() and Add_Acronym() do; just the appended ones are
+     * added to the acronym index.
+     */
+    template <typename Make, typename MergeFunction>
+    void upsert( const std::string & x, Make make, MergeFunction merge )
+    {
+        OpStats::Timer timer{ stats_, OpStats::INSERT };
+        upsert( x, root_, make, merge );
+    }
     
     /**
      * Remove x from the tree. Nothing is done if x is not found.
      */
     void remove( const Comparable & x )
     {
+        OpStats::Timer timer{ stats_, OpStats::REMOVE };
+        forgetKey( x.getRecSequence( ) );
         remove( x, root_ );
     }
 
@@ -193,7 +327,9 @@ public:
       * recursion calls it took to run remove().
      */
     bool remove(const std::string & x, int& recursion_calls) {
+        OpStats::Timer timer{ stats_, OpStats::REMOVE, &recursion_calls };
         recursion_calls = 0;
+        forgetKey(x);
         return remove(x, root_, recursion_calls);
     }
 
@@ -203,6 +339,20 @@ public:
     int count_Nodes() const {
         return count_Nodes(root_);
     }
+    /**
+     * Moves up to max_nodes nodes into contiguous storage, continuing the compaction the last call started, and
+     * returns true once every node has been moved. The tree may be changed between calls.
+     */
+    bool compact_Step(size_t max_nodes) {
+        return arena_.compact_Step(root_, max_nodes);
+    }
+    /**
+     * Compacts the whole tree in one go.
+     */
+    void compact() {
+        while (!arena_.compact_Step(root_, NodeArena<BinaryNode>::kChunkNodes))
+            ;
+    }
     /**
       *Returns the sum of the depth of each node in a tree
      */
@@ -225,6 +375,53 @@ public:
         int avg_depth = calculate_Avg_Depth();
         return avg_depth / log2(nodes);
     }
+    /**
+      * Builds a CuckooFilter over the keys in the tree. From then on insert() and remove() keep it current, and
+      * find() and find_and_print() answer most misses from the filter without descending the tree.
+     */
+    void enable_Filter() {
+        rebuildFilter(count_Nodes(root_));
+    }
+    /**
+      * Drops the filter; lookups go straight to the tree again.
+     */
+    void disable_Filter() {
+        delete filter_;
+        filter_ = nullptr;
+    }
+    /**
+      * Returns the filter's memory per key in the tree, in bits. Returns 0 if no filter is enabled.
+     */
+    double filter_Bits_Per_Key() const {
+        if (filter_ == nullptr || filter_->size() == 0)
+            return 0;
+        return filter_->memory_Bytes() * 8.0 / filter_->size();
+    }
+    /**
+      * Builds an EnzymeIndex from the acronyms of every element. From then on insert(), Merge() and remove() keep it
+      * current. Assumes T has a getEnzymeAcronyms() function.
+     */
+    void enable_Acronym_Index() {
+        delete acronym_index_;
+        acronym_index_ = new EnzymeIndex;
+        fillAcronymIndex(root_);
+    }
+    /**
+      * Returns the recognition sequences of the enzyme acronym, or nullptr if it is unknown or no index is enabled.
+     */
+    const std::vector<std::string> * find_Acronym(const std::string & acronym) const {
+        return acronym_index_ == nullptr ? nullptr : acronym_index_->find(acronym);
+    }
+    /**
+      * Writes the latency percentiles, throughput and probe-depth distribution of each operation as JSON.
+      * Writes { "enabled": false } unless compiled with TREE_STATS.
+     */
+    void dump_stats(std::ostream & out = std::cout) const {
+        stats_.dump(out);
+    }
+    void reset_stats() {
+        stats_.reset();
+    }
     
 private:
     struct BinaryNode
@@ -238,9 +435,17 @@ private:
         
         BinaryNode( Comparable && the_element, BinaryNode *lt, BinaryNode *rt )
         : element_{ std::move( the_element ) }, left_{ lt }, right_{ rt } { }
+
+        template <typename... Args>
+        BinaryNode( std::in_place_t, Args &&... args )
+        : element_( std::forward<Args>( args )... ), left_{ nullptr }, right_{ nullptr } { }
     };
     
     BinaryNode *root_;
+    CuckooFilter *filter_;     // Optional; nullptr unless enable_Filter() was called
+    EnzymeIndex *acronym_index_;  // Optional; nullptr unless enable_Acronym_Index() was called
+    mutable OpStats stats_;
+    NodeArena<BinaryNode> arena_;   // Holds the nodes compact() moved; nodes are freed through it
     
     /**
      * Internal method to insert into a subtree.
@@ -251,13 +456,20 @@ private:
     void insert( const Comparable & x, BinaryNode * & t )
     {
         if( t == nullptr )
+        {
             t = new BinaryNode{ x, nullptr, nullptr };
+            addToFilter( t->element_.getRecSequence( ) );
+            indexAcronyms( t->element_ );
+        }
         else if( x < t->element_ )
             insert( x, t->left_ );
         else if( t->element_ < x )
             insert( x, t->right_ );
         else
+        {
             t->element_.Merge(x);  // Duplicate; Assumes Comparable is a Sequence Map.
+            indexAcronyms( x );
+        }
     }
     
     /**
@@ -270,13 +482,69 @@ private:
     void insert( Comparable && x, BinaryNode * & t )
     {
         if( t == nullptr )
+        {
             t = new BinaryNode{ std::move( x ), nullptr, nullptr };
+            addToFilter( t->element_.getRecSequence( ) );
+            indexAcronyms( t->element_ );
+        }
         else if( x < t->element_ )
             insert( std::move( x ), t->left_ );
         else if( t->element_ < x )
             insert( std::move( x ), t->right_ );
         else
-            t->element_.Merge(x);  // Duplicate
+        {
+            indexAcronyms( x );
+            t->element_.Merge( std::move( x ) );  // Duplicate
+        }
+    }
+
+    /**
+     * Internal method for emplace(): builds the element from x and args in a new node at the empty place for key x
+     * in subtree t, or Merge()s it into the element with key x.
+     */
+    template <typename... Args>
+    void emplace( BinaryNode * & t, const std::string & x, Args &&... args )
+    {
+        if( t == nullptr )
+        {
+            t = new BinaryNode{ std::in_place, x, std::forward<Args>( args )... };
+            addToFilter( t->element_.getRecSequence( ) );
+            indexAcronyms( t->element_ );
+        }
+        else if( x < t->element_.getRecSequence( ) )
+            emplace( t->left_, x, std::forward<Args>( args )... );
+        else if( t->element_.getRecSequence( ) < x )
+            emplace( t->right_, x, std::forward<Args>( args )... );
+        else
+        {
+            Comparable duplicate( x, std::forward<Args>( args )... );
+            indexAcronyms( duplicate );
+            t->element_.Merge( std::move( duplicate ) );
+        }
+    }
+
+    /**
+     * Internal method for upsert() on subtree t.
+     */
+    template <typename Make, typename MergeFunction>
+    void upsert( const std::string & x, BinaryNode * & t, Make & make, MergeFunction & merge )
+    {
+        if( t == nullptr )
+        {
+            t = new BinaryNode{ std::in_place, make( ) };
+            addToFilter( t->element_.getRecSequence( ) );
+            indexAcronyms( t->element_ );
+        }
+        else if( x < t->element_.getRecSequence( ) )
+            upsert( x, t->left_, make, merge );
+        else if( t->element_.getRecSequence( ) < x )
+            upsert( x, t->right_, make, merge );
+        else
+        {
+            size_t indexed = t->element_.getEnzymeAcronyms( ).size( );
+            merge( t->element_ );
+            indexAcronyms( t->element_, indexed );
+        }
     }
     
     /**
@@ -302,7 +570,7 @@ private:
         {
             BinaryNode *oldNode = t;
             t = ( t->left_ != nullptr ) ? t->left_ : t->right_;
-            delete oldNode;
+            arena_.release( oldNode );
         }
     }
     /**
@@ -323,7 +591,7 @@ private:
         } else {
             BinaryNode *oldNode = t;
             t = ( t->left_ != nullptr ) ? t->left_ : t->right_;
-            delete oldNode;
+            arena_.release( oldNode );
             return true;
         }
     }
@@ -374,15 +642,15 @@ private:
       * If x is found in the tree, it's associated vector is printed. 
       * Assumes type T has a Printe_Vector() function, a vector data member, and an enzyme_acronym_ data member.
      */
-    void find_and_print(const std::string& x, BinaryNode *t) const {
+    void find_and_print(const std::string& x, BinaryNode *t, std::ostream& out) const {
         if( t == nullptr )
-            std::cout << "Not found in this tree." << std::endl;
+            out << "Not found in this tree." << std::endl;
         else if( x < t->element_.getRecSequence())
-            return find_and_print( x, t->left_ );
+            return find_and_print( x, t->left_, out );
         else if( t->element_.getRecSequence() < x )
-            return find_and_print( x, t->right_ );
+            return find_and_print( x, t->right_, out );
         else 
-            t->element_.Print_Vector();
+            t->element_.Print_Vector(out);
     }
     /**
      * Internal method to test if an item is in a subtree.
@@ -415,16 +683,90 @@ private:
      *****************************************************/
     
     /**
-     * Internal method to make subtree empty.
+     * Internal method to record a newly inserted key in the filter, if there is one. A full filter is rebuilt
+     * with twice the capacity.
      */
-    void makeEmpty( BinaryNode * & t )
+    void addToFilter( const std::string & key )
+    {
+        if( filter_ != nullptr && !filter_->insert( key ) )
+            rebuildFilter( filter_->capacity( ) * 2 );
+    }
+
+    /**
+     * Internal method to replace the filter with one sized for expected_keys that holds every key in the tree.
+     */
+    void rebuildFilter( size_t expected_keys )
+    {
+        CuckooFilter *fresh = new CuckooFilter{ expected_keys };
+        if( !fillFilter( root_, *fresh ) )
+        {
+            delete fresh;
+            rebuildFilter( expected_keys * 2 );
+            return;
+        }
+        delete filter_;
+        filter_ = fresh;
+    }
+
+    /**
+     * Internal method to insert every key of subtree t into filter. Returns false if filter overflowed.
+     */
+    bool fillFilter( BinaryNode *t, CuckooFilter & filter ) const
+    {
+        if( t == nullptr )
+            return true;
+        return filter.insert( t->element_.getRecSequence( ) ) && fillFilter( t->left_, filter ) && fillFilter( t->right_, filter );
+    }
+
+    /**
+     * Internal method to add x's acronyms to the acronym index, if there is one, skipping the first from of them.
+     */
+    void indexAcronyms( const Comparable & x, size_t from = 0 )
+    {
+        if( acronym_index_ != nullptr )
+            for( size_t i = from; i < x.getEnzymeAcronyms( ).size( ); ++i )
+                acronym_index_->add( x.getEnzymeAcronyms( )[ i ], x.getRecSequence( ) );
+    }
+
+    /**
+     * Internal method to index the acronyms of every element in subtree t.
+     */
+    void fillAcronymIndex( BinaryNode *t )
     {
         if( t != nullptr )
         {
-            makeEmpty( t->left_ );
-            makeEmpty( t->right_ );
-            delete t;
+            indexAcronyms( t->element_ );
+            fillAcronymIndex( t->left_ );
+            fillAcronymIndex( t->right_ );
         }
+    }
+
+    /**
+     * Internal method to drop key from the filter and the acronym index before its node is removed.
+     * Does nothing if key is not in the tree.
+     */
+    void forgetKey( const std::string & key )
+    {
+        if( filter_ == nullptr && acronym_index_ == nullptr )
+            return;
+        BinaryNode *t = root_;
+        while( t != nullptr && t->element_.getRecSequence( ) != key )
+            t = key < t->element_.getRecSequence( ) ? t->left_ : t->right_;
+        if( t == nullptr )
+            return;
+        if( filter_ != nullptr )
+            filter_->remove( key );
+        if( acronym_index_ != nullptr )
+            for( const std::string & acronym : t->element_.getEnzymeAcronyms( ) )
+                acronym_index_->remove( acronym, key );
+    }
+
+    /**
+     * Internal method to make subtree empty.
+     */
+    void makeEmpty( BinaryNode * & t )
+    {
+        ParallelFold<int>( t, 0, [ this ]( BinaryNode *node, int, int, int ) { arena_.discard( node ); return 0; } );
         t = nullptr;
     }
     
@@ -433,12 +775,7 @@ private:
      */
     void printTree( BinaryNode *t, ostream & out ) const
     {
-        if( t != nullptr )
-        {
-            printTree( t->left_, out );
-            out << t->element_ << " ";
-            printTree( t->right_, out );
-        }
+        ParallelInorder( t, out, [ ]( const BinaryNode *node, ostream & node_out ) { node_out << node->element_ << " "; } );
     }
     
     /**
@@ -446,28 +783,20 @@ private:
      */
     BinaryNode * clone( BinaryNode *t ) const
     {
-        if( t == nullptr )
-            return nullptr;
-        else
-            return new BinaryNode{ t->element_, clone( t->left_ ), clone( t->right_ ) };
+        return ParallelFold<BinaryNode *>( t, 0, [ ]( BinaryNode *node, int, BinaryNode *lt, BinaryNode *rt )
+            { return new BinaryNode{ node->element_, lt, rt }; } );
     }
     /**
         Internal function to count nodes.
      */
     int count_Nodes(BinaryNode *t) const {
-        if( t != nullptr ) {
-            return count_Nodes(t->left_) + count_Nodes(t->right_) + 1; 
-        } else 
-            return 0; 
+        return ParallelFold<int>(t, 0, [](BinaryNode *, int, int left_count, int right_count) { return left_count + right_count + 1; });
     }
     /**
       * Internal function to sum depth of each node in tree.
      */
     int calculate_IPL(BinaryNode *t, int depth) const  {
-        if (t == NULL)
-            return 0;
-        else 
-            return calculate_IPL(t->left_, depth+1) + calculate_IPL(t->right_, depth+1) + depth;
+        return ParallelFold<int>(t, depth, [](BinaryNode *, int node_depth, int left_ipl, int right_ipl) { return left_ipl + right_ipl + node_depth; });
     }
 };
 
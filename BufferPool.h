@@ -0,0 +1,390 @@
+/*
+ Title: BufferPool.h
+ Description: A fixed number of page-sized frames caching the pages of one file, for DiskBPlusTree. A page is
+        pinned while a Page handle refers to it and cannot be evicted then; when a page that is not resident is
+        needed, the clock hand sweeps the frames, clearing reference bits, and takes the first unpinned frame whose
+        bit was already clear, writing it back first if it is dirty. Pages that are used again before the hand comes
+        round survive a scan.
+        prefetch( ) is the read-ahead: it reads pages that are about to be needed before they are asked for, one
+        pread( ) per run of consecutive page numbers, and leaves them with their reference bit clear so that
+        read-ahead that turns out to be wasted is the first thing evicted. It never takes more than a quarter of
+        the frames at once.
+        Freed pages go on a free list threaded through the pages themselves, and are handed out again before the
+        file grows. The pool is not thread-safe; DiskBPlusTree serializes its operations.
+ Modifications:
+ */
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+// BufferPool class
+//
+// CONSTRUCTION: with an open file descriptor, the page size, the number of frames and the number of pages in use
+//
+// ******************PUBLIC OPERATIONS*********************
+// Page fetch( p )        --> Pin page p, reading it if it is not resident
+// Page allocate( )       --> Pin a new zeroed page, reused from the free list or added at the end of the file
+// void release( p )      --> Put page p on the free list
+// void prefetch( ps )    --> Read the pages ps that are not resident, coalescing consecutive page numbers
+// void flush( )          --> Write every dirty page
+// void resize( n )       --> Flush and drop every page, then use n frames
+// size_t page_Size( ), frame_Count( ), page_Count( ) --> Return the sizes; page_Count( ) includes free pages
+// uint32_t free_List( )  --> Return the first free page, or 0, for saving; set_Free_List( p ) restores it
+// Stats stats( )         --> Return the hit, miss, read, write, eviction and read-ahead counters
+// Page: data( ), id( ), mark_Dirty( ); unpins when destroyed
+// ******************ERRORS********************************
+// std::system_error if the file cannot be read or written; std::length_error if every frame is pinned
+
+class BufferPool
+{
+  public:
+    struct Stats
+    {
+        uint64_t hits = 0;                  // fetch( ) found the page resident
+        uint64_t misses = 0;                // fetch( ) had to read the page
+        uint64_t reads = 0;                 // pread( ) calls, including read-ahead
+        uint64_t pages_read = 0;            // Pages read, including read-ahead
+        uint64_t writes = 0;                // Pages written back
+        uint64_t evictions = 0;
+        uint64_t prefetched = 0;            // Pages read by prefetch( )
+        uint64_t prefetch_hits = 0;         // Prefetched pages that fetch( ) later asked for
+    };
+
+    class Page
+    {
+      public:
+        Page( ) : pool_{ nullptr }, frame_{ 0 }
+          { }
+
+        Page( Page && rhs ) : pool_{ rhs.pool_ }, frame_{ rhs.frame_ }
+        {
+            rhs.pool_ = nullptr;
+        }
+
+        Page & operator=( Page && rhs )
+        {
+            std::swap( pool_, rhs.pool_ );
+            std::swap( frame_, rhs.frame_ );
+            return *this;
+        }
+
+        Page( const Page & rhs ) = delete;
+        Page & operator=( const Page & rhs ) = delete;
+
+        ~Page( )
+        {
+            if( pool_ != nullptr )
+                --pool_->frames_[ frame_ ].pins_;
+        }
+
+        char * data( ) const
+        {
+            return pool_->frame_Data( frame_ );
+        }
+
+        uint32_t id( ) const
+        {
+            return pool_->frames_[ frame_ ].page_;
+        }
+
+        void mark_Dirty( ) const
+        {
+            pool_->frames_[ frame_ ].dirty_ = true;
+        }
+
+      private:
+        friend class BufferPool;
+        BufferPool *pool_;
+        size_t frame_;
+
+        Page( BufferPool *pool, size_t frame ) : pool_{ pool }, frame_{ frame }
+        {
+            ++pool_->frames_[ frame_ ].pins_;
+        }
+    };
+
+    BufferPool( int fd, size_t page_size, size_t frame_count, uint32_t page_count )
+      : fd_{ fd }, page_size_{ page_size }, page_count_{ page_count }, free_list_{ 0 }
+    {
+        resize( frame_count );
+    }
+
+    BufferPool( const BufferPool & rhs ) = delete;
+    BufferPool & operator=( const BufferPool & rhs ) = delete;
+
+    ~BufferPool( )
+    {
+        try
+        {
+            flush( );
+        }
+        catch( const std::system_error & )
+        {
+        }
+    }
+
+    Page fetch( uint32_t page )
+    {
+        auto found = resident_.find( page );
+        if( found != resident_.end( ) )
+        {
+            Frame & frame = frames_[ found->second ];
+            ++stats_.hits;
+            if( frame.prefetched_ )
+            {
+                ++stats_.prefetch_hits;
+                frame.prefetched_ = false;
+            }
+            frame.referenced_ = true;
+            return Page{ this, found->second };
+        }
+        ++stats_.misses;
+        size_t slot = victim( );
+        readPages( page, 1, frame_Data( slot ) );
+        install( slot, page, true );
+        return Page{ this, slot };
+    }
+
+    /**
+      * Returns a pinned, zeroed, dirty page that belongs to no one: the head of the free list, or a new page at the
+      * end of the file.
+     */
+    Page allocate( )
+    {
+        uint32_t page;
+        if( free_list_ != 0 )
+        {
+            page = free_list_;
+            Page head = fetch( page );
+            std::memcpy( &free_list_, head.data( ), sizeof( free_list_ ) );
+        }
+        else
+            page = page_count_++;
+        auto found = resident_.find( page );
+        size_t slot = found != resident_.end( ) ? found->second : victim( );
+        if( found == resident_.end( ) )
+            install( slot, page, true );
+        std::memset( frame_Data( slot ), 0, page_size_ );
+        frames_[ slot ].dirty_ = true;
+        return Page{ this, slot };
+    }
+
+    /**
+      * Puts page on the free list. Pre-Condition: nothing refers to page any more.
+     */
+    void release( uint32_t page )
+    {
+        Page freed = fetch( page );
+        std::memcpy( freed.data( ), &free_list_, sizeof( free_list_ ) );
+        freed.mark_Dirty( );
+        free_list_ = page;
+    }
+
+    /**
+      * Reads those of pages that are not resident into unpinned frames, in runs of consecutive page numbers. Stops
+      * early rather than use more than a quarter of the frames.
+     */
+    void prefetch( std::vector<uint32_t> pages )
+    {
+        std::sort( pages.begin( ), pages.end( ) );
+        pages.erase( std::unique( pages.begin( ), pages.end( ) ), pages.end( ) );
+        pages.erase( std::remove_if( pages.begin( ), pages.end( ), [ this ]( uint32_t page )
+            { return resident_.count( page ) > 0 || page >= page_count_; } ), pages.end( ) );
+        if( pages.size( ) > frames_.size( ) / 4 )
+            pages.resize( frames_.size( ) / 4 );
+        for( size_t first = 0; first < pages.size( ); )
+        {
+            size_t last = first + 1;
+            while( last < pages.size( ) && pages[ last ] == pages[ last - 1 ] + 1 )
+                ++last;
+            scratch_.resize( ( last - first ) * page_size_ );
+            readPages( pages[ first ], last - first, &scratch_[ 0 ] );
+            for( size_t i = first; i < last; ++i )
+            {
+                size_t slot = victim( );
+                std::memcpy( frame_Data( slot ), &scratch_[ ( i - first ) * page_size_ ], page_size_ );
+                install( slot, pages[ i ], false );
+                frames_[ slot ].prefetched_ = true;
+                ++stats_.prefetched;
+            }
+            first = last;
+        }
+    }
+
+    void flush( )
+    {
+        for( size_t slot = 0; slot < frames_.size( ); ++slot )
+            if( frames_[ slot ].dirty_ )
+                writeBack( slot );
+    }
+
+    /**
+      * Writes every dirty page back and empties the pool, then uses frame_count frames (at least kMinFrames).
+      * Pre-Condition: no page is pinned.
+     */
+    void resize( size_t frame_count )
+    {
+        if( !frames_.empty( ) )
+            flush( );
+        frame_count = std::max( frame_count, size_t( kMinFrames ) );
+        frames_.assign( frame_count, Frame{ } );
+        memory_.reset( new char[ frame_count * page_size_ ] );
+        resident_.clear( );
+        resident_.reserve( frame_count );
+        hand_ = 0;
+    }
+
+    size_t page_Size( ) const
+    {
+        return page_size_;
+    }
+
+    size_t frame_Count( ) const
+    {
+        return frames_.size( );
+    }
+
+    uint32_t page_Count( ) const
+    {
+        return page_count_;
+    }
+
+    uint32_t free_List( ) const
+    {
+        return free_list_;
+    }
+
+    void set_Free_List( uint32_t page )
+    {
+        free_list_ = page;
+    }
+
+    const Stats & stats( ) const
+    {
+        return stats_;
+    }
+
+    void reset_Stats( )
+    {
+        stats_ = Stats{ };
+    }
+
+    static const size_t kMinFrames = 16;    // Enough for the pages one tree operation pins at once
+
+  private:
+    static const uint32_t kNoPage = 0xffffffff;
+
+    struct Frame
+    {
+        uint32_t page_ = kNoPage;
+        int pins_ = 0;
+        bool referenced_ = false;
+        bool dirty_ = false;
+        bool prefetched_ = false;       // Read by prefetch( ) and not asked for since
+    };
+
+    int fd_;
+    size_t page_size_;
+    uint32_t page_count_;
+    uint32_t free_list_;
+    std::vector<Frame> frames_;
+    std::unique_ptr<char[]> memory_;                    // frames_.size( ) pages, one per frame
+    std::unordered_map<uint32_t, size_t> resident_;     // Page number to frame
+    size_t hand_ = 0;
+    std::vector<char> scratch_;                         // Buffer for a run of prefetched pages
+    Stats stats_;
+
+    char * frame_Data( size_t slot ) const
+    {
+        return memory_.get( ) + slot * page_size_;
+    }
+
+    /**
+     * Internal method to find a frame for a new page with the clock algorithm, writing back and dropping the page
+     * it held. Empty frames are taken first.
+     */
+    size_t victim( )
+    {
+        for( size_t swept = 0; swept < 2 * frames_.size( ) + 1; ++swept )
+        {
+            size_t slot = hand_;
+            hand_ = ( hand_ + 1 ) % frames_.size( );
+            Frame & frame = frames_[ slot ];
+            if( frame.pins_ > 0 )
+                continue;
+            if( frame.referenced_ )
+            {
+                frame.referenced_ = false;
+                continue;
+            }
+            if( frame.page_ != kNoPage )
+            {
+                if( frame.dirty_ )
+                    writeBack( slot );
+                resident_.erase( frame.page_ );
+                ++stats_.evictions;
+            }
+            frame = Frame{ };
+            return slot;
+        }
+        throw std::length_error{ "BufferPool: every frame is pinned" };
+    }
+
+    void install( size_t slot, uint32_t page, bool referenced )
+    {
+        frames_[ slot ].page_ = page;
+        frames_[ slot ].referenced_ = referenced;
+        resident_[ page ] = slot;
+    }
+
+    void writeBack( size_t slot )
+    {
+        off_t offset = off_t( frames_[ slot ].page_ ) * page_size_;
+        for( size_t done = 0; done < page_size_; )
+        {
+            ssize_t written = pwrite( fd_, frame_Data( slot ) + done, page_size_ - done, offset + done );
+            if( written < 0 && errno != EINTR )
+                throw std::system_error{ errno, std::generic_category( ), "BufferPool: cannot write page" };
+            done += written < 0 ? 0 : written;
+        }
+        frames_[ slot ].dirty_ = false;
+        ++stats_.writes;
+    }
+
+    /**
+     * Internal method to read count pages starting at page into buffer. Pages past the end of the file read as
+     * zeroes, since a page may be allocated and evicted clean before it is ever written.
+     */
+    void readPages( uint32_t page, size_t count, char *buffer )
+    {
+        size_t bytes = count * page_size_, done = 0;
+        off_t offset = off_t( page ) * page_size_;
+        while( done < bytes )
+        {
+            ssize_t got = pread( fd_, buffer + done, bytes - done, offset + done );
+            if( got < 0 && errno == EINTR )
+                continue;
+            if( got < 0 )
+                throw std::system_error{ errno, std::generic_category( ), "BufferPool: cannot read page" };
+            if( got == 0 )
+                break;
+            done += got;
+        }
+        std::memset( buffer + done, 0, bytes - done );
+        ++stats_.reads;
+        stats_.pages_read += count;
+    }
+};
+
+#endif
@@ -0,0 +1,297 @@
+/*
+ Title: BufferedAvlTree.h
+ Description: An AvlTree with a write buffer in front of it, as in a log-structured merge tree. insert() only adds
+        the element to a small in-memory buffer, Merge()ing it into the buffered element with the same key if there
+        is one. When the buffer holds capacity keys it is sorted and handed to AvlTree::merge_Batch(), which inserts
+        the whole batch in one descent that skips the subtrees gaining nothing, instead of one root-to-leaf descent
+        and rebalance per element.
+        Reads look in both places and answer exactly as an AvlTree that was given every insert() directly: a key in
+        both holds the tree's acronyms followed by the buffer's, the order Merge() would have left them in. The
+        buffer is a HashTable, so insert() and point lookups pay one hash probe on top of the tree, while
+        print_Between() scans the whole buffer and slows down in proportion to its capacity.
+ Modifications:
+    10.19.2026: Added enable_Filter(), disable_Filter() and filter_Bits_Per_Key(), for the tree behind the buffer.
+ */
+#ifndef BUFFERED_AVL_TREE_H
+#define BUFFERED_AVL_TREE_H
+
+#include "AvlTree.h"
+#include "HashTable.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// BufferedAvlTree class
+//
+// CONSTRUCTION: with the number of keys the write buffer holds before it is merged into the tree
+//
+// ******************PUBLIC OPERATIONS*********************
+// void insert( x )       --> Buffer x, merging the buffer into the tree once it is full
+// void flush( )          --> Merge the buffer into the tree now
+// bool remove( x, i )    --> Remove x from the buffer and the tree; i is the tree's number of recursion calls
+// bool remove_Acronym( x, a )--> Remove acronym a from x's element, as in AvlTree
+// bool find( x, i )      --> Return true if x is present; i is the tree's number of recursion calls, 0 if x is
+//                            found in the buffer
+// void find_and_print( x )--> Prints vector associated with x if x is present
+// find_and_print( x, out )-> same, written to stream out
+// print_Between( k1, k2 )--> prints all elements with keys between k1 and k2
+// print_Between( k1, k2, out )--> same, written to stream out
+// boolean isEmpty( )     --> Return true if empty; else false
+// void makeEmpty( )      --> Remove all items
+// int count_Nodes( )     --> Return number of elements, buffered or not
+// int heightOfTree( ), calculate_IPL( ), calculate_Avg_Depth( ); double calculate_ratio( )
+//                        --> As in AvlTree, after flush( )ing so every element is counted
+// void set_Buffer_Capacity( n )--> Flush, then buffer up to n keys
+// size_t buffer_Capacity( ), buffered_Count( ) --> Return the buffer's capacity and the keys in it now
+// long merge_Count( )    --> Return number of times the buffer was merged into the tree
+// void enable_Filter( ), disable_Filter( ); double filter_Bits_Per_Key( ) --> As in AvlTree, for the tree
+// void dump_stats( out ), reset_stats( ) --> As in AvlTree, for the tree
+// ******************ERRORS********************************
+// None
+
+template <typename Comparable>
+class BufferedAvlTree
+{
+  public:
+    static const size_t kDefaultCapacity = 4096;
+
+    explicit BufferedAvlTree( size_t capacity = kDefaultCapacity ) : capacity_{ 0 }, merges_{ 0 }
+    {
+        set_Buffer_Capacity( capacity );
+    }
+
+    BufferedAvlTree( const BufferedAvlTree & rhs ) = delete;
+    BufferedAvlTree & operator=( const BufferedAvlTree & rhs ) = delete;
+
+    void insert( const Comparable & x )
+    {
+        buffer_.insert( x );
+        if( size_t( buffer_.count_Nodes( ) ) >= capacity_ )
+            flush( );
+    }
+
+    void insert( Comparable && x )
+    {
+        buffer_.insert( std::move( x ) );
+        if( size_t( buffer_.count_Nodes( ) ) >= capacity_ )
+            flush( );
+    }
+
+    void flush( )
+    {
+        if( buffer_.isEmpty( ) )
+            return;
+        buffer_.drain( batch_ );
+        std::sort( batch_.begin( ), batch_.end( ) );
+        tree_.merge_Batch( batch_ );
+        batch_.clear( );
+        ++merges_;
+    }
+
+    bool remove( const std::string & x, int & recursion_calls )
+    {
+        int probes = 0;
+        bool buffered = buffer_.remove( x, probes );
+        bool stored = tree_.remove( x, recursion_calls );
+        return buffered || stored;
+    }
+
+    /**
+      * Moves x's buffered element, if any, into the tree first, so the acronym removed is the first one in the
+      * combined list, as it would be in a plain AvlTree.
+     */
+    bool remove_Acronym( const std::string & x, const std::string & acronym )
+    {
+        const Comparable *buffered = buffer_.find_Element( x );
+        if( buffered != nullptr )
+        {
+            int probes = 0;
+            tree_.insert( *buffered );
+            buffer_.remove( x, probes );
+        }
+        return tree_.remove_Acronym( x, acronym );
+    }
+
+    bool find( const std::string & x, int & recursion_calls ) const
+    {
+        if( buffer_.find_Element( x ) != nullptr )
+        {
+            recursion_calls = 0;
+            return true;
+        }
+        return tree_.find( x, recursion_calls );
+    }
+
+    void find_and_print( const std::string & x ) const
+    {
+        find_and_print( x, std::cout );
+    }
+
+    void find_and_print( const std::string & x, std::ostream & out ) const
+    {
+        const Comparable *buffered = buffer_.find_Element( x );
+        if( buffered == nullptr )
+            tree_.find_and_print( x, out );
+        else
+            combined( tree_.find_Element( x ), *buffered ).Print_Vector( out );
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2 ) const
+    {
+        print_Between( str1, str2, std::cout );
+    }
+
+    /**
+      * Writes the elements with keys strictly between str1 and str2 to out, merging the buffered ones in range,
+      * sorted, with the tree's as they are visited.
+     */
+    void print_Between( const std::string & str1, const std::string & str2, std::ostream & out ) const
+    {
+        std::vector<const Comparable *> in_range;
+        buffer_.for_Each( [ & ]( const Comparable & x )
+        {
+            if( str1 < x.getRecSequence( ) && x.getRecSequence( ) < str2 )
+                in_range.push_back( &x );
+        } );
+        std::sort( in_range.begin( ), in_range.end( ), [ ]( const Comparable *lhs, const Comparable *rhs )
+            { return *lhs < *rhs; } );
+        size_t next = 0;
+        tree_.for_Each_Between( str1, str2, [ & ]( const Comparable & stored )
+        {
+            while( next < in_range.size( ) && *in_range[ next ] < stored )
+                out << *in_range[ next++ ] << " ";
+            if( next < in_range.size( ) && !( stored < *in_range[ next ] ) )
+                out << combined( &stored, *in_range[ next++ ] ) << " ";
+            else
+                out << stored << " ";
+        } );
+        while( next < in_range.size( ) )
+            out << *in_range[ next++ ] << " ";
+    }
+
+    bool isEmpty( ) const
+    {
+        return buffer_.isEmpty( ) && tree_.isEmpty( );
+    }
+
+    void makeEmpty( )
+    {
+        buffer_.makeEmpty( );
+        tree_.makeEmpty( );
+    }
+
+    /**
+      * Counts the tree's nodes and the buffered keys the tree does not hold yet.
+     */
+    int count_Nodes( ) const
+    {
+        int count = tree_.count_Nodes( );
+        buffer_.for_Each( [ & ]( const Comparable & x )
+        {
+            if( tree_.find_Element( x.getRecSequence( ) ) == nullptr )
+                ++count;
+        } );
+        return count;
+    }
+
+    int heightOfTree( )
+    {
+        flush( );
+        return tree_.heightOfTree( );
+    }
+
+    int calculate_IPL( )
+    {
+        flush( );
+        return tree_.calculate_IPL( );
+    }
+
+    int calculate_Avg_Depth( )
+    {
+        flush( );
+        return tree_.calculate_Avg_Depth( );
+    }
+
+    double calculate_ratio( )
+    {
+        flush( );
+        return tree_.calculate_ratio( );
+    }
+
+    /**
+      * Merges what is buffered, then buffers up to capacity keys (at least 1) from now on. Room for them is set
+      * aside at once, so the buffer never rehashes while it fills.
+     */
+    void set_Buffer_Capacity( size_t capacity )
+    {
+        flush( );
+        capacity_ = std::max( capacity, size_t( 1 ) );
+        buffer_ = HashTable<Comparable>{ };
+        buffer_.reserve( capacity_ );
+        batch_ = std::vector<Comparable>{ };
+        batch_.reserve( capacity_ );
+    }
+
+    size_t buffer_Capacity( ) const
+    {
+        return capacity_;
+    }
+
+    size_t buffered_Count( ) const
+    {
+        return buffer_.count_Nodes( );
+    }
+
+    long merge_Count( ) const
+    {
+        return merges_;
+    }
+
+    void enable_Filter( )
+    {
+        tree_.enable_Filter( );
+    }
+
+    void disable_Filter( )
+    {
+        tree_.disable_Filter( );
+    }
+
+    double filter_Bits_Per_Key( ) const
+    {
+        return tree_.filter_Bits_Per_Key( );
+    }
+
+    void dump_stats( std::ostream & out = std::cout ) const
+    {
+        tree_.dump_stats( out );
+    }
+
+    void reset_stats( )
+    {
+        tree_.reset_stats( );
+    }
+
+  private:
+    AvlTree<Comparable> tree_;
+    HashTable<Comparable> buffer_;
+    std::vector<Comparable> batch_;     // The buffer's elements while they are sorted and merged; kept for reuse
+    size_t capacity_;
+    long merges_;
+
+    /**
+     * Internal method to return the element a plain AvlTree would hold for a key whose element in the tree is
+     * stored, or nullptr, and whose buffered element is buffered.
+     */
+    static Comparable combined( const Comparable *stored, const Comparable & buffered )
+    {
+        if( stored == nullptr )
+            return buffered;
+        Comparable both = *stored;
+        both.Merge( buffered );
+        return both;
+    }
+};
+
+#endif
@@ -0,0 +1,221 @@
+/*
+ Title: CoroLookup.h
+ Description: Coroutine lookups that hide memory latency by interleaving. A tree's find_Coro( x, recursion_calls )
+        walks the same path as find( x, recursion_calls ) and counts probes the same way, but before touching each
+        node it prefetches it and suspends. InterleavedFind() keeps a group of G such lookups in flight and resumes
+        them round-robin, so while one lookup waits for its node to arrive from memory the others make progress.
+        This only pays off when the tree does not fit in cache; G is the number of misses kept outstanding.
+        Everything here needs C++20 coroutines and is compiled out otherwise.
+ Modifications:
+ */
+#ifndef CORO_LOOKUP_H
+#define CORO_LOOKUP_H
+
+#if defined( __cpp_impl_coroutine )
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+// LookupTask class
+//
+// CONSTRUCTION: returned by a coroutine such as find_Coro( ); starts suspended
+//
+// ******************PUBLIC OPERATIONS*********************
+// bool done( )           --> Return true once the lookup has finished, or if there is no lookup
+// void resume( )         --> Run the lookup until its next suspension or its end
+// bool result( )         --> Return the lookup's answer; valid once done( )
+// ******************ERRORS********************************
+// None
+
+class LookupTask
+{
+  public:
+    struct promise_type
+    {
+        bool result_ = false;
+
+        LookupTask get_return_object( )
+        {
+            return LookupTask{ std::coroutine_handle<promise_type>::from_promise( *this ) };
+        }
+        std::suspend_always initial_suspend( ) noexcept
+        {
+            return { };
+        }
+        std::suspend_always final_suspend( ) noexcept
+        {
+            return { };
+        }
+        void return_value( bool found )
+        {
+            result_ = found;
+        }
+        void unhandled_exception( )
+        {
+            std::terminate( );
+        }
+
+        // Frames are recycled through a per-thread free list, so a lookup does not cost a heap allocation.
+        static void * operator new( std::size_t size )
+        {
+            if( size > kFrameBytes )
+                return ::operator new( size );
+            FreeFrame *& head = frames( ).head_;
+            if( head == nullptr )
+                return ::operator new( kFrameBytes );
+            FreeFrame *frame = head;
+            head = frame->next_;
+            return frame;
+        }
+        static void operator delete( void *frame, std::size_t size )
+        {
+            if( size > kFrameBytes )
+            {
+                ::operator delete( frame );
+                return;
+            }
+            FreeFrame *& head = frames( ).head_;
+            head = new( frame ) FreeFrame{ head };
+        }
+    };
+
+    LookupTask( ) : handle_{ nullptr }
+      { }
+
+    LookupTask( LookupTask && rhs ) noexcept : handle_{ std::exchange( rhs.handle_, nullptr ) }
+      { }
+
+    LookupTask & operator=( LookupTask && rhs ) noexcept
+    {
+        std::swap( handle_, rhs.handle_ );
+        return *this;
+    }
+
+    LookupTask( const LookupTask & rhs ) = delete;
+    LookupTask & operator=( const LookupTask & rhs ) = delete;
+
+    ~LookupTask( )
+    {
+        if( handle_ )
+            handle_.destroy( );
+    }
+
+    bool done( ) const
+    {
+        return !handle_ || handle_.done( );
+    }
+
+    void resume( )
+    {
+        handle_.resume( );
+    }
+
+    bool result( ) const
+    {
+        return handle_.promise( ).result_;
+    }
+
+  private:
+    static const std::size_t kFrameBytes = 256;
+
+    struct FreeFrame
+    {
+        FreeFrame *next_;
+    };
+
+    struct FramePool
+    {
+        FreeFrame *head_ = nullptr;
+
+        ~FramePool( )
+        {
+            while( head_ != nullptr )
+                ::operator delete( std::exchange( head_, head_->next_ ) );
+        }
+    };
+
+    static FramePool & frames( )
+    {
+        static thread_local FramePool pool;
+        return pool;
+    }
+
+    explicit LookupTask( std::coroutine_handle<promise_type> handle ) : handle_{ handle }
+      { }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+  * co_await PrefetchNode{ p } starts loading the cache line at p and suspends, so the scheduler can run other
+  * lookups while it arrives.
+ */
+struct PrefetchNode
+{
+    const void *address_;
+
+    bool await_ready( ) const noexcept
+    {
+        return false;
+    }
+    void await_suspend( std::coroutine_handle<> ) const noexcept
+    {
+        __builtin_prefetch( address_ );
+    }
+    void await_resume( ) const noexcept
+    { }
+};
+
+/**
+  * Looks up every key of keys in a_tree with find_Coro(), keeping group_size lookups in flight and resuming them
+  * round-robin. Calls on_result( i, found, recursion_calls ) once for each keys[ i ]; the calls may come out of order.
+  * With group_size 1 this is a plain sequential lookup loop plus the coroutine overhead.
+ */
+template <typename TreeType, typename OnResult>
+void InterleavedFind( const TreeType & a_tree, const std::vector<std::string> & keys, size_t group_size,
+                      OnResult on_result )
+{
+    struct Slot
+    {
+        LookupTask task_;
+        size_t key_ = 0;
+        int recursion_calls_ = 0;
+    };
+    std::vector<Slot> slots( group_size < 1 ? 1 : group_size );
+    size_t next = 0, in_flight = 0;
+    for( Slot & slot : slots )
+        if( next < keys.size( ) )
+        {
+            slot.key_ = next;
+            slot.task_ = a_tree.find_Coro( keys[ next++ ], slot.recursion_calls_ );
+            ++in_flight;
+        }
+    while( in_flight > 0 )
+        for( Slot & slot : slots )
+        {
+            if( in_flight == 0 )
+                break;
+            if( slot.task_.done( ) )
+                continue;               // Finished and no keys left to start
+            slot.task_.resume( );
+            if( !slot.task_.done( ) )
+                continue;
+            on_result( slot.key_, slot.task_.result( ), slot.recursion_calls_ );
+            if( next < keys.size( ) )
+            {
+                slot.key_ = next;
+                slot.task_ = a_tree.find_Coro( keys[ next++ ], slot.recursion_calls_ );
+            }
+            else
+                --in_flight;
+        }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,187 @@
+/*
+ Title: CuckooFilter.h
+ Description: A cuckoo filter answers "is this key possibly present?" for strings. Each key is stored as a 16 bit
+        fingerprint in one of two candidate buckets of four slots. A negative answer is always correct; a positive
+        answer is wrong with probability about 8 / 2^16. Unlike a Bloom filter, keys can be removed again, which lets
+        a tree keep its filter current on remove().
+ Modifications:
+ */
+#ifndef CUCKOO_FILTER_H
+#define CUCKOO_FILTER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// CuckooFilter class
+//
+// CONSTRUCTION: with the number of keys the filter should be sized for
+//
+// ******************PUBLIC OPERATIONS*********************
+// bool insert( x )       --> Add x; returns false if the filter is full and must be rebuilt larger
+// bool contains( x )     --> Return false if x is definitely absent, true if x may be present
+// bool remove( x )       --> Remove one copy of x's fingerprint; x must have been inserted
+// void clear( )          --> Remove all keys
+// size_t size( )         --> Return number of keys stored
+// size_t capacity( )     --> Return number of fingerprint slots
+// size_t memory_Bytes( ) --> Return bytes used by the fingerprint table
+// ******************ERRORS********************************
+// None
+
+class CuckooFilter
+{
+  public:
+    explicit CuckooFilter( size_t expected_keys = 0 ) : num_buckets_{ 1 }, size_{ 0 }, kick_state_{ 0x9E3779B9u }
+    {
+        while( num_buckets_ * kSlotsPerBucket * 9 < expected_keys * 10 )  // Stay under 90% occupancy
+            num_buckets_ *= 2;
+        table_.assign( num_buckets_ * kSlotsPerBucket, 0 );
+    }
+
+    /**
+      * Adds key to the filter.
+      * Post-Condition: Returns true on success. Returns false if no slot could be freed by relocating
+      *     fingerprints; the filter then no longer answers correctly and must be rebuilt with a larger capacity.
+     */
+    bool insert( const std::string & key )
+    {
+        size_t hash = std::hash<std::string>{ }( key );
+        uint16_t fp = fingerprint( hash );
+        size_t i1 = hash & ( num_buckets_ - 1 );
+        size_t i2 = altIndex( i1, fp );
+        if( placeInBucket( i1, fp ) || placeInBucket( i2, fp ) )
+        {
+            ++size_;
+            return true;
+        }
+
+        size_t index = nextRandom( ) & 1 ? i1 : i2;
+        for( int kick = 0; kick < kMaxKicks; ++kick )
+        {
+            size_t slot = index * kSlotsPerBucket + nextRandom( ) % kSlotsPerBucket;
+            std::swap( fp, table_[ slot ] );                // Evict a resident and take its place
+            index = altIndex( index, fp );                  // The evicted fingerprint moves to its other bucket
+            if( placeInBucket( index, fp ) )
+            {
+                ++size_;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+      * Returns false if key was never inserted (or has been removed). May return true for absent keys.
+     */
+    bool contains( const std::string & key ) const
+    {
+        size_t hash = std::hash<std::string>{ }( key );
+        uint16_t fp = fingerprint( hash );
+        size_t i1 = hash & ( num_buckets_ - 1 );
+        return bucketHas( i1, fp ) || bucketHas( altIndex( i1, fp ), fp );
+    }
+
+    /**
+      * Removes one copy of key's fingerprint.
+      * Pre-Condition: key was inserted. Removing a key that was never inserted may remove another key's
+      *     fingerprint and cause false negatives.
+      * Post-Condition: Returns true if a fingerprint was removed.
+     */
+    bool remove( const std::string & key )
+    {
+        size_t hash = std::hash<std::string>{ }( key );
+        uint16_t fp = fingerprint( hash );
+        size_t i1 = hash & ( num_buckets_ - 1 );
+        if( eraseFromBucket( i1, fp ) || eraseFromBucket( altIndex( i1, fp ), fp ) )
+        {
+            --size_;
+            return true;
+        }
+        return false;
+    }
+
+    void clear( )
+    {
+        table_.assign( table_.size( ), 0 );
+        size_ = 0;
+    }
+
+    size_t size( ) const
+    {
+        return size_;
+    }
+
+    size_t capacity( ) const
+    {
+        return table_.size( );
+    }
+
+    size_t memory_Bytes( ) const
+    {
+        return table_.size( ) * sizeof( uint16_t );
+    }
+
+  private:
+    static const size_t kSlotsPerBucket = 4;
+    static const int kMaxKicks = 500;
+
+    std::vector<uint16_t> table_;   // num_buckets_ * kSlotsPerBucket fingerprints; 0 marks an empty slot
+    size_t num_buckets_;            // Always a power of two
+    size_t size_;
+    uint32_t kick_state_;           // xorshift state for choosing eviction victims
+
+    static uint16_t fingerprint( size_t hash )
+    {
+        uint16_t fp = static_cast<uint16_t>( hash >> ( sizeof( size_t ) * 8 - 16 ) );
+        return fp == 0 ? 1 : fp;
+    }
+
+    /**
+     * The other bucket of a fingerprint. Applying it twice gives back the original bucket.
+     */
+    size_t altIndex( size_t index, uint16_t fp ) const
+    {
+        return ( index ^ ( fp * 0x5bd1e995u ) ) & ( num_buckets_ - 1 );
+    }
+
+    bool placeInBucket( size_t index, uint16_t fp )
+    {
+        for( size_t i = index * kSlotsPerBucket; i < ( index + 1 ) * kSlotsPerBucket; ++i )
+            if( table_[ i ] == 0 )
+            {
+                table_[ i ] = fp;
+                return true;
+            }
+        return false;
+    }
+
+    bool bucketHas( size_t index, uint16_t fp ) const
+    {
+        for( size_t i = index * kSlotsPerBucket; i < ( index + 1 ) * kSlotsPerBucket; ++i )
+            if( table_[ i ] == fp )
+                return true;
+        return false;
+    }
+
+    bool eraseFromBucket( size_t index, uint16_t fp )
+    {
+        for( size_t i = index * kSlotsPerBucket; i < ( index + 1 ) * kSlotsPerBucket; ++i )
+            if( table_[ i ] == fp )
+            {
+                table_[ i ] = 0;
+                return true;
+            }
+        return false;
+    }
+
+    uint32_t nextRandom( )
+    {
+        kick_state_ ^= kick_state_ << 13;
+        kick_state_ ^= kick_state_ >> 17;
+        kick_state_ ^= kick_state_ << 5;
+        return kick_state_;
+    }
+};
+
+#endif
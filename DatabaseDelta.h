@@ -0,0 +1,187 @@
+/*
+ Title: DatabaseDelta.h
+ Description: The difference between two releases of the enzyme database, as (acronym, recognition sequence) pairs
+        that were added and pairs that were removed. A delta is read either by diffing the old and new database
+        files or from a small change file, and is then applied to an existing tree with insert(), Merge() (through
+        insert() of a duplicate key) and remove_Acronym(), so updating a tree costs time proportional to the change
+        rather than to the size of the database.
+
+        A change file holds one database line per line, prefixed with '+' (the acronym now recognizes these
+        sequences) or '-' (it no longer does):
+            +EcoRI/G'AATTC//
+            -BamHI/G'GATCC/GGATCC//
+        Lines starting with any other character are ignored.
+ Modifications:
+    10.19.2026: apply( ) counts from what insert( ) and remove_Acronym( ) return instead of calling find( ) first.
+    10.19.2026: load_Diff( ) keeps a pair each time a release lists it, as FillTree( ) does, and diffs the counts.
+ */
+#ifndef DATABASE_DELTA_H
+#define DATABASE_DELTA_H
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+#include "SequenceMap.h"
+
+// DatabaseDelta class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// bool load_Diff( o, n )   --> Set the delta to the pairs that differ between database files o and n
+// bool load_Changes( f )   --> Set the delta to the '+' and '-' lines of change file f
+// apply( t )               --> Apply the delta to tree t and return what was done
+// size_t additions( )      --> Return number of pairs to add
+// size_t removals( )       --> Return number of pairs to remove
+// void clear( )            --> Make the delta empty
+// ******************ERRORS********************************
+// load_Diff( ) and load_Changes( ) return false if a file cannot be opened
+
+class DatabaseDelta
+{
+  public:
+    typedef std::pair<std::string, std::string> Pair;      // ( acronym, recognition sequence )
+
+    // What apply( ) did to the tree.
+    struct ApplyResult
+    {
+        long nodes_inserted = 0;        // New recognition sequences
+        long acronyms_merged = 0;       // Acronyms added to a sequence already in the tree
+        long acronyms_removed = 0;      // Acronyms dropped from a sequence still in the tree
+        long nodes_removed = 0;         // Sequences removed because their last acronym went
+        long not_found = 0;             // Removals naming a pair the tree did not hold
+    };
+
+    /**
+      * Reads both database files and keeps the pairs only in new_filename as additions and the pairs only in
+      * old_filename as removals. A pair listed more often in one file than in the other counts once per extra line.
+      * Pre-Condition: Both files have the 10 line header and line format FillTree() expects.
+      * Post-Condition: Returns false, leaving the delta empty, if either file cannot be opened.
+     */
+    bool load_Diff( const std::string & old_filename, const std::string & new_filename )
+    {
+        clear( );
+        std::vector<Pair> old_pairs, new_pairs;
+        if( !readDatabase( old_filename, old_pairs ) || !readDatabase( new_filename, new_pairs ) )
+            return false;
+        std::set_difference( new_pairs.begin( ), new_pairs.end( ), old_pairs.begin( ), old_pairs.end( ),
+                             std::back_inserter( added_ ) );
+        std::set_difference( old_pairs.begin( ), old_pairs.end( ), new_pairs.begin( ), new_pairs.end( ),
+                             std::back_inserter( removed_ ) );
+        return true;
+    }
+
+    /**
+      * Reads a change file (see the description above).
+      * Post-Condition: Returns false, leaving the delta empty, if the file cannot be opened.
+     */
+    bool load_Changes( const std::string & change_filename )
+    {
+        clear( );
+        std::ifstream in( change_filename );
+        if( in.fail( ) )
+            return false;
+        std::string line;
+        while( std::getline( in, line ) )
+        {
+            if( line.size( ) < 2 )
+                continue;
+            if( line[ 0 ] == '+' )
+                parseLine( line.substr( 1 ), added_ );
+            else if( line[ 0 ] == '-' )
+                parseLine( line.substr( 1 ), removed_ );
+        }
+        return true;
+    }
+
+    /**
+      * Applies the delta to a_tree: removals first, so an acronym moved between sequences ends up in one place,
+      * then additions. Assumes TreeType has a bool insert( x ) that returns false for a duplicate, and
+      * remove_Acronym( x, a, emptied ).
+     */
+    template <typename TreeType>
+    ApplyResult apply( TreeType & a_tree ) const
+    {
+        ApplyResult result;
+        for( const Pair & p : removed_ )
+        {
+            bool emptied;
+            if( !a_tree.remove_Acronym( p.second, p.first, emptied ) )
+                ++result.not_found;
+            else if( emptied )
+                ++result.nodes_removed;
+            else
+                ++result.acronyms_removed;
+        }
+        for( const Pair & p : added_ )
+        {
+            if( a_tree.insert( SequenceMap{ p.second, p.first } ) )
+                ++result.nodes_inserted;
+            else
+                ++result.acronyms_merged;
+        }
+        return result;
+    }
+
+    size_t additions( ) const
+    {
+        return added_.size( );
+    }
+
+    size_t removals( ) const
+    {
+        return removed_.size( );
+    }
+
+    void clear( )
+    {
+        added_.clear( );
+        removed_.clear( );
+    }
+
+  private:
+    std::vector<Pair> added_;
+    std::vector<Pair> removed_;
+
+    /**
+     * Internal method to read every pair of a database file into pairs, sorted, keeping repeated pairs.
+     * Returns false if the file cannot be opened.
+     */
+    static bool readDatabase( const std::string & filename, std::vector<Pair> & pairs )
+    {
+        std::ifstream in( filename );
+        if( in.fail( ) )
+            return false;
+        std::string line;
+        for( int i = 0; i < 10; ++i )                           // Skip over the header
+            std::getline( in, line );
+        while( std::getline( in, line ) )
+            parseLine( line, pairs );
+        std::sort( pairs.begin( ), pairs.end( ) );
+        return true;
+    }
+
+    /**
+     * Internal method to append one pair per recognition sequence of a line "Acronym/Seq1/.../Seqn//" to pairs.
+     */
+    static void parseLine( const std::string & line, std::vector<Pair> & pairs )
+    {
+        size_t slash = line.find( '/' );
+        if( slash == std::string::npos )
+            return;
+        std::string acronym = line.substr( 0, slash );
+        for( ;; )
+        {
+            size_t next = line.find( '/', slash + 1 );
+            if( next == std::string::npos || next == slash + 1 )    // All lines end in "//"
+                return;
+            pairs.emplace_back( acronym, line.substr( slash + 1, next - slash - 1 ) );
+            slash = next;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,1083 @@
+/*
+ Title: DiskBPlusTree.h
+ Description: A B+tree kept in fixed-size pages of a file, with the same driver interface as AvlTree, for site
+        collections larger than memory. Only the pages in the BufferPool are in memory, so the memory used is set
+        by the budget rather than by the number of elements.
+        Elements live in the leaves, in key order, and each leaf links to the next; interior pages hold separator
+        keys and child page numbers, and link to their right sibling too. A page is slotted: a header, an array of
+        2-byte cell offsets kept in key order, and the cells packed from the end of the page. Lookups binary search
+        the slot array in place; insert() and remove() unpack the one page they change, edit it and pack it again,
+        splitting it in two if it no longer fits and adding the new separator to its parent.
+        An element whose stored form would take more than a quarter of a page is kept in a chain of overflow pages,
+        and its leaf cell only refers to the chain, so every leaf has room for at least three cells.
+        remove() does not merge underfull pages: a leaf may end up empty, and range scans step over it.
+        print_Between( ) and printTree( ) read ahead: while they walk the leaves they ask the pool for the next
+        leaves named in the parent page, and stop asking past the upper key, so the reads for a scan are issued in
+        batches and runs of consecutive pages are read with one call.
+        bulk_Loader( ) builds the tree bottom-up instead of inserting one element at a time: elements are sorted
+        in memory in runs as large as the budget allows, runs are spilled to temporary files, and the runs are
+        merged into packed leaves written left to right, with each interior level built from the level below.
+        Leaves come out 90% full and in consecutive pages, so the tree is smaller than one built by insert() and
+        scans read long runs.
+        Page 0 holds the root, height, size and free list, and is written by flush( ) and the destructor, so a tree
+        kept in a named file can be opened again. Without a file name the tree lives in an unlinked temporary file
+        in TMPDIR, or /tmp.
+        Every operation holds one lock, so const operations may be called from several threads but run one at a time.
+        Comparable must provide getRecSequence( ), Merge( ), Print_Vector( out ), Encode_Payload( s ) and
+        Decode_Payload( key, data, length ), as SequenceMap does.
+ Modifications:
+ */
+#ifndef DISK_BPLUS_TREE_H
+#define DISK_BPLUS_TREE_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "BufferPool.h"
+#include "dsexceptions.h"
+
+// DiskBPlusTree class
+//
+// CONSTRUCTION: with an optional file name, memory budget in bytes and page size in bytes (4096 to 16384)
+//
+// ******************PUBLIC OPERATIONS*********************
+// void insert( x )       --> Insert x; Merge() into the existing element if x's key is present
+// void remove( x )       --> Remove x
+// bool remove( x, i )    --> If x is found in tree, it is removed and call returns true. i is the number of
+//                            pages read on the way
+// bool find( x, i )      --> Return true if x is present; i is the number of pages read on the way
+// void find_and_print( x)--> Prints vector associated with x if x is present
+// find_and_print( x, out )-> same, written to stream out
+// boolean isEmpty( )     --> Return true if empty; else false
+// void makeEmpty( )      --> Remove all items
+// void printTree( )      --> Print tree in sorted order
+// int count_Nodes( )     --> Return number of elements
+// int calculate_IPL()    --> Return the sum over elements of the number of interior pages above its leaf
+// int calculate_Avg_Depth()-> Return the number of interior pages above every leaf
+// double calculate_ratio()-> Return Ratio of Avg Depth to log2n
+// int heightOfTree( )    --> Return number of page levels; 0 if empty
+// uint32_t page_Count( ) --> Return number of pages in the file, including the root page and free pages
+// print_Between(k1, k2)  --> prints all elements with keys between k1 and k2
+// print_Between(k1, k2, out)--> same, written to stream out
+// BulkLoader bulk_Loader( ) --> Return a loader: add( x ) each element, then finish( ) builds the tree
+// void set_Memory_Budget( b ) --> Keep at most about b bytes of pages in memory
+// void set_Read_Ahead( n ) --> Let scans read up to n leaves ahead; 0 turns read-ahead off
+// void flush( )          --> Write every changed page and the root page to the file
+// pool_Stats( )          --> Return the buffer pool's counters
+// void dump_stats( out ) --> Write the buffer pool's counters and the tree's shape to out as JSON
+// void reset_stats( )    --> Clear the counters
+// ******************ERRORS********************************
+// IllegalArgumentException for a page size out of range, a file that is not a tree with this page size, or a
+// key longer than a sixteenth of a page; std::system_error if the file cannot be opened, read or written
+
+template <typename Comparable>
+class DiskBPlusTree
+{
+  public:
+    static const size_t kDefaultPageSize = 8192;
+    static const size_t kDefaultMemoryBudget = size_t{ 64 } << 20;
+    static const size_t kDefaultReadAhead = 32;
+
+    explicit DiskBPlusTree( const std::string & filename = "", size_t memory_budget = kDefaultMemoryBudget,
+                            size_t page_size = kDefaultPageSize )
+      : page_size_{ page_size }, root_{ 0 }, height_{ 0 }, count_{ 0 }, read_ahead_{ kDefaultReadAhead }
+    {
+        if( page_size < 4096 || page_size > 16384 )
+            throw IllegalArgumentException{ };
+        uint32_t page_count = 1, free_list = 0;
+        if( filename.empty( ) )
+        {
+            const char *directory = std::getenv( "TMPDIR" );
+            std::string name = std::string( directory != nullptr && *directory != '\0' ? directory : "/tmp" )
+                               + "/DiskBPlusTree-XXXXXX";
+            fd_ = mkstemp( &name[ 0 ] );
+            if( fd_ >= 0 )
+                unlink( name.c_str( ) );
+        }
+        else
+            fd_ = open( filename.c_str( ), O_RDWR | O_CREAT | O_CLOEXEC, 0644 );
+        if( fd_ < 0 )
+            throw std::system_error{ errno, std::generic_category( ), "DiskBPlusTree: cannot open " + filename };
+        struct stat status;
+        if( fstat( fd_, &status ) == 0 && status.st_size > 0 && !readMeta( page_count, free_list ) )
+        {
+            close( fd_ );
+            throw IllegalArgumentException{ };
+        }
+        pool_.reset( new BufferPool{ fd_, page_size_, memory_budget / page_size_, page_count } );
+        pool_->set_Free_List( free_list );
+    }
+
+    DiskBPlusTree( const DiskBPlusTree & rhs ) = delete;
+    DiskBPlusTree & operator=( const DiskBPlusTree & rhs ) = delete;
+
+    ~DiskBPlusTree( )
+    {
+        try
+        {
+            flush( );
+        }
+        catch( const std::system_error & )
+        {
+        }
+        pool_.reset( );
+        close( fd_ );
+    }
+
+    /**
+     * Insert x into the tree; a duplicate key is merged into the existing element.
+     */
+    void insert( const Comparable & x )
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        insertElement( x );
+    }
+
+    /**
+     * Remove x from the tree. Nothing is done if x is not found.
+     */
+    void remove( const Comparable & x )
+    {
+        int pages_read = 0;
+        remove( x.getRecSequence( ), pages_read );
+    }
+
+    /**
+      * Remove x from the tree.
+      * Post-Condition: If x is not found, returns false. recursion_calls is the number of pages read on the way to
+      * x's leaf.
+     */
+    bool remove( const std::string & x, int & recursion_calls )
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        std::vector<uint32_t> path;
+        recursion_calls = 0;
+        if( root_ == 0 )
+            return false;
+        uint32_t leaf = descend( x, path );
+        recursion_calls = height_;
+        BufferPool::Page page = pool_->fetch( leaf );
+        int slot = lowerBound( page.data( ), x );
+        if( slot == cellCount( page.data( ) ) || cellKey( page.data( ), slot ) != x )
+            return false;
+        PageImage image = unpack( page.data( ) );
+        releaseTail( image.cells_[ slot ].tail_ );
+        image.cells_.erase( image.cells_.begin( ) + slot );
+        pack( image, page.data( ) );
+        page.mark_Dirty( );
+        --count_;
+        return true;
+    }
+
+    /**
+      * Post-Condition: Returns true if x is found. recursion_calls is the number of pages read on the way to x's leaf.
+     */
+    bool find( const std::string & x, int & recursion_calls ) const
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        recursion_calls = 0;
+        if( root_ == 0 )
+            return false;
+        std::vector<uint32_t> path;
+        BufferPool::Page page = pool_->fetch( descend( x, path ) );
+        recursion_calls = height_;
+        int slot = lowerBound( page.data( ), x );
+        return slot < cellCount( page.data( ) ) && cellKey( page.data( ), slot ) == x;
+    }
+
+    /**
+      * If x is located in the tree, its associated vector is printed.
+     */
+    void find_and_print( const std::string & x ) const
+    {
+        find_and_print( x, std::cout );
+    }
+
+    void find_and_print( const std::string & x, std::ostream & out ) const
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        if( root_ != 0 )
+        {
+            std::vector<uint32_t> path;
+            BufferPool::Page page = pool_->fetch( descend( x, path ) );
+            int slot = lowerBound( page.data( ), x );
+            if( slot < cellCount( page.data( ) ) && cellKey( page.data( ), slot ) == x )
+            {
+                element( page.data( ), slot ).Print_Vector( out );
+                return;
+            }
+        }
+        out << "Not found in this tree." << std::endl;
+    }
+
+    bool isEmpty( ) const
+    {
+        return count_ == 0;
+    }
+
+    /**
+     * Drops every page and shrinks the file to its root page.
+     */
+    void makeEmpty( )
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        size_t frames = pool_->frame_Count( );
+        pool_.reset( );
+        if( ftruncate( fd_, 0 ) != 0 )
+            throw std::system_error{ errno, std::generic_category( ), "DiskBPlusTree: cannot truncate" };
+        pool_.reset( new BufferPool{ fd_, page_size_, frames, 1 } );
+        root_ = 0;
+        height_ = 0;
+        count_ = 0;
+    }
+
+    /**
+     * Print the tree contents in sorted order.
+     */
+    void printTree( ) const
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        if( count_ == 0 )
+            std::cout << "Empty tree";
+        else
+            scan( nullptr, nullptr, std::cout );
+        std::cout << std::endl;
+    }
+
+    int count_Nodes( ) const
+    {
+        return int( count_ );
+    }
+
+    int calculate_IPL( ) const
+    {
+        return int( count_ ) * calculate_Avg_Depth( );
+    }
+
+    int calculate_Avg_Depth( ) const
+    {
+        return height_ > 0 ? height_ - 1 : 0;
+    }
+
+    double calculate_ratio( ) const
+    {
+        return calculate_Avg_Depth( ) / log2( count_Nodes( ) );
+    }
+
+    int heightOfTree( ) const
+    {
+        return height_;
+    }
+
+    uint32_t page_Count( ) const
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        return pool_->page_Count( );
+    }
+
+    /**
+      * Prints all elements in tree between the value str1 and str2.
+     */
+    void print_Between( const std::string & str1, const std::string & str2 ) const
+    {
+        print_Between( str1, str2, std::cout );
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2, std::ostream & out ) const
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        if( root_ != 0 )
+            scan( &str1, &str2, out );
+    }
+
+    /**
+      * Collects elements for a bottom-up build. Elements are buffered until they fill half the memory budget, then
+      * sorted, merged by key and written to a temporary file as a run; finish( ) merges the runs and builds the
+      * tree from them. Elements with the same key are merged in the order they were added, as insert( ) would.
+      * While the loader is open the pool keeps only BufferPool::kMinFrames frames, so the two together stay within
+      * the budget. If the tree was not empty, finish( ) inserts the merged elements one at a time instead.
+     */
+    class BulkLoader
+    {
+      public:
+        explicit BulkLoader( DiskBPlusTree & tree ) : tree_( tree ), buffered_bytes_{ 0 }, finished_{ false }
+        {
+            std::lock_guard<std::mutex> guard{ tree_.lock_ };
+            budget_ = tree_.pool_->frame_Count( ) * tree_.page_size_;
+            tree_.pool_->resize( BufferPool::kMinFrames );
+        }
+
+        BulkLoader( const BulkLoader & rhs ) = delete;
+        BulkLoader & operator=( const BulkLoader & rhs ) = delete;
+
+        ~BulkLoader( )
+        {
+            for( std::FILE *run : runs_ )
+                std::fclose( run );
+            if( !finished_ )
+            {
+                std::lock_guard<std::mutex> guard{ tree_.lock_ };
+                tree_.pool_->resize( budget_ / tree_.page_size_ );
+            }
+        }
+
+        void add( const Comparable & x )
+        {
+            Record record{ x.getRecSequence( ), std::string( ) };
+            x.Encode_Payload( record.payload_ );
+            buffered_bytes_ += sizeof( Record ) + record.key_.size( ) + record.payload_.size( );
+            buffer_.push_back( std::move( record ) );
+            if( buffered_bytes_ > budget_ / 2 )
+                spill( );
+        }
+
+        /**
+          * Builds the tree from everything added, and gives the pool back its frames.
+         */
+        void finish( )
+        {
+            if( finished_ )
+                return;
+            finished_ = true;
+            sortBuffer( );
+            std::lock_guard<std::mutex> guard{ tree_.lock_ };
+            tree_.pool_->resize( budget_ / tree_.page_size_ );
+            bool build = tree_.root_ == 0;
+            std::vector<std::pair<std::string, uint32_t> > leaves;
+            LevelBuilder builder{ tree_, true, leaves };
+            merge( [ & ]( const std::string & key, const Comparable & merged )
+            {
+                if( build )
+                {
+                    std::string tail;
+                    tree_.makeTail( merged, tail );
+                    builder.add( key, tail );
+                    ++tree_.count_;
+                }
+                else
+                    tree_.insertElement( merged );
+            } );
+            if( build && builder.finish( ) )
+                tree_.buildIndex( leaves );
+        }
+
+      private:
+        struct Record
+        {
+            std::string key_;
+            std::string payload_;
+        };
+
+        DiskBPlusTree & tree_;
+        size_t budget_;
+        std::vector<Record> buffer_;
+        size_t buffered_bytes_;
+        std::vector<std::FILE *> runs_;     // Spilled runs, each sorted with one record per key
+        bool finished_;
+
+        /**
+         * Sorts the buffer by key, keeping the order in which equal keys were added, and merges equal keys.
+         */
+        void sortBuffer( )
+        {
+            std::stable_sort( buffer_.begin( ), buffer_.end( ), [ ]( const Record & a, const Record & b )
+                { return a.key_ < b.key_; } );
+            size_t kept = 0;
+            for( size_t i = 0; i < buffer_.size( ); ++i )
+                if( kept > 0 && buffer_[ kept - 1 ].key_ == buffer_[ i ].key_ )
+                    buffer_[ kept - 1 ].payload_ = mergePayloads( buffer_[ kept - 1 ], buffer_[ i ].payload_ );
+                else if( kept++ != i )
+                    buffer_[ kept - 1 ] = std::move( buffer_[ i ] );
+            buffer_.resize( kept );
+        }
+
+        static std::string mergePayloads( const Record & first, const std::string & second )
+        {
+            Comparable merged = Comparable::Decode_Payload( first.key_, first.payload_.data( ), first.payload_.size( ) );
+            merged.Merge( Comparable::Decode_Payload( first.key_, second.data( ), second.size( ) ) );
+            std::string payload;
+            merged.Encode_Payload( payload );
+            return payload;
+        }
+
+        void spill( )
+        {
+            sortBuffer( );
+            std::FILE *run = std::tmpfile( );
+            if( run == nullptr )
+                throw std::system_error{ errno, std::generic_category( ), "DiskBPlusTree: cannot create a run" };
+            runs_.push_back( run );
+            for( const Record & record : buffer_ )
+            {
+                uint32_t lengths[ 2 ] = { uint32_t( record.key_.size( ) ), uint32_t( record.payload_.size( ) ) };
+                if( std::fwrite( lengths, sizeof( lengths ), 1, run ) != 1
+                    || std::fwrite( record.key_.data( ), 1, record.key_.size( ), run ) != record.key_.size( )
+                    || std::fwrite( record.payload_.data( ), 1, record.payload_.size( ), run ) != record.payload_.size( ) )
+                    throw std::system_error{ errno, std::generic_category( ), "DiskBPlusTree: cannot write a run" };
+            }
+            std::rewind( run );
+            buffer_.clear( );
+            buffer_.shrink_to_fit( );
+            buffered_bytes_ = 0;
+        }
+
+        static bool readRecord( std::FILE *run, Record & record )
+        {
+            uint32_t lengths[ 2 ];
+            if( std::fread( lengths, sizeof( lengths ), 1, run ) != 1 )
+                return false;
+            record.key_.resize( lengths[ 0 ] );
+            record.payload_.resize( lengths[ 1 ] );
+            return std::fread( &record.key_[ 0 ], 1, lengths[ 0 ], run ) == lengths[ 0 ]
+                   && std::fread( &record.payload_[ 0 ], 1, lengths[ 1 ], run ) == lengths[ 1 ];
+        }
+
+        /**
+         * Calls emit( key, element ) once per key, in key order, with the elements of that key from every run
+         * merged in run order; the buffer counts as the last run.
+         */
+        template <typename Emit>
+        void merge( Emit emit )
+        {
+            size_t sources = runs_.size( ) + 1;
+            std::vector<Record> heads( sources );
+            size_t next_in_buffer = 0;
+            auto advance = [ & ]( size_t source ) -> bool
+            {
+                if( source < runs_.size( ) )
+                    return readRecord( runs_[ source ], heads[ source ] );
+                if( next_in_buffer == buffer_.size( ) )
+                    return false;
+                heads[ source ] = std::move( buffer_[ next_in_buffer++ ] );
+                return true;
+            };
+            // Smallest key first; equal keys in run order.
+            auto later = [ &heads ]( size_t a, size_t b )
+                { return heads[ b ].key_ < heads[ a ].key_ || ( heads[ a ].key_ == heads[ b ].key_ && b < a ); };
+            std::priority_queue<size_t, std::vector<size_t>, decltype( later )> queue( later );
+            for( size_t source = 0; source < sources; ++source )
+                if( advance( source ) )
+                    queue.push( source );
+            while( !queue.empty( ) )
+            {
+                size_t source = queue.top( );
+                queue.pop( );
+                std::string key = heads[ source ].key_;
+                Comparable merged = Comparable::Decode_Payload( key, heads[ source ].payload_.data( ),
+                                                                heads[ source ].payload_.size( ) );
+                if( advance( source ) )
+                    queue.push( source );
+                while( !queue.empty( ) && heads[ queue.top( ) ].key_ == key )
+                {
+                    source = queue.top( );
+                    queue.pop( );
+                    merged.Merge( Comparable::Decode_Payload( key, heads[ source ].payload_.data( ),
+                                                              heads[ source ].payload_.size( ) ) );
+                    if( advance( source ) )
+                        queue.push( source );
+                }
+                emit( key, merged );
+            }
+            buffer_.clear( );
+        }
+    };
+
+    BulkLoader bulk_Loader( )
+    {
+        return BulkLoader{ *this };
+    }
+
+    /**
+      * Resizes the buffer pool to memory_budget / page size frames, at least BufferPool::kMinFrames.
+     */
+    void set_Memory_Budget( size_t memory_budget )
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        pool_->resize( memory_budget / page_size_ );
+    }
+
+    void set_Read_Ahead( size_t leaves )
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        read_ahead_ = leaves;
+    }
+
+    /**
+      * Writes every changed page and the root page. Does not fsync( ).
+     */
+    void flush( )
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        pool_->flush( );
+        writeMeta( );
+    }
+
+    BufferPool::Stats pool_Stats( ) const
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        return pool_->stats( );
+    }
+
+    void dump_stats( std::ostream & out = std::cout ) const
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        const BufferPool::Stats & stats = pool_->stats( );
+        out << "{ \"page_size\": " << page_size_ << ", \"frames\": " << pool_->frame_Count( )
+            << ", \"pages\": " << pool_->page_Count( ) << ", \"height\": " << height_ << ", \"elements\": " << count_
+            << ",\n  \"pool\": { \"hits\": " << stats.hits << ", \"misses\": " << stats.misses
+            << ", \"hit_rate\": " << ( stats.hits + stats.misses > 0 ? double( stats.hits ) / ( stats.hits + stats.misses ) : 0 )
+            << ", \"reads\": " << stats.reads << ", \"pages_read\": " << stats.pages_read
+            << ", \"writes\": " << stats.writes << ", \"evictions\": " << stats.evictions
+            << ", \"prefetched\": " << stats.prefetched << ", \"prefetch_hits\": " << stats.prefetch_hits << " } }" << std::endl;
+    }
+
+    void reset_stats( )
+    {
+        std::lock_guard<std::mutex> guard{ lock_ };
+        pool_->reset_Stats( );
+    }
+
+  private:
+    // Page layout: a kHeaderSize header, then a 2-byte offset per cell in key order, free space, and the cells.
+    // A cell is a 2-byte key length, a 2-byte tail length, the key and the tail. A leaf's tail is kInline and the
+    // payload, or kOverflow, the first overflow page and the payload length; an interior cell's tail is the page
+    // number of the child holding the keys from its key up to the next cell's key.
+    static const size_t kHeaderSize = 16;
+    static const uint16_t kLeaf = 1, kInterior = 2;
+    static const char kInline = 0, kOverflow = 1;
+    static const size_t kOverflowHeader = 8;    // Next page and bytes used, before an overflow page's data
+    static const int kBulkFillPercent = 90;
+
+    struct Cell
+    {
+        std::string key_;
+        std::string tail_;
+    };
+
+    // A page unpacked for editing.
+    struct PageImage
+    {
+        uint16_t kind_;
+        uint32_t next_;             // Right sibling at the same level, or 0
+        uint32_t first_child_;      // Interior pages: child holding the keys below the first cell's key
+        std::vector<Cell> cells_;
+    };
+
+    int fd_;
+    size_t page_size_;
+    mutable std::mutex lock_;
+    mutable std::unique_ptr<BufferPool> pool_;
+    uint32_t root_;                 // 0 if the tree is empty; page 0 holds the meta data
+    int height_;
+    long count_;
+    size_t read_ahead_;
+
+    static uint16_t get16( const char *p )
+    {
+        uint16_t value;
+        std::memcpy( &value, p, sizeof( value ) );
+        return value;
+    }
+
+    static uint32_t get32( const char *p )
+    {
+        uint32_t value;
+        std::memcpy( &value, p, sizeof( value ) );
+        return value;
+    }
+
+    static void put16( char *p, uint16_t value )
+    {
+        std::memcpy( p, &value, sizeof( value ) );
+    }
+
+    static void put32( char *p, uint32_t value )
+    {
+        std::memcpy( p, &value, sizeof( value ) );
+    }
+
+    static int cellCount( const char *page )
+    {
+        return get16( page + 2 );
+    }
+
+    static const char * cell( const char *page, int slot )
+    {
+        return page + get16( page + kHeaderSize + 2 * slot );
+    }
+
+    static std::string cellKey( const char *page, int slot )
+    {
+        const char *c = cell( page, slot );
+        return std::string( c + 4, get16( c ) );
+    }
+
+    static int compareKey( const char *page, int slot, const std::string & x )
+    {
+        const char *c = cell( page, slot );
+        size_t length = get16( c );
+        int order = std::memcmp( c + 4, x.data( ), std::min( length, x.size( ) ) );
+        return order != 0 ? order : ( length < x.size( ) ? -1 : length > x.size( ) ? 1 : 0 );
+    }
+
+    /**
+     * Internal method to return the first slot whose key is not less than x.
+     */
+    static int lowerBound( const char *page, const std::string & x )
+    {
+        int low = 0, high = cellCount( page );
+        while( low < high )
+        {
+            int middle = ( low + high ) / 2;
+            if( compareKey( page, middle, x ) < 0 )
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return low;
+    }
+
+    static uint32_t childAt( const char *page, int index )
+    {
+        if( index == 0 )
+            return get32( page + 8 );
+        const char *c = cell( page, index - 1 );
+        return get32( c + 4 + get16( c ) );
+    }
+
+    /**
+     * Internal method to return the index, 0 to cellCount( ), of the child of an interior page that holds x.
+     */
+    static int childIndex( const char *page, const std::string & x )
+    {
+        int low = 0, high = cellCount( page );
+        while( low < high )     // Count the cells whose key is at most x
+        {
+            int middle = ( low + high ) / 2;
+            if( compareKey( page, middle, x ) <= 0 )
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return low;
+    }
+
+    /**
+     * Internal method to walk from the root to the leaf that holds x. The interior pages passed are appended to
+     * path, root first.
+     */
+    uint32_t descend( const std::string & x, std::vector<uint32_t> & path ) const
+    {
+        uint32_t page_number = root_;
+        for( int level = 1; level < height_; ++level )
+        {
+            path.push_back( page_number );
+            BufferPool::Page page = pool_->fetch( page_number );
+            page_number = childAt( page.data( ), childIndex( page.data( ), x ) );
+        }
+        return page_number;
+    }
+
+    static PageImage unpack( const char *page )
+    {
+        PageImage image{ get16( page ), get32( page + 4 ), get32( page + 8 ), std::vector<Cell>( cellCount( page ) ) };
+        for( int slot = 0; slot < cellCount( page ); ++slot )
+        {
+            const char *c = cell( page, slot );
+            image.cells_[ slot ].key_.assign( c + 4, get16( c ) );
+            image.cells_[ slot ].tail_.assign( c + 4 + get16( c ), get16( c + 2 ) );
+        }
+        return image;
+    }
+
+    static size_t packedSize( const PageImage & image )
+    {
+        size_t size = kHeaderSize;
+        for( const Cell & c : image.cells_ )
+            size += 2 + 4 + c.key_.size( ) + c.tail_.size( );
+        return size;
+    }
+
+    void pack( const PageImage & image, char *page ) const
+    {
+        std::memset( page, 0, kHeaderSize );
+        put16( page, image.kind_ );
+        put16( page + 2, uint16_t( image.cells_.size( ) ) );
+        put32( page + 4, image.next_ );
+        put32( page + 8, image.first_child_ );
+        size_t end = page_size_;
+        for( size_t slot = 0; slot < image.cells_.size( ); ++slot )
+        {
+            const Cell & c = image.cells_[ slot ];
+            end -= 4 + c.key_.size( ) + c.tail_.size( );
+            put16( page + kHeaderSize + 2 * slot, uint16_t( end ) );
+            put16( page + end, uint16_t( c.key_.size( ) ) );
+            put16( page + end + 2, uint16_t( c.tail_.size( ) ) );
+            std::memcpy( page + end + 4, c.key_.data( ), c.key_.size( ) );
+            std::memcpy( page + end + 4 + c.key_.size( ), c.tail_.data( ), c.tail_.size( ) );
+        }
+    }
+
+    void storeImage( uint32_t page_number, const PageImage & image ) const
+    {
+        BufferPool::Page page = pool_->fetch( page_number );
+        pack( image, page.data( ) );
+        page.mark_Dirty( );
+    }
+
+    /**
+     * Internal method to return the element in a leaf's slot, reading its overflow chain if it has one.
+     */
+    Comparable element( const char *page, int slot ) const
+    {
+        const char *c = cell( page, slot );
+        std::string key( c + 4, get16( c ) );
+        const char *tail = c + 4 + key.size( );
+        if( tail[ 0 ] == kInline )
+            return Comparable::Decode_Payload( key, tail + 1, get16( c + 2 ) - 1 );
+        std::string payload;
+        for( uint32_t next = get32( tail + 1 ); next != 0; )
+        {
+            BufferPool::Page overflow = pool_->fetch( next );
+            payload.append( overflow.data( ) + kOverflowHeader, get32( overflow.data( ) + 4 ) );
+            next = get32( overflow.data( ) );
+        }
+        return Comparable::Decode_Payload( key, payload.data( ), payload.size( ) );
+    }
+
+    /**
+     * Internal method to make the tail of x's leaf cell, writing the payload to overflow pages if the cell would
+     * take more than a quarter of a page.
+     */
+    void makeTail( const Comparable & x, std::string & tail ) const
+    {
+        tail.assign( 1, kInline );
+        x.Encode_Payload( tail );
+        if( 2 + 4 + x.getRecSequence( ).size( ) + tail.size( ) <= page_size_ / 4 )
+            return;
+        std::string payload = tail.substr( 1 );
+        size_t capacity = page_size_ - kOverflowHeader;
+        uint32_t first = 0;
+        BufferPool::Page previous;
+        for( size_t done = 0; done < payload.size( ); done += capacity )
+        {
+            BufferPool::Page page = pool_->allocate( );
+            size_t used = std::min( capacity, payload.size( ) - done );
+            put32( page.data( ) + 4, uint32_t( used ) );
+            std::memcpy( page.data( ) + kOverflowHeader, payload.data( ) + done, used );
+            if( first == 0 )
+                first = page.id( );
+            else
+                put32( previous.data( ), page.id( ) );
+            previous = std::move( page );
+        }
+        tail.assign( 1, kOverflow );
+        tail.resize( 9 );
+        put32( &tail[ 1 ], first );
+        put32( &tail[ 5 ], uint32_t( payload.size( ) ) );
+    }
+
+    /**
+     * Internal method to free the overflow chain a leaf cell's tail refers to, if any.
+     */
+    void releaseTail( const std::string & tail ) const
+    {
+        if( tail[ 0 ] != kOverflow )
+            return;
+        for( uint32_t next = get32( &tail[ 1 ] ); next != 0; )
+        {
+            uint32_t page_number = next;
+            next = get32( pool_->fetch( page_number ).data( ) );
+            pool_->release( page_number );
+        }
+    }
+
+    /**
+     * Internal method to insert x, or Merge() it into the element with its key.
+     * Pre-Condition: lock_ is held.
+     */
+    void insertElement( const Comparable & x )
+    {
+        const std::string & key = x.getRecSequence( );
+        if( key.size( ) > page_size_ / 16 )
+            throw IllegalArgumentException{ };
+        if( root_ == 0 )
+        {
+            BufferPool::Page page = pool_->allocate( );
+            put16( page.data( ), kLeaf );
+            root_ = page.id( );
+            height_ = 1;
+        }
+        std::vector<uint32_t> path;
+        uint32_t leaf = descend( key, path );
+        PageImage image;
+        int slot;
+        std::string tail;
+        {
+            BufferPool::Page page = pool_->fetch( leaf );
+            slot = lowerBound( page.data( ), key );
+            bool found = slot < cellCount( page.data( ) ) && cellKey( page.data( ), slot ) == key;
+            if( found )
+            {
+                Comparable merged = element( page.data( ), slot );
+                merged.Merge( x );
+                image = unpack( page.data( ) );
+                releaseTail( image.cells_[ slot ].tail_ );
+                makeTail( merged, image.cells_[ slot ].tail_ );
+            }
+            else
+            {
+                image = unpack( page.data( ) );
+                makeTail( x, tail );
+                image.cells_.insert( image.cells_.begin( ) + slot, Cell{ key, tail } );
+                ++count_;
+            }
+        }
+        store( leaf, image, path );
+    }
+
+    /**
+     * Internal method to write image to page_number, splitting it if it does not fit and inserting the separator
+     * into the parent at the end of path, and so on up; a split root gets a new root above it.
+     */
+    void store( uint32_t page_number, PageImage & image, std::vector<uint32_t> & path )
+    {
+        if( packedSize( image ) <= page_size_ )
+        {
+            storeImage( page_number, image );
+            return;
+        }
+        // Split where the left half first reaches half the bytes; an interior page moves its middle key up.
+        size_t half = ( packedSize( image ) - kHeaderSize ) / 2, bytes = 0;
+        size_t split = 0;
+        for( ; split + 1 < image.cells_.size( ) && bytes < half; ++split )
+            bytes += 6 + image.cells_[ split ].key_.size( ) + image.cells_[ split ].tail_.size( );
+        split = std::max<size_t>( split, 1 );
+        PageImage right{ image.kind_, image.next_, 0, std::vector<Cell>( ) };
+        std::string separator;
+        if( image.kind_ == kLeaf )
+        {
+            separator = image.cells_[ split ].key_;
+            right.cells_.assign( image.cells_.begin( ) + split, image.cells_.end( ) );
+        }
+        else
+        {
+            separator = image.cells_[ split ].key_;
+            right.first_child_ = get32( &image.cells_[ split ].tail_[ 0 ] );
+            right.cells_.assign( image.cells_.begin( ) + split + 1, image.cells_.end( ) );
+        }
+        image.cells_.resize( split );
+        uint32_t right_number = pool_->allocate( ).id( );
+        image.next_ = right_number;
+        storeImage( right_number, right );
+        storeImage( page_number, image );
+
+        std::string child( 4, '\0' );
+        put32( &child[ 0 ], right_number );
+        if( path.empty( ) )
+        {
+            PageImage root{ kInterior, 0, page_number, std::vector<Cell>( 1, Cell{ separator, child } ) };
+            root_ = pool_->allocate( ).id( );
+            storeImage( root_, root );
+            ++height_;
+            return;
+        }
+        uint32_t parent_number = path.back( );
+        path.pop_back( );
+        PageImage parent = unpack( pool_->fetch( parent_number ).data( ) );
+        auto position = std::lower_bound( parent.cells_.begin( ), parent.cells_.end( ), separator,
+            [ ]( const Cell & c, const std::string & key ) { return c.key_ < key; } );
+        parent.cells_.insert( position, Cell{ separator, child } );
+        store( parent_number, parent, path );
+    }
+
+    /**
+     * Packs one level of the tree from left to right during a bulk load, for BulkLoader::finish( ) and
+     * buildIndex( ). Each page is filled to kBulkFillPercent, linked to the next, and its first key and page number
+     * are appended to parents. For an interior level, a child's key becomes a cell, except that the first child of
+     * each page goes in its header.
+     */
+    struct LevelBuilder
+    {
+        DiskBPlusTree & tree_;
+        bool leaves_;
+        std::vector<std::pair<std::string, uint32_t> > & parents_;
+        PageImage image_{ 0, 0, 0, std::vector<Cell>( ) };
+        uint32_t page_number_ = 0;
+        std::string first_key_;
+
+        LevelBuilder( DiskBPlusTree & tree, bool leaves, std::vector<std::pair<std::string, uint32_t> > & parents )
+          : tree_( tree ), leaves_{ leaves }, parents_( parents )
+        {
+            image_.kind_ = leaves ? kLeaf : kInterior;
+        }
+
+        void add( const std::string & key, const std::string & tail )
+        {
+            bool empty = page_number_ == 0;
+            if( !empty && packedSize( image_ ) + 6 + key.size( ) + tail.size( ) > tree_.page_size_ * kBulkFillPercent / 100 )
+            {
+                uint32_t next = tree_.pool_->allocate( ).id( );
+                image_.next_ = next;
+                tree_.storeImage( page_number_, image_ );
+                parents_.emplace_back( first_key_, page_number_ );
+                image_.cells_.clear( );
+                image_.first_child_ = 0;
+                page_number_ = next;
+                empty = true;
+            }
+            else if( empty )
+                page_number_ = tree_.pool_->allocate( ).id( );
+            if( empty )
+                first_key_ = key;
+            if( empty && !leaves_ )
+                image_.first_child_ = get32( tail.data( ) );
+            else
+                image_.cells_.push_back( Cell{ key, tail } );
+        }
+
+        /**
+         * Writes the last page. Returns false if nothing was added.
+         */
+        bool finish( )
+        {
+            if( page_number_ == 0 )
+                return false;
+            image_.next_ = 0;
+            tree_.storeImage( page_number_, image_ );
+            parents_.emplace_back( first_key_, page_number_ );
+            return true;
+        }
+    };
+
+    /**
+     * Internal method to build the interior levels over the given pages of the level below, up to a single root.
+     */
+    void buildIndex( std::vector<std::pair<std::string, uint32_t> > level )
+    {
+        height_ = 1;
+        while( level.size( ) > 1 )
+        {
+            std::vector<std::pair<std::string, uint32_t> > parents;
+            LevelBuilder builder{ *this, false, parents };
+            std::string child( 4, '\0' );
+            for( const std::pair<std::string, uint32_t> & page : level )
+            {
+                put32( &child[ 0 ], page.second );
+                builder.add( page.first, child );
+            }
+            builder.finish( );
+            level.swap( parents );
+            ++height_;
+        }
+        root_ = level[ 0 ].second;
+    }
+
+    /**
+     * Internal method to write the elements with keys strictly between *lower and *upper to out, either bound
+     * being absent if nullptr. Reads ahead up to read_ahead_ leaves, taking their page numbers from the leaves'
+     * parents.
+     */
+    void scan( const std::string *lower, const std::string *upper, std::ostream & out ) const
+    {
+        std::vector<uint32_t> path;
+        uint32_t leaf = descend( lower != nullptr ? *lower : std::string( ), path );
+        uint32_t parent = path.empty( ) ? 0 : path.back( );
+        int next_child = 0;                 // The first child of parent not yet read ahead
+        size_t ahead = 0;                   // Leaves read ahead and not yet reached
+        if( parent != 0 )
+        {
+            BufferPool::Page page = pool_->fetch( parent );
+            next_child = childIndex( page.data( ), lower != nullptr ? *lower : std::string( ) ) + 1;
+        }
+        while( leaf != 0 )
+        {
+            if( read_ahead_ > 0 && parent != 0 && ahead <= read_ahead_ / 2 )
+            {
+                std::vector<uint32_t> wanted;
+                while( parent != 0 && ahead < read_ahead_ )
+                {
+                    BufferPool::Page page = pool_->fetch( parent );
+                    if( next_child > cellCount( page.data( ) ) )
+                    {
+                        parent = get32( page.data( ) + 4 );
+                        next_child = 0;
+                        continue;
+                    }
+                    if( upper != nullptr && next_child > 0 && compareKey( page.data( ), next_child - 1, *upper ) >= 0 )
+                    {
+                        parent = 0;     // Every later leaf starts at or past the upper bound
+                        break;
+                    }
+                    wanted.push_back( childAt( page.data( ), next_child++ ) );
+                    ++ahead;
+                }
+                pool_->prefetch( wanted );
+            }
+            BufferPool::Page page = pool_->fetch( leaf );
+            int slot = lower != nullptr ? lowerBound( page.data( ), *lower ) : 0;
+            for( ; slot < cellCount( page.data( ) ); ++slot )
+            {
+                int order = lower != nullptr ? compareKey( page.data( ), slot, *lower ) : 1;
+                if( upper != nullptr && compareKey( page.data( ), slot, *upper ) >= 0 )
+                    return;
+                if( order > 0 )
+                    out << element( page.data( ), slot ) << " ";
+            }
+            leaf = get32( page.data( ) + 4 );
+            lower = nullptr;                // Every key in a later leaf is above the lower bound
+            ahead = ahead > 0 ? ahead - 1 : 0;
+        }
+    }
+
+    // Page 0: magic, page size, root, height, element count, page count, free list.
+    static constexpr const char *kMagic = "BPTREE01";
+
+    bool readMeta( uint32_t & page_count, uint32_t & free_list )
+    {
+        char meta[ 40 ];
+        if( pread( fd_, meta, sizeof( meta ), 0 ) != ssize_t( sizeof( meta ) ) || std::memcmp( meta, kMagic, 8 ) != 0
+            || get32( meta + 8 ) != page_size_ )
+            return false;
+        root_ = get32( meta + 12 );
+        height_ = int( get32( meta + 16 ) );
+        int64_t count;
+        std::memcpy( &count, meta + 20, sizeof( count ) );
+        count_ = long( count );
+        page_count = get32( meta + 28 );
+        free_list = get32( meta + 32 );
+        return true;
+    }
+
+    void writeMeta( )
+    {
+        char meta[ 40 ] = { };
+        std::memcpy( meta, kMagic, 8 );
+        put32( meta + 8, uint32_t( page_size_ ) );
+        put32( meta + 12, root_ );
+        put32( meta + 16, uint32_t( height_ ) );
+        int64_t count = count_;
+        std::memcpy( meta + 20, &count, sizeof( count ) );
+        put32( meta + 28, pool_->page_Count( ) );
+        put32( meta + 32, pool_->free_List( ) );
+        if( pwrite( fd_, meta, sizeof( meta ), 0 ) != ssize_t( sizeof( meta ) ) )
+            throw std::system_error{ errno, std::generic_category( ), "DiskBPlusTree: cannot write the root page" };
+    }
+};
+
+#endif
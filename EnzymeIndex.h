@@ -0,0 +1,79 @@
+/*
+ Title: EnzymeIndex.h
+ Description: A secondary index from enzyme acronym to the recognition sequences it cuts, the reverse of the
+        sequence -> enzymes mapping a tree of SequenceMap objects holds. A tree that owns one keeps it current on
+        insert(), Merge() and remove(), so "what does EcoRI recognize" is one hash lookup instead of a full traversal.
+ Modifications:
+ */
+#ifndef ENZYME_INDEX_H
+#define ENZYME_INDEX_H
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// EnzymeIndex class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// void add( a, s )       --> Record that acronym a recognizes sequence s
+// void remove( a, s )    --> Forget that acronym a recognizes sequence s
+// find( a )              --> Return the sequences recognized by a, or nullptr if a is unknown
+// void clear( )          --> Remove all entries
+// size_t size( )         --> Return number of acronyms indexed
+// ******************ERRORS********************************
+// None
+
+class EnzymeIndex
+{
+  public:
+    /**
+      * Records that acronym recognizes sequence. Adding the same pair twice keeps one entry.
+     */
+    void add( const std::string & acronym, const std::string & sequence )
+    {
+        std::vector<std::string> & sequences = index_[ acronym ];
+        if( std::find( sequences.begin( ), sequences.end( ), sequence ) == sequences.end( ) )
+            sequences.push_back( sequence );
+    }
+
+    /**
+      * Forgets that acronym recognizes sequence. An acronym left with no sequences is dropped.
+     */
+    void remove( const std::string & acronym, const std::string & sequence )
+    {
+        auto entry = index_.find( acronym );
+        if( entry == index_.end( ) )
+            return;
+        std::vector<std::string> & sequences = entry->second;
+        sequences.erase( std::remove( sequences.begin( ), sequences.end( ), sequence ), sequences.end( ) );
+        if( sequences.empty( ) )
+            index_.erase( entry );
+    }
+
+    /**
+      * Returns the recognition sequences of acronym in the order they were added, or nullptr if acronym is unknown.
+     */
+    const std::vector<std::string> * find( const std::string & acronym ) const
+    {
+        auto entry = index_.find( acronym );
+        return entry == index_.end( ) ? nullptr : &entry->second;
+    }
+
+    void clear( )
+    {
+        index_.clear( );
+    }
+
+    size_t size( ) const
+    {
+        return index_.size( );
+    }
+
+  private:
+    std::unordered_map<std::string, std::vector<std::string>> index_;
+};
+
+#endif
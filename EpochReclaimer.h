@@ -0,0 +1,236 @@
+/*
+ Title: EpochReclaimer.h
+ Description: Epoch-based reclamation for lock-free structures such as LockFreeSkipList. A thread that unlinks a
+        node cannot delete it at once, since other threads may still be reading it; it retire( )s the node instead,
+        and the node is deleted once every thread that could have reached it has moved on.
+        Each thread pin( )s the reclaimer for the length of an operation, publishing the global epoch it saw in its
+        own slot. A retired node is tagged with the epoch current when it was retired. The global epoch only
+        advances when every pinned thread has seen the current one, so once it has advanced twice past a node's
+        tag no thread can still be inside an operation that started before the node was unlinked, and the node is
+        freed. A thread that stays pinned holds back all reclamation, so operations should be short.
+        Threads are given slot numbers on first use, shared by every reclaimer and handed back when the thread
+        exits; a slot's retired nodes wait for the next thread to use the slot, or for the reclaimer's destructor.
+ Modifications:
+ */
+#ifndef EPOCH_RECLAIMER_H
+#define EPOCH_RECLAIMER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// EpochReclaimer class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// Guard pin( )           --> Enter an operation; nodes reachable now stay allocated until the Guard is destroyed
+// void retire( p )       --> Delete p once no pinned thread can still hold it; the caller must be pinned
+// void retire( p, d )    --> Same, calling d( p ) instead of delete
+// uint64_t epoch( )      --> Return the global epoch
+// size_t pending( )      --> Return number of retired objects not yet freed (only exact when no thread is active)
+// ******************ERRORS********************************
+// std::length_error if more than kMaxThreads threads use reclaimers at once
+
+class EpochReclaimer
+{
+    struct Slot;
+
+  public:
+    static const size_t kMaxThreads = 256;
+    static const size_t kRetireBatch = 64;      // Retires between attempts to advance the epoch and free
+
+    /**
+      * Keeps the calling thread pinned while it exists. Guards nest; only the outermost one unpins.
+     */
+    class Guard
+    {
+      public:
+        Guard( Guard && rhs ) : slot_{ rhs.slot_ }
+        {
+            rhs.slot_ = nullptr;
+        }
+
+        Guard( const Guard & rhs ) = delete;
+        Guard & operator=( const Guard & rhs ) = delete;
+        Guard & operator=( Guard && rhs ) = delete;
+
+        ~Guard( )
+        {
+            if( slot_ != nullptr && --slot_->depth_ == 0 )
+                slot_->epoch_.store( kIdle, std::memory_order_release );
+        }
+
+      private:
+        friend class EpochReclaimer;
+        Slot *slot_;
+
+        explicit Guard( Slot *slot ) : slot_{ slot }
+          { }
+    };
+
+    EpochReclaimer( ) : global_{ 0 }, slots_{ new Slot[ kMaxThreads ] }
+      { }
+
+    EpochReclaimer( const EpochReclaimer & rhs ) = delete;
+    EpochReclaimer & operator=( const EpochReclaimer & rhs ) = delete;
+
+    /**
+      * Frees everything still retired. Pre-Condition: no thread is pinned.
+     */
+    ~EpochReclaimer( )
+    {
+        for( size_t i = 0; i < kMaxThreads; ++i )
+            for( Retired & retired : slots_[ i ].limbo_ )
+                retired.deleter_( retired.object_ );
+    }
+
+    Guard pin( ) const
+    {
+        Slot & slot = slots_[ threadSlot( ) ];
+        if( slot.depth_++ == 0 )
+        {
+            slot.epoch_.store( global_.load( std::memory_order_seq_cst ), std::memory_order_relaxed );
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+        }
+        return Guard{ &slot };
+    }
+
+    template <typename T>
+    void retire( T *object ) const
+    {
+        retire( object, [ ]( void *p ) { delete static_cast<T *>( p ); } );
+    }
+
+    /**
+      * Pre-Condition: object is unreachable for threads that pin from now on, and the caller is pinned.
+     */
+    void retire( void *object, void ( *deleter )( void * ) ) const
+    {
+        Slot & slot = slots_[ threadSlot( ) ];
+        slot.limbo_.push_back( Retired{ object, deleter, global_.load( std::memory_order_seq_cst ) } );
+        if( ++slot.since_collect_ >= kRetireBatch )
+        {
+            slot.since_collect_ = 0;
+            collect( slot );
+        }
+    }
+
+    uint64_t epoch( ) const
+    {
+        return global_.load( std::memory_order_relaxed );
+    }
+
+    size_t pending( ) const
+    {
+        size_t count = 0;
+        for( size_t i = 0; i < kMaxThreads; ++i )
+            count += slots_[ i ].limbo_.size( );
+        return count;
+    }
+
+  private:
+    static const uint64_t kIdle = ~uint64_t( 0 );
+
+    struct Retired
+    {
+        void *object_;
+        void ( *deleter_ )( void * );
+        uint64_t epoch_;            // The global epoch when it was retired
+    };
+
+    struct alignas( 64 ) Slot       // Only its thread writes it, apart from reading epoch_
+    {
+        std::atomic<uint64_t> epoch_{ kIdle };      // The epoch the thread pinned at, or kIdle
+        int depth_ = 0;                             // Guards alive on the thread
+        size_t since_collect_ = 0;
+        std::vector<Retired> limbo_;                // Oldest first
+    };
+
+    mutable std::atomic<uint64_t> global_;
+    std::unique_ptr<Slot[]> slots_;
+
+    /**
+     * Internal method to advance the global epoch if every pinned thread has seen it, then free the objects of
+     * slot retired at least two epochs ago.
+     */
+    void collect( Slot & slot ) const
+    {
+        uint64_t current = global_.load( std::memory_order_seq_cst );
+        bool all_seen = true;
+        size_t in_use = nextSlot( ).load( std::memory_order_acquire );
+        for( size_t i = 0; i < in_use && all_seen; ++i )
+        {
+            uint64_t seen = slots_[ i ].epoch_.load( std::memory_order_seq_cst );
+            all_seen = seen == kIdle || seen == current;
+        }
+        if( all_seen )
+            global_.compare_exchange_strong( current, current + 1, std::memory_order_seq_cst );
+        current = global_.load( std::memory_order_seq_cst );
+        size_t freed = 0;
+        while( freed < slot.limbo_.size( ) && slot.limbo_[ freed ].epoch_ + 2 <= current )
+        {
+            slot.limbo_[ freed ].deleter_( slot.limbo_[ freed ].object_ );
+            ++freed;
+        }
+        slot.limbo_.erase( slot.limbo_.begin( ), slot.limbo_.begin( ) + freed );
+    }
+
+    /**
+     * Internal method to return the calling thread's slot number, giving it one on its first call.
+     */
+    static size_t threadSlot( )
+    {
+        struct Registration
+        {
+            size_t index_;
+
+            Registration( )
+            {
+                std::lock_guard<std::mutex> guard{ registryLock( ) };
+                std::vector<size_t> & free_slots = freeSlots( );
+                if( !free_slots.empty( ) )
+                {
+                    index_ = free_slots.back( );
+                    free_slots.pop_back( );
+                }
+                else if( nextSlot( ).load( std::memory_order_relaxed ) < kMaxThreads )
+                    index_ = nextSlot( ).fetch_add( 1, std::memory_order_release );
+                else
+                    throw std::length_error{ "EpochReclaimer: too many threads" };
+            }
+
+            ~Registration( )
+            {
+                std::lock_guard<std::mutex> guard{ registryLock( ) };
+                freeSlots( ).push_back( index_ );
+            }
+        };
+        thread_local Registration mine;
+        return mine.index_;
+    }
+
+    static std::mutex & registryLock( )
+    {
+        static std::mutex lock;
+        return lock;
+    }
+
+    static std::vector<size_t> & freeSlots( )
+    {
+        static std::vector<size_t> slots;
+        return slots;
+    }
+
+    static std::atomic<size_t> & nextSlot( )       // Slots ever handed out; collect( ) looks at no others
+    {
+        static std::atomic<size_t> next{ 0 };
+        return next;
+    }
+};
+
+#endif
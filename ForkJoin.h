@@ -0,0 +1,201 @@
+/*
+ Title: ForkJoin.h
+ Description: Fork-join walks over binary trees whose nodes have left_ and right_ links, used by the trees for their
+        whole-tree operations (clone, teardown, statistics and ordered dumps). Near the root each node's left
+        subtree is handed to the shared WorkStealingPool while the current thread takes the right one; below a
+        depth cutoff the walk is plain sequential recursion, so tasks stay large enough to be worth scheduling.
+        The pool has one thread per core, or TREES_THREADS threads if that environment variable is set; with a
+        single thread nothing is forked at all.
+ Modifications:
+    10.19.2026: A subtree of fewer than kForkJoinGrain nodes is walked sequentially whatever its depth, so small
+                trees never reach the pool.
+ */
+#ifndef FORK_JOIN_H
+#define FORK_JOIN_H
+
+#include <cstdlib>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "WorkStealingPool.h"
+
+// ******************PUBLIC OPERATIONS*********************
+// ForkJoinPool( )        --> Return the pool shared by every fork-join walk
+// ForkJoinDepth( )       --> Return the depth below which walks no longer fork
+// kForkJoinGrain         --> Subtrees with fewer nodes than this are walked sequentially
+// ParallelFold( t, d, f )--> Return f( t, d, fold( left ), fold( right ) ), with fold( nullptr ) = R( )
+// ParallelInorder( t, out, r )-> Call r( node, stream ) on every node in key order; output reaches out in order
+// ******************ERRORS********************************
+// None
+
+/**
+  * Returns the pool shared by all fork-join walks. It is created on first use with one thread per core, counting
+  * the caller, or with TREES_THREADS threads if that environment variable is a positive number.
+ */
+inline WorkStealingPool & ForkJoinPool( )
+{
+    static WorkStealingPool pool( [ ]( ) -> size_t
+    {
+        const char *setting = std::getenv( "TREES_THREADS" );
+        size_t threads = setting != nullptr && std::atoi( setting ) > 0 ? std::atoi( setting )
+                                                                        : std::thread::hardware_concurrency( );
+        return threads > 1 ? threads - 1 : 0;
+    }( ) );
+    return pool;
+}
+
+/**
+  * Returns the number of tree levels that fork: enough to make about eight tasks per thread, or 0 with one thread.
+ */
+inline int ForkJoinDepth( )
+{
+    static const int depth = [ ]( )
+    {
+        size_t slots = ForkJoinPool( ).slot_Count( );
+        if( slots < 2 )
+            return 0;
+        int levels = 3;
+        while( ( size_t{ 1 } << ( levels - 3 ) ) < slots )
+            ++levels;
+        return levels;
+    }( );
+    return depth;
+}
+
+const size_t kForkJoinGrain = 4096;
+
+/**
+  * Internal helper of the walks: returns true if subtree t has at least kForkJoinGrain nodes, visiting no more
+  * than that many.
+ */
+template <typename Node>
+bool ForkJoinWorthwhile( const Node *t )
+{
+    struct Counter
+    {
+        size_t count_ = 0;
+        void operator( )( const Node *t )
+        {
+            if( t == nullptr || count_ >= kForkJoinGrain )
+                return;
+            ++count_;
+            ( *this )( t->left_ );
+            ( *this )( t->right_ );
+        }
+    } counter;
+    counter( t );
+    return counter.count_ >= kForkJoinGrain;
+}
+
+/**
+  * Internal helper of ParallelFold( ): sequential post-order fold of subtree t.
+ */
+template <typename R, typename Node, typename Combine>
+R SequentialFold( Node *t, int depth, const Combine & combine )
+{
+    if( t == nullptr )
+        return R( );
+    Node *left = t->left_;
+    Node *right = t->right_;
+    return combine( t, depth, SequentialFold<R>( left, depth + 1, combine ), SequentialFold<R>( right, depth + 1, combine ) );
+}
+
+/**
+  * Post-order fold of the subtree t whose root is at the given depth: returns combine( t, depth, left, right ),
+  * where left and right are the folds of t's subtrees and the fold of an empty subtree is R( ). The two subtrees
+  * are folded in parallel while depth < ForkJoinDepth( ) and t has at least kForkJoinGrain nodes. combine may
+  * delete t, since both subtrees are done by then.
+ */
+template <typename R, typename Node, typename Combine>
+R ParallelFold( Node *t, int depth, const Combine & combine )
+{
+    if( t == nullptr )
+        return R( );
+    if( depth >= ForkJoinDepth( ) || !ForkJoinWorthwhile( t ) )
+        return SequentialFold<R>( t, depth, combine );
+    Node *left = t->left_;
+    Node *right = t->right_;
+    if( left == nullptr || right == nullptr )
+        return combine( t, depth, ParallelFold<R>( left, depth + 1, combine ), ParallelFold<R>( right, depth + 1, combine ) );
+    R left_result{ };
+    WorkStealingPool::TaskGroup group{ ForkJoinPool( ) };
+    group.run( [ &left_result, left, depth, &combine ]( ) { left_result = ParallelFold<R>( left, depth + 1, combine ); } );
+    R right_result = ParallelFold<R>( right, depth + 1, combine );
+    group.wait( );
+    return combine( t, depth, std::move( left_result ), std::move( right_result ) );
+}
+
+/**
+  * Internal helper of ParallelInorder( ): sequential in-order walk of subtree t.
+ */
+template <typename Node, typename Render>
+void SequentialInorder( const Node *t, std::ostream & out, const Render & render )
+{
+    if( t != nullptr )
+    {
+        SequentialInorder( t->left_, out, render );
+        render( t, out );
+        SequentialInorder( t->right_, out, render );
+    }
+}
+
+/**
+  * Calls render( node, stream ) on every node of subtree t in key order. The nodes above ForkJoinDepth( ) split the
+  * tree into pieces, none smaller than kForkJoinGrain nodes unless it is a whole subtree below that size; each piece
+  * is rendered in parallel into its own buffer, and the buffers are written to out in key order, so the output is
+  * the same as a sequential walk.
+ */
+template <typename Node, typename Render>
+void ParallelInorder( const Node *t, std::ostream & out, const Render & render )
+{
+    if( ForkJoinDepth( ) == 0 || !ForkJoinWorthwhile( t ) )
+    {
+        SequentialInorder( t, out, render );
+        return;
+    }
+    struct Piece
+    {
+        const Node *node_;
+        bool whole_subtree_;
+    };
+    std::vector<Piece> pieces;
+    struct Splitter
+    {
+        std::vector<Piece> & pieces_;
+        void operator( )( const Node *t, int depth )
+        {
+            if( t == nullptr )
+                return;
+            if( depth >= ForkJoinDepth( ) || !ForkJoinWorthwhile( t ) )
+            {
+                pieces_.push_back( Piece{ t, true } );
+                return;
+            }
+            ( *this )( t->left_, depth + 1 );
+            pieces_.push_back( Piece{ t, false } );
+            ( *this )( t->right_, depth + 1 );
+        }
+    };
+    Splitter{ pieces }( t, 0 );
+
+    std::vector<std::string> buffers( pieces.size( ) );
+    ForkJoinPool( ).parallel_For( 0, pieces.size( ), 1, [ & ]( size_t first, size_t last, size_t )
+    {
+        for( size_t i = first; i < last; ++i )
+        {
+            std::ostringstream buffer;
+            if( pieces[ i ].whole_subtree_ )
+                SequentialInorder( pieces[ i ].node_, buffer, render );
+            else
+                render( pieces[ i ].node_, buffer );
+            buffers[ i ] = buffer.str( );
+        }
+    } );
+    for( const std::string & buffer : buffers )
+        out << buffer;
+}
+
+#endif
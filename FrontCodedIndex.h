@@ -0,0 +1,535 @@
+/*
+ Title: FrontCodedIndex.h
+ Description: A compressed, read-only copy of an AvlTree of SequenceMaps, for replica processes that only answer
+        queries and should hold as little memory as possible. Sorted recognition sequences share long prefixes with
+        their neighbours, and the same enzyme acronyms recur across the database, so neither is stored in full:
+        The keys are cut into blocks of block_size. The first key of each block is kept whole in a small top-level
+        array that a lookup binary searches; the others are front coded, each stored as the length it shares with
+        the key before it and the bytes that follow, usually behind a single header byte.
+        The distinct acronyms are front coded the same way, in sorted order, and an acronym is referred to by its
+        rank. Each key's acronyms are written to one bit stream as a count and a list of ranks, each in as few bits
+        as the largest one needs; a block remembers where its keys' lists begin.
+        find( ), find_and_print( ), print_Between( ) and for_Each( ) decode one block at a time and never build
+        the SequenceMaps; they hand out Entry views with the key and a way to look up each acronym. The answers
+        and their output match those of the tree the index was built from.
+ Modifications:
+    10.19.26: Added Entry::acronyms( ), which decodes each dictionary block once per entry; Print_Vector( ) uses it.
+ */
+#ifndef FRONT_CODED_INDEX_H
+#define FRONT_CODED_INDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "AvlTree.h"
+#include "SequenceMap.h"
+
+// FrontCodedIndex class
+//
+// CONSTRUCTION: from an AvlTree<SequenceMap>, whose elements are copied in key order, and the block size
+//
+// ******************PUBLIC OPERATIONS*********************
+// bool find( x, i )      --> Return true if x is present; i is the number of keys compared
+// void find_and_print( x )--> Prints vector associated with x if x is present
+// find_and_print( x, out )-> same, written to stream out
+// print_Between( k1, k2 )--> prints all elements with keys between k1 and k2
+// print_Between( k1, k2, out )--> same, written to stream out
+// for_Each_Between( k1, k2, f )--> Calls f( entry ) for the elements print_Between( k1, k2 ) would print
+// for_Each( f )          --> Calls f( entry ) for every element, in key order
+// boolean isEmpty( )     --> Return true if empty; else false
+// int count_Nodes( )     --> Return number of elements
+// size_t key_Bytes( ), acronym_Bytes( ), payload_Bytes( )
+//                        --> Return memory taken by the keys, the acronym dictionary and the acronym lists
+// size_t memory_Bytes( ) --> Return the sum of the three
+// ******************ERRORS********************************
+// None
+
+class FrontCodedIndex
+{
+  public:
+    static const size_t kDefaultBlockSize = 32;
+
+    /**
+      * One element as decoded from the index; valid until the call that handed it out returns.
+     */
+    class Entry
+    {
+      public:
+        const std::string & getRecSequence( ) const
+        {
+            return key_;
+        }
+
+        size_t acronym_Count( ) const
+        {
+            return ranks_.size( );
+        }
+
+        /**
+          * Returns acronym i, decoding its dictionary block from the start; acronyms( ) is cheaper for all of them.
+         */
+        std::string acronym( size_t i ) const
+        {
+            return index_->acronyms_.at( ranks_[ i ] );
+        }
+
+        /**
+          * Returns the acronyms in order. They are decoded in rank order with one cursor, so each dictionary block
+          * is decoded at most once however many of the acronyms fall in it.
+         */
+        std::vector<std::string> acronyms( ) const
+        {
+            std::vector<uint32_t> order( ranks_.size( ) );
+            for( uint32_t i = 0; i < order.size( ); ++i )
+                order[ i ] = i;
+            std::sort( order.begin( ), order.end( ), [ this ]( uint32_t a, uint32_t b ) { return ranks_[ a ] < ranks_[ b ]; } );
+            std::vector<std::string> result( ranks_.size( ) );
+            FrontCodedStrings::Cursor cursor;
+            for( uint32_t i : order )
+                result[ i ] = index_->acronyms_.at( ranks_[ i ], cursor );
+            return result;
+        }
+
+        /**
+          * Writes the acronyms as SequenceMap::Print_Vector( ) does.
+         */
+        void Print_Vector( std::ostream & out = std::cout ) const
+        {
+            for( const std::string & acronym : acronyms( ) )
+                out << acronym << " ";
+            out << std::endl;
+        }
+
+        /**
+          * Writes the element as SequenceMap's operator<< does.
+         */
+        friend std::ostream & operator<<( std::ostream & out, const Entry & entry )
+        {
+            out << entry.key_ << " ";
+            entry.Print_Vector( out );
+            return out;
+        }
+
+      private:
+        friend class FrontCodedIndex;
+        const FrontCodedIndex *index_;
+        std::string key_;
+        std::vector<uint32_t> ranks_;       // Positions of the acronyms in the dictionary
+
+        explicit Entry( const FrontCodedIndex *index ) : index_{ index }
+          { }
+    };
+
+    explicit FrontCodedIndex( const AvlTree<SequenceMap> & tree, size_t block_size = kDefaultBlockSize )
+      : count_bits_{ 0 }, rank_bits_{ 0 }
+    {
+        block_size = std::max( block_size, size_t( 1 ) );
+        std::vector<std::string> keys, dictionary;
+        size_t most_acronyms = 0;
+        tree.for_Each( [ & ]( const SequenceMap & x )
+        {
+            keys.push_back( x.getRecSequence( ) );
+            const std::vector<std::string> & acronyms = x.getEnzymeAcronyms( );
+            dictionary.insert( dictionary.end( ), acronyms.begin( ), acronyms.end( ) );
+            most_acronyms = std::max( most_acronyms, acronyms.size( ) );
+        } );
+        std::sort( dictionary.begin( ), dictionary.end( ) );
+        dictionary.erase( std::unique( dictionary.begin( ), dictionary.end( ) ), dictionary.end( ) );
+        count_bits_ = bitWidth( most_acronyms );
+        rank_bits_ = dictionary.empty( ) ? 0 : bitWidth( dictionary.size( ) - 1 );
+
+        uint64_t bits = 0;
+        size_t position = 0;
+        tree.for_Each( [ & ]( const SequenceMap & x )
+        {
+            if( position++ % block_size == 0 )
+                block_bits_.push_back( bits );
+            const std::vector<std::string> & acronyms = x.getEnzymeAcronyms( );
+            appendBits( acronyms.size( ), count_bits_, bits );
+            for( const std::string & acronym : acronyms )
+                appendBits( std::lower_bound( dictionary.begin( ), dictionary.end( ), acronym ) - dictionary.begin( ),
+                            rank_bits_, bits );
+        } );
+        payload_.shrink_to_fit( );
+        block_bits_.shrink_to_fit( );
+        keys_.build( keys, block_size );
+        acronyms_.build( dictionary, block_size );
+    }
+
+    bool find( const std::string & x, int & probes ) const
+    {
+        probes = 0;
+        size_t position;
+        return locate( x, position, probes );
+    }
+
+    void find_and_print( const std::string & x ) const
+    {
+        find_and_print( x, std::cout );
+    }
+
+    void find_and_print( const std::string & x, std::ostream & out ) const
+    {
+        int probes = 0;
+        size_t position;
+        if( !locate( x, position, probes ) )
+        {
+            out << "Not found in this tree." << std::endl;
+            return;
+        }
+        Entry entry{ this };
+        uint64_t bit = block_bits_[ position / keys_.block_Size( ) ];
+        for( size_t skipped = position % keys_.block_Size( ); skipped > 0; --skipped )
+            skipRanks( bit );
+        readRanks( bit, entry );
+        entry.Print_Vector( out );
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2 ) const
+    {
+        print_Between( str1, str2, std::cout );
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2, std::ostream & out ) const
+    {
+        for_Each_Between( str1, str2, [ &out ]( const Entry & entry ) { out << entry << " "; } );
+    }
+
+    /**
+      * Calls visit( entry ) for every element with a key strictly between str1 and str2, in key order, decoding
+      * from the block that may hold str1 onwards.
+     */
+    template <typename Visit>
+    void for_Each_Between( const std::string & str1, const std::string & str2, Visit visit ) const
+    {
+        int probes = 0;
+        if( !isEmpty( ) )
+            walk( keys_.findBlock( str1, probes ), &str1, &str2, visit );
+    }
+
+    template <typename Visit>
+    void for_Each( Visit visit ) const
+    {
+        if( !isEmpty( ) )
+            walk( 0, nullptr, nullptr, visit );
+    }
+
+    bool isEmpty( ) const
+    {
+        return keys_.size( ) == 0;
+    }
+
+    int count_Nodes( ) const
+    {
+        return keys_.size( );
+    }
+
+    size_t key_Bytes( ) const
+    {
+        return keys_.bytes( );
+    }
+
+    size_t acronym_Bytes( ) const
+    {
+        return acronyms_.bytes( );
+    }
+
+    size_t payload_Bytes( ) const
+    {
+        return payload_.capacity( ) * sizeof( uint64_t ) + block_bits_.capacity( ) * sizeof( uint64_t );
+    }
+
+    size_t memory_Bytes( ) const
+    {
+        return key_Bytes( ) + acronym_Bytes( ) + payload_Bytes( );
+    }
+
+  private:
+    /**
+     * A sorted array of strings, front coded in blocks, with each block's first string kept whole.
+     */
+    class FrontCodedStrings
+    {
+      public:
+        /**
+         * Where a decoding walk has got to; key_ is the string at position_.
+         */
+        struct Cursor
+        {
+            size_t position_ = SIZE_MAX;    // SIZE_MAX until seekBlock( ) places it
+            const uint8_t *next_;           // The next string's header in tails_
+            std::string key_;
+        };
+
+        FrontCodedStrings( ) : block_size_{ 1 }, size_{ 0 }
+          { }
+
+        void build( const std::vector<std::string> & sorted, size_t block_size )
+        {
+            block_size_ = block_size;
+            size_ = sorted.size( );
+            for( size_t i = 0; i < sorted.size( ); ++i )
+            {
+                if( i % block_size_ == 0 )
+                {
+                    head_offsets_.push_back( heads_.size( ) );
+                    heads_ += sorted[ i ];
+                    tail_offsets_.push_back( tails_.size( ) );
+                    continue;
+                }
+                const std::string & previous = sorted[ i - 1 ], & key = sorted[ i ];
+                size_t shared = 0;
+                while( shared < previous.size( ) && shared < key.size( ) && previous[ shared ] == key[ shared ] )
+                    ++shared;
+                size_t suffix = key.size( ) - shared;
+                if( shared < 15 && suffix < 16 )
+                    tails_.push_back( uint8_t( shared << 4 | suffix ) );
+                else
+                {
+                    tails_.push_back( kEscape );
+                    appendVarint( shared );
+                    appendVarint( suffix );
+                }
+                tails_.insert( tails_.end( ), key.begin( ) + shared, key.end( ) );
+            }
+            head_offsets_.push_back( heads_.size( ) );
+            tail_offsets_.push_back( tails_.size( ) );
+            heads_.shrink_to_fit( );
+            head_offsets_.shrink_to_fit( );
+            tails_.shrink_to_fit( );
+            tail_offsets_.shrink_to_fit( );
+        }
+
+        size_t size( ) const
+        {
+            return size_;
+        }
+
+        size_t block_Size( ) const
+        {
+            return block_size_;
+        }
+
+        size_t bytes( ) const
+        {
+            return heads_.capacity( ) + tails_.capacity( )
+                   + ( head_offsets_.capacity( ) + tail_offsets_.capacity( ) ) * sizeof( uint32_t );
+        }
+
+        /**
+         * Returns the last block whose first string is not above x, or block 0 if there is none. probes is
+         * incremented once per string compared.
+         */
+        size_t findBlock( const std::string & x, int & probes ) const
+        {
+            size_t low = 0, high = head_offsets_.size( ) - 1;     // The answer is below high
+            while( high - low > 1 )
+            {
+                size_t middle = low + ( high - low ) / 2;
+                ++probes;
+                if( heads_.compare( head_offsets_[ middle ], head_offsets_[ middle + 1 ] - head_offsets_[ middle ], x ) <= 0 )
+                    low = middle;
+                else
+                    high = middle;
+            }
+            return low;
+        }
+
+        void seekBlock( size_t block, Cursor & cursor ) const
+        {
+            cursor.position_ = block * block_size_;
+            cursor.next_ = tails_.data( ) + tail_offsets_[ block ];
+            cursor.key_.assign( heads_, head_offsets_[ block ], head_offsets_[ block + 1 ] - head_offsets_[ block ] );
+        }
+
+        /**
+         * Moves cursor to the next string, into the next block if need be. Returns false, leaving cursor alone,
+         * at the end; with within_block, at the end of the block.
+         */
+        bool advance( Cursor & cursor, bool within_block ) const
+        {
+            size_t next = cursor.position_ + 1;
+            if( next >= size_ || ( within_block && next % block_size_ == 0 ) )
+                return false;
+            if( next % block_size_ == 0 )
+            {
+                seekBlock( next / block_size_, cursor );
+                return true;
+            }
+            const uint8_t *p = cursor.next_;
+            size_t shared, suffix;
+            if( *p != kEscape )
+            {
+                shared = *p >> 4;
+                suffix = *p++ & 15;
+            }
+            else
+            {
+                ++p;
+                shared = readVarint( p );
+                suffix = readVarint( p );
+            }
+            cursor.key_.resize( shared );
+            cursor.key_.append( reinterpret_cast<const char *>( p ), suffix );
+            cursor.next_ = p + suffix;
+            cursor.position_ = next;
+            return true;
+        }
+
+        std::string at( size_t position ) const
+        {
+            Cursor cursor;
+            return at( position, cursor );
+        }
+
+        /**
+         * Returns the string at position, leaving cursor on it. The search goes on from cursor when it already
+         * stands in position's block, not past it, so strings asked for in increasing order decode a block once.
+         */
+        const std::string & at( size_t position, Cursor & cursor ) const
+        {
+            if( cursor.position_ > position || cursor.position_ / block_size_ != position / block_size_ )
+                seekBlock( position / block_size_, cursor );
+            while( cursor.position_ < position )
+                advance( cursor, true );
+            return cursor.key_;
+        }
+
+      private:
+        static constexpr uint8_t kEscape = 0xFF;    // Lengths follow as varints; a packed header never has 15 shared
+
+        size_t block_size_;
+        size_t size_;
+        std::string heads_;                     // Each block's first string, back to back
+        std::vector<uint32_t> head_offsets_;    // Where each block's first string starts in heads_, and the end
+        std::vector<uint8_t> tails_;            // The rest of each block, front coded
+        std::vector<uint32_t> tail_offsets_;    // Where each block's front-coded strings start in tails_, and the end
+
+        void appendVarint( size_t value )
+        {
+            for( ; value >= 0x80; value >>= 7 )
+                tails_.push_back( uint8_t( value | 0x80 ) );
+            tails_.push_back( uint8_t( value ) );
+        }
+
+        static size_t readVarint( const uint8_t * & p )
+        {
+            size_t value = 0;
+            for( int shift = 0; ; shift += 7 )
+            {
+                value |= size_t( *p & 0x7F ) << shift;
+                if( ( *p++ & 0x80 ) == 0 )
+                    return value;
+            }
+        }
+    };
+
+    FrontCodedStrings keys_;
+    FrontCodedStrings acronyms_;                // Every distinct acronym, sorted; an acronym's rank is its position
+    std::vector<uint64_t> payload_;             // Per key: acronym count, then ranks, in count_bits_ and rank_bits_
+    std::vector<uint64_t> block_bits_;          // Where each key block's acronym lists start in payload_, in bits
+    int count_bits_;
+    int rank_bits_;
+
+    static int bitWidth( uint64_t value )
+    {
+        int width = 0;
+        for( ; value != 0; value >>= 1 )
+            ++width;
+        return width;
+    }
+
+    void appendBits( uint64_t value, int width, uint64_t & bits )
+    {
+        if( width == 0 )
+            return;
+        size_t word = bits >> 6;
+        int offset = bits & 63;
+        if( word == payload_.size( ) )
+            payload_.push_back( 0 );
+        payload_[ word ] |= value << offset;
+        if( offset + width > 64 )
+            payload_.push_back( value >> ( 64 - offset ) );
+        bits += width;
+    }
+
+    uint64_t readBits( uint64_t & bit, int width ) const
+    {
+        if( width == 0 )
+            return 0;
+        size_t word = bit >> 6;
+        int offset = bit & 63;
+        uint64_t value = payload_[ word ] >> offset;
+        if( offset + width > 64 )
+            value |= payload_[ word + 1 ] << ( 64 - offset );
+        bit += width;
+        return width == 64 ? value : value & ( ( uint64_t( 1 ) << width ) - 1 );
+    }
+
+    void readRanks( uint64_t & bit, Entry & entry ) const
+    {
+        entry.ranks_.resize( readBits( bit, count_bits_ ) );
+        for( uint32_t & rank : entry.ranks_ )
+            rank = readBits( bit, rank_bits_ );
+    }
+
+    void skipRanks( uint64_t & bit ) const
+    {
+        uint64_t count = readBits( bit, count_bits_ );
+        bit += count * rank_bits_;
+    }
+
+    /**
+     * Internal method to find x, setting position to its place among the keys. The next block's first key is
+     * above x, so only x's block is decoded.
+     */
+    bool locate( const std::string & x, size_t & position, int & probes ) const
+    {
+        if( isEmpty( ) )
+            return false;
+        FrontCodedStrings::Cursor cursor;
+        keys_.seekBlock( keys_.findBlock( x, probes ), cursor );
+        do
+        {
+            ++probes;
+            int order = cursor.key_.compare( x );
+            if( order >= 0 )
+            {
+                position = cursor.position_;
+                return order == 0;
+            }
+        } while( keys_.advance( cursor, true ) );
+        return false;
+    }
+
+    /**
+     * Internal method to decode the elements from the start of block on, calling visit( entry ) for those with
+     * keys above *lower, if lower is not nullptr, until a key reaches *upper, if upper is not nullptr.
+     */
+    template <typename Visit>
+    void walk( size_t block, const std::string *lower, const std::string *upper, Visit & visit ) const
+    {
+        FrontCodedStrings::Cursor cursor;
+        keys_.seekBlock( block, cursor );
+        uint64_t bit = block_bits_[ block ];
+        Entry entry{ this };
+        do
+        {
+            if( upper != nullptr && !( cursor.key_ < *upper ) )
+                return;
+            if( lower == nullptr || *lower < cursor.key_ )
+            {
+                entry.key_ = cursor.key_;
+                readRanks( bit, entry );
+                visit( entry );
+            }
+            else
+                skipRanks( bit );
+        } while( keys_.advance( cursor, false ) );
+    }
+};
+
+#endif
@@ -0,0 +1,572 @@
+/*
+ Title: HashTable.h
+ Description: An open-addressing hash table keyed by recognition sequence. Slots are grouped 16 at a time and every
+        slot has a one byte control tag (empty, deleted, or 7 bits of the key's hash), so a probe compares a whole
+        group of tags at once and only touches the slots whose tag matches. Exact lookups cost O(1) instead of the
+        O(log n) string compares of the trees. The table has no key order, so ordered operations such as
+        print_Between() stay on AvlTree.
+ Modifications:
+    10.19.2026: Added enable_Acronym_Index() and find_Acronym(), as in AvlTree.
+    10.19.2026: Added find_Element(), for_Each(), drain() and reserve() for BufferedAvlTree's write buffer.
+    10.19.2026: insert() of an rvalue Merge()s a duplicate by move.
+    10.19.2026: Added find_and_print( x, out ), as in AvlTree.
+ */
+#ifndef HASH_TABLE_H
+#define HASH_TABLE_H
+
+#include "dsexceptions.h"
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "SequenceMap.h"
+#include "EnzymeIndex.h"
+
+// HashTable class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// void insert( x )       --> Insert x; Merge() into the stored item if the key is already present
+// void remove( x )       --> Remove x
+// bool remove( x, i)     --> If x is found in table, it is removed and call returns true.
+// bool contains( x )     --> Return true if x is present
+// void find_and_print( x)--> Prints vector associated with x if x is present
+// find_and_print( x, out )-> same, written to stream out
+// bool find( x, i )      --> Returns true if x is present; i is the number of groups probed
+// find_Element( x )      --> Return a pointer to the item whose key is x, or nullptr
+// void for_Each( f )     --> Call f( item ) for every item, in slot order
+// void drain( v )        --> Move every item to the end of vector v, leaving the table empty
+// void reserve( n )      --> Make room for n items, so inserting them does not rehash
+// boolean isEmpty( )     --> Return true if empty; else false
+// void makeEmpty( )      --> Remove all items
+// void printTree( )      --> Print table contents in slot order
+// int count_Nodes( )     --> Return number of stored items
+// int calculate_IPL()    --> Return sum over all items of the groups probed past their home group
+// int calculate_Avg_Depth()-> Return average probe distance of all items
+// double calculate_ratio()-> Return Ratio of Avg probe distance to log2n
+// void enable_Acronym_Index( )--> Build an index from enzyme acronym to recognition sequences
+// find_Acronym( a )     --> Return the recognition sequences of acronym a, or nullptr
+// ******************ERRORS********************************
+// None
+
+template <typename Comparable>
+class HashTable
+{
+  public:
+    HashTable( ) : ctrl_{ nullptr }, slots_{ nullptr }, num_groups_{ 0 }, size_{ 0 }, tombstones_{ 0 },
+        acronym_index_{ nullptr }
+      { }
+
+    HashTable( const HashTable & rhs ) : HashTable( )
+    {
+        rehash( rhs.num_groups_ );
+        for( size_t i = 0; i < rhs.capacity( ); ++i )
+            if( isFull( rhs.ctrl_[ i ] ) )
+                insertUnique( rhs.slots_[ i ] );
+        if( rhs.acronym_index_ != nullptr )
+            acronym_index_ = new EnzymeIndex{ *rhs.acronym_index_ };
+    }
+
+    HashTable( HashTable && rhs ) : ctrl_{ rhs.ctrl_ }, slots_{ rhs.slots_ }, num_groups_{ rhs.num_groups_ },
+        size_{ rhs.size_ }, tombstones_{ rhs.tombstones_ }, acronym_index_{ rhs.acronym_index_ }
+    {
+        rhs.ctrl_ = nullptr;
+        rhs.slots_ = nullptr;
+        rhs.num_groups_ = rhs.size_ = rhs.tombstones_ = 0;
+        rhs.acronym_index_ = nullptr;
+    }
+
+    ~HashTable( )
+    {
+        makeEmpty( );
+        deallocate( );
+        delete acronym_index_;
+    }
+
+    /**
+     * Deep copy.
+     */
+    HashTable & operator=( const HashTable & rhs )
+    {
+        HashTable copy = rhs;
+        std::swap( *this, copy );
+        return *this;
+    }
+
+    /**
+     * Move.
+     */
+    HashTable & operator=( HashTable && rhs )
+    {
+        std::swap( ctrl_, rhs.ctrl_ );
+        std::swap( slots_, rhs.slots_ );
+        std::swap( num_groups_, rhs.num_groups_ );
+        std::swap( size_, rhs.size_ );
+        std::swap( tombstones_, rhs.tombstones_ );
+        std::swap( acronym_index_, rhs.acronym_index_ );
+        return *this;
+    }
+
+    /**
+     * Returns true if x is found in the table.
+     */
+    bool contains( const Comparable & x ) const
+    {
+        int probes = 0;
+        return findSlot( x.getRecSequence( ), probes ) != kNotFound;
+    }
+
+    /**
+      * This is specific to an object T with a string data member that can be retrieved using getRecSequence().
+      * Post Condition: returns true if x is found. recursion_calls is updated to indicate the number of groups
+      * that were probed, which plays the role of the trees' recursion count.
+     */
+    bool find( const std::string & x, int & recursion_calls ) const
+    {
+        recursion_calls = 0;
+        return findSlot( x, recursion_calls ) != kNotFound;
+    }
+
+    /**
+      * Returns the item whose key is x, or nullptr if there is none.
+     */
+    const Comparable * find_Element( const std::string & x ) const
+    {
+        int probes = 0;
+        size_t slot = findSlot( x, probes );
+        return slot == kNotFound ? nullptr : &slots_[ slot ];
+    }
+
+    /**
+      * If x is located in the table, its associated vector is printed.
+      * This assumes that T has a Print_Vector() function.
+     */
+    void find_and_print( const std::string & x ) const
+    {
+        find_and_print( x, std::cout );
+    }
+
+    void find_and_print( const std::string & x, std::ostream & out ) const
+    {
+        int probes = 0;
+        size_t slot = findSlot( x, probes );
+        if( slot == kNotFound )
+            out << "Not found in this tree." << std::endl;
+        else
+            slots_[ slot ].Print_Vector( out );
+    }
+
+    /**
+     * Test if the table is logically empty.
+     */
+    bool isEmpty( ) const
+    {
+        return size_ == 0;
+    }
+
+    /**
+     * Print the table contents in slot order (the table has no key order).
+     */
+    void printTree( ) const
+    {
+        if( isEmpty( ) )
+            std::cout << "Empty tree" << std::endl;
+        else
+            for( size_t i = 0; i < capacity( ); ++i )
+                if( isFull( ctrl_[ i ] ) )
+                    std::cout << slots_[ i ] << " ";
+        std::cout << std::endl;
+    }
+
+    /**
+     * Make the table logically empty. The slot arrays are kept for reuse.
+     */
+    void makeEmpty( )
+    {
+        for( size_t i = 0; i < capacity( ); ++i )
+        {
+            if( isFull( ctrl_[ i ] ) )
+                slots_[ i ].~Comparable( );
+            ctrl_[ i ] = kEmpty;
+        }
+        size_ = tombstones_ = 0;
+        if( acronym_index_ != nullptr )
+            acronym_index_->clear( );
+    }
+
+    /**
+     * Calls visit( item ) for every item, in slot order.
+     */
+    template <typename Visit>
+    void for_Each( Visit visit ) const
+    {
+        for( size_t i = 0; i < capacity( ); ++i )
+            if( isFull( ctrl_[ i ] ) )
+                visit( slots_[ i ] );
+    }
+
+    /**
+     * Move every item to the end of out, in slot order, and make the table empty. The slot arrays are kept for
+     * reuse.
+     */
+    void drain( std::vector<Comparable> & out )
+    {
+        for( size_t i = 0; i < capacity( ); ++i )
+        {
+            if( isFull( ctrl_[ i ] ) )
+            {
+                out.push_back( std::move( slots_[ i ] ) );
+                slots_[ i ].~Comparable( );
+            }
+            ctrl_[ i ] = kEmpty;
+        }
+        size_ = tombstones_ = 0;
+        if( acronym_index_ != nullptr )
+            acronym_index_->clear( );
+    }
+
+    /**
+     * Grow the table, if needed, so that it holds items items without rehashing.
+     */
+    void reserve( size_t items )
+    {
+        size_t groups = num_groups_ == 0 ? 1 : num_groups_;
+        while( items * 8 > groups * kGroupWidth * 7 )
+            groups *= 2;
+        if( groups != num_groups_ )
+            rehash( groups );
+    }
+
+    /**
+     * Insert x into the table; if the key is present, x is merged into the stored item.
+     * This function assumes all Comparables have a Merge() function.
+     */
+    void insert( const Comparable & x )
+    {
+        int probes = 0;
+        size_t slot = findSlot( x.getRecSequence( ), probes );
+        if( slot != kNotFound )
+            slots_[ slot ].Merge( x );
+        else
+            insertUnique( x );
+        indexAcronyms( x );
+    }
+
+    /**
+     * Insert x into the table; if the key is present, x is merged into the stored item.
+     */
+    void insert( Comparable && x )
+    {
+        int probes = 0;
+        size_t slot = findSlot( x.getRecSequence( ), probes );
+        if( slot != kNotFound )
+        {
+            indexAcronyms( x );
+            slots_[ slot ].Merge( std::move( x ) );
+        }
+        else
+        {
+            size_t placed = insertUnique( std::move( x ) );  // May rehash, so read slots_ afterwards
+            indexAcronyms( slots_[ placed ] );
+        }
+    }
+
+    /**
+     * Remove x from the table. Nothing is done if x is not found.
+     */
+    void remove( const Comparable & x )
+    {
+        int probes = 0;
+        eraseSlot( findSlot( x.getRecSequence( ), probes ) );
+    }
+
+    /**
+      * Remove x from the table.
+      * Post-Condition: If x is not found, returns false. recursion_calls is updated to indicate the number of
+      * groups probed.
+     */
+    bool remove( const std::string & x, int & recursion_calls )
+    {
+        recursion_calls = 0;
+        return eraseSlot( findSlot( x, recursion_calls ) );
+    }
+
+    /**
+     * Returns number of items in the table.
+     */
+    int count_Nodes( ) const
+    {
+        return size_;
+    }
+
+    /**
+      * Returns the sum over all items of the number of groups probed before the item's group is reached.
+      * This is the hash table analogue of the trees' internal path length.
+     */
+    int calculate_IPL( ) const
+    {
+        int total = 0;
+        for( size_t i = 0; i < capacity( ); ++i )
+            if( isFull( ctrl_[ i ] ) )
+            {
+                int probes = 0;
+                findSlot( slots_[ i ].getRecSequence( ), probes );
+                total += probes - 1;
+            }
+        return total;
+    }
+
+    /**
+      * Return the average probe distance of the table.
+     */
+    int calculate_Avg_Depth( ) const
+    {
+        return calculate_IPL( ) / count_Nodes( );
+    }
+
+    /**
+      * Returns the ratio of the average probe distance to log2n where n is the number of items.
+     */
+    double calculate_ratio( ) const
+    {
+        int avg_depth = calculate_Avg_Depth( );
+        return avg_depth / log2( count_Nodes( ) );
+    }
+
+    /**
+      * Builds an EnzymeIndex from the acronyms of every item. From then on insert() and remove() keep it current.
+     */
+    void enable_Acronym_Index( )
+    {
+        delete acronym_index_;
+        acronym_index_ = new EnzymeIndex;
+        for( size_t i = 0; i < capacity( ); ++i )
+            if( isFull( ctrl_[ i ] ) )
+                indexAcronyms( slots_[ i ] );
+    }
+
+    /**
+      * Returns the recognition sequences of the enzyme acronym, or nullptr if it is unknown or no index is enabled.
+     */
+    const std::vector<std::string> * find_Acronym( const std::string & acronym ) const
+    {
+        return acronym_index_ == nullptr ? nullptr : acronym_index_->find( acronym );
+    }
+
+  private:
+    static const size_t kGroupWidth = 16;
+    static const size_t kNotFound = static_cast<size_t>( -1 );
+    static const int8_t kEmpty = -128;
+    static const int8_t kDeleted = -2;
+
+    int8_t     *ctrl_;          // One control byte per slot: kEmpty, kDeleted, or the low 7 hash bits of a full slot
+    Comparable *slots_;         // Raw storage; only slots whose control byte is full hold a constructed Comparable
+    size_t      num_groups_;    // Always zero or a power of two
+    size_t      size_;
+    size_t      tombstones_;
+    EnzymeIndex *acronym_index_; // Optional; nullptr unless enable_Acronym_Index() was called
+
+    size_t capacity( ) const
+    {
+        return num_groups_ * kGroupWidth;
+    }
+
+    static bool isFull( int8_t c )
+    {
+        return c >= 0;
+    }
+
+    static size_t hashOf( const std::string & key )
+    {
+        return std::hash<std::string>{ }( key );
+    }
+
+    /**
+     * Bit i of the result is set if control byte i of the group starting at pos equals tag.
+     */
+    uint32_t matchTag( size_t pos, int8_t tag ) const
+    {
+#ifdef __SSE2__
+        __m128i group = _mm_loadu_si128( reinterpret_cast<const __m128i *>( ctrl_ + pos ) );
+        return static_cast<uint32_t>( _mm_movemask_epi8( _mm_cmpeq_epi8( group, _mm_set1_epi8( tag ) ) ) );
+#else
+        uint32_t mask = 0;
+        for( size_t i = 0; i < kGroupWidth; ++i )
+            if( ctrl_[ pos + i ] == tag )
+                mask |= 1u << i;
+        return mask;
+#endif
+    }
+
+    /**
+     * Bit i of the result is set if slot i of the group starting at pos is empty or deleted.
+     */
+    uint32_t matchFree( size_t pos ) const
+    {
+#ifdef __SSE2__
+        __m128i group = _mm_loadu_si128( reinterpret_cast<const __m128i *>( ctrl_ + pos ) );
+        return static_cast<uint32_t>( _mm_movemask_epi8( _mm_cmplt_epi8( group, _mm_set1_epi8( -1 ) ) ) );
+#else
+        uint32_t mask = 0;
+        for( size_t i = 0; i < kGroupWidth; ++i )
+            if( !isFull( ctrl_[ pos + i ] ) )
+                mask |= 1u << i;
+        return mask;
+#endif
+    }
+
+    static int lowestBit( uint32_t mask )
+    {
+        return __builtin_ctz( mask );
+    }
+
+    /**
+     * Internal method to locate key. Groups are visited in triangular order, which reaches every group when
+     * num_groups_ is a power of two. The probe stops at the first group that still has an empty slot.
+     * probes is incremented once per group visited.
+     * Returns the slot index of key, or kNotFound.
+     */
+    size_t findSlot( const std::string & key, int & probes ) const
+    {
+        if( num_groups_ == 0 )
+        {
+            ++probes;
+            return kNotFound;
+        }
+        size_t hash = hashOf( key );
+        int8_t tag = static_cast<int8_t>( hash & 0x7F );
+        size_t group = ( hash >> 7 ) & ( num_groups_ - 1 );
+        for( size_t step = 1; ; ++step )
+        {
+            ++probes;
+            size_t pos = group * kGroupWidth;
+            for( uint32_t mask = matchTag( pos, tag ); mask != 0; mask &= mask - 1 )
+            {
+                size_t slot = pos + lowestBit( mask );
+                if( slots_[ slot ].getRecSequence( ) == key )
+                    return slot;
+            }
+            if( matchTag( pos, kEmpty ) != 0 || step > num_groups_ )
+                return kNotFound;
+            group = ( group + step ) & ( num_groups_ - 1 );
+        }
+    }
+
+    /**
+     * Internal method to add x's acronyms to the acronym index, if there is one.
+     */
+    void indexAcronyms( const Comparable & x )
+    {
+        if( acronym_index_ != nullptr )
+            for( const std::string & acronym : x.getEnzymeAcronyms( ) )
+                acronym_index_->add( acronym, x.getRecSequence( ) );
+    }
+
+    /**
+     * Internal method to place an item whose key is known to be absent. Returns the slot it was placed in.
+     */
+    template <typename T>
+    size_t insertUnique( T && x )
+    {
+        if( ( size_ + tombstones_ + 1 ) * 8 > capacity( ) * 7 )
+            rehash( size_ * 16 >= capacity( ) * 7 ? num_groups_ * 2 : num_groups_ );
+
+        size_t hash = hashOf( x.getRecSequence( ) );
+        size_t group = ( hash >> 7 ) & ( num_groups_ - 1 );
+        for( size_t step = 1; ; ++step )
+        {
+            size_t pos = group * kGroupWidth;
+            uint32_t mask = matchFree( pos );
+            if( mask != 0 )
+            {
+                size_t slot = pos + lowestBit( mask );
+                if( ctrl_[ slot ] == kDeleted )
+                    --tombstones_;
+                ::new( static_cast<void *>( slots_ + slot ) ) Comparable{ std::forward<T>( x ) };
+                ctrl_[ slot ] = static_cast<int8_t>( hash & 0x7F );
+                ++size_;
+                return slot;
+            }
+            group = ( group + step ) & ( num_groups_ - 1 );
+        }
+    }
+
+    /**
+     * Internal method to erase the item in slot. A slot whose group still has an empty slot can become empty again,
+     * since no probe ever continued past that group; otherwise it is left as a tombstone.
+     * Returns false if slot is kNotFound.
+     */
+    bool eraseSlot( size_t slot )
+    {
+        if( slot == kNotFound )
+            return false;
+        if( acronym_index_ != nullptr )
+            for( const std::string & acronym : slots_[ slot ].getEnzymeAcronyms( ) )
+                acronym_index_->remove( acronym, slots_[ slot ].getRecSequence( ) );
+        slots_[ slot ].~Comparable( );
+        size_t pos = slot - slot % kGroupWidth;
+        if( matchTag( pos, kEmpty ) != 0 )
+            ctrl_[ slot ] = kEmpty;
+        else
+        {
+            ctrl_[ slot ] = kDeleted;
+            ++tombstones_;
+        }
+        --size_;
+        return true;
+    }
+
+    /**
+     * Internal method to move every item into a fresh table of new_groups groups (at least one).
+     * Tombstones are dropped.
+     */
+    void rehash( size_t new_groups )
+    {
+        if( new_groups == 0 )
+            new_groups = 1;
+        int8_t *old_ctrl = ctrl_;
+        Comparable *old_slots = slots_;
+        size_t old_capacity = capacity( );
+
+        num_groups_ = new_groups;
+        ctrl_ = new int8_t[ capacity( ) ];
+        slots_ = std::allocator<Comparable>{ }.allocate( capacity( ) );
+        for( size_t i = 0; i < capacity( ); ++i )
+            ctrl_[ i ] = kEmpty;
+        size_ = tombstones_ = 0;
+
+        for( size_t i = 0; i < old_capacity; ++i )
+            if( isFull( old_ctrl[ i ] ) )
+            {
+                insertUnique( std::move( old_slots[ i ] ) );
+                old_slots[ i ].~Comparable( );
+            }
+        delete [ ] old_ctrl;
+        if( old_slots != nullptr )
+            std::allocator<Comparable>{ }.deallocate( old_slots, old_capacity );
+    }
+
+    /**
+     * Internal method to release the slot arrays. All slots must already be destroyed.
+     */
+    void deallocate( )
+    {
+        delete [ ] ctrl_;
+        if( slots_ != nullptr )
+            std::allocator<Comparable>{ }.deallocate( slots_, capacity( ) );
+        ctrl_ = nullptr;
+        slots_ = nullptr;
+        num_groups_ = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,579 @@
+/*
+ Title: IndexedAvlTree.h
+ Description: AvlTree<Comparable, IndexedNodes>, an AVL tree whose nodes live in one contiguous vector. Children are
+        32-bit indices instead of 64-bit pointers, and the AVL balance is a 2-bit factor packed next to the right
+        index instead of an int height, so a node is the element plus 8 bytes. remove() keeps the vector dense by
+        moving the last node into the freed slot. Same interface as the pointer-based AvlTree in AvlTree.h.
+ Modifications:
+    10.19.26: insert() of an rvalue Merge()s a duplicate by move.
+ */
+#ifndef INDEXED_AVL_TREE_H
+#define INDEXED_AVL_TREE_H
+
+#include "AvlTree.h"
+#include <cstdint>
+#include <vector>
+
+// AvlTree<Comparable, IndexedNodes> class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// void insert( x )       --> Insert x; Merge() into the stored item if the key is already present
+// void remove( x )       --> Remove x
+// bool remove( x, i)     --> If x is found in tree, it is removed and call returns true.
+// bool contains( x )     --> Return true if x is present
+// void find_and_print( x)--> Prints vector associated with x if x is present
+// bool find( x, i )      --> Returns true if x is present
+// Comparable findMin( )  --> Return smallest item
+// Comparable findMax( )  --> Return largest item
+// boolean isEmpty( )     --> Return true if empty; else false
+// void makeEmpty( )      --> Remove all items
+// void printTree( )      --> Print tree in sorted order
+// int count_Nodes( )     --> Return number of nodes
+// int calculate_IPL()    --> Return Internal Path Length
+// int calculate_Avg_Depth()-> Return Average Depth of all Nodes
+// double calculate_ratio()-> Return Ratio of Avg Depth to log2n
+// print_Between(k1, k2)  --> prints all elements with keys between k1 and k2
+// ******************ERRORS********************************
+// Throws UnderflowException as warranted
+
+template <typename Comparable>
+class AvlTree<Comparable, IndexedNodes>
+{
+  public:
+    AvlTree( ) : root_{ kNull }
+      { }
+
+    /**
+     * Find the smallest item in the tree.
+     * Throw UnderflowException if empty.
+     */
+    const Comparable & findMin( ) const
+    {
+        if( isEmpty( ) )
+            throw UnderflowException{ };
+        uint32_t t = root_;
+        while( nodes_[ t ].left_ != kNull )
+            t = nodes_[ t ].left_;
+        return nodes_[ t ].element_;
+    }
+
+    /**
+     * Find the largest item in the tree.
+     * Throw UnderflowException if empty.
+     */
+    const Comparable & findMax( ) const
+    {
+        if( isEmpty( ) )
+            throw UnderflowException{ };
+        uint32_t t = root_;
+        while( nodes_[ t ].right_ != kNull )
+            t = nodes_[ t ].right_;
+        return nodes_[ t ].element_;
+    }
+
+    /**
+     * Returns true if x is found in the tree.
+     */
+    bool contains( const Comparable & x ) const
+    {
+        int recursion_calls = 0;
+        return findNode( x.getRecSequence( ), recursion_calls ) != kNull;
+    }
+
+    /**
+      * Post Condition: returns true if x is found. recursion_calls is updated to indicate the number of times
+      * find() is called, counted the same way as the pointer-based AvlTree.
+     */
+    bool find( const std::string & x, int & recursion_calls ) const
+    {
+        recursion_calls = 0;
+        return findNode( x, recursion_calls ) != kNull;
+    }
+
+    /**
+      * If x is located in the tree, its associated vector is printed.
+     */
+    void find_and_print( const std::string & x ) const
+    {
+        int recursion_calls = 0;
+        uint32_t t = findNode( x, recursion_calls );
+        if( t == kNull )
+            std::cout << "Not found in this tree." << std::endl;
+        else
+            nodes_[ t ].element_.Print_Vector( );
+    }
+
+    /**
+     * Test if the tree is logically empty.
+     */
+    bool isEmpty( ) const
+    {
+        return root_ == kNull;
+    }
+
+    /**
+     * Print the tree contents in sorted order.
+     */
+    void printTree( ) const
+    {
+        if( isEmpty( ) )
+            std::cout << "Empty tree" << std::endl;
+        else
+            printTree( root_ );
+        std::cout << std::endl;
+    }
+
+    /**
+     * Make the tree logically empty.
+     */
+    void makeEmpty( )
+    {
+        nodes_.clear( );
+        root_ = kNull;
+    }
+
+    /**
+     * Insert x into the tree; if the key is present, x is merged into the stored item.
+     * This function assumes all Comparables have a Merge() function.
+     */
+    void insert( const Comparable & x )
+    {
+        bool grew = false;
+        root_ = insert( x, root_, grew );
+    }
+
+    /**
+     * Insert x into the tree; if the key is present, x is merged into the stored item.
+     */
+    void insert( Comparable && x )
+    {
+        bool grew = false;
+        root_ = insert( std::move( x ), root_, grew );
+    }
+
+    /**
+     * Remove x from the tree. Nothing is done if x is not found.
+     */
+    void remove( const Comparable & x )
+    {
+        int recursion_calls = 0;
+        remove( x.getRecSequence( ), recursion_calls );
+    }
+
+    /**
+      * Remove x from the tree.
+      * Post-Condition: If x is not found, returns false. recursion_calls is updated to indicate total number of
+      * recursion calls it took to run remove().
+     */
+    bool remove( const std::string & x, int & recursion_calls )
+    {
+        recursion_calls = 0;
+        bool shrank = false;
+        uint32_t unlinked = kNull;
+        root_ = remove( x, root_, shrank, unlinked, recursion_calls );
+        if( unlinked == kNull )
+            return false;
+        fillHole( unlinked );
+        return true;
+    }
+
+    /**
+     * Returns number of nodes in tree.
+     */
+    int count_Nodes( ) const
+    {
+        return static_cast<int>( nodes_.size( ) );
+    }
+
+    /**
+      * Returns the sum of the depth of each node in a tree.
+     */
+    int calculate_IPL( ) const
+    {
+        return calculate_IPL( root_, 0 );
+    }
+
+    /**
+      * Return the average depth of the tree.
+     */
+    int calculate_Avg_Depth( ) const
+    {
+        return calculate_IPL( ) / count_Nodes( );
+    }
+
+    /**
+      * Returns the ratio of the average depth to log2n where n is the number of nodes
+     */
+    double calculate_ratio( ) const
+    {
+        int avg_depth = calculate_Avg_Depth( );
+        return avg_depth / log2( count_Nodes( ) );
+    }
+
+    /**
+      * Prints all elements in tree between the value str1 and str2.
+     */
+    void print_Between( const std::string & str1, const std::string & str2 ) const
+    {
+        print_Between( str1, str2, root_ );
+    }
+
+  private:
+    static constexpr uint32_t kNull = ( 1u << 30 ) - 1;    // Largest 30-bit index, reserved for "no child"
+
+    // Stored balance factors: height( right ) - height( left ) + 1
+    static constexpr uint32_t kLeftHeavy = 0;
+    static constexpr uint32_t kBalanced = 1;
+    static constexpr uint32_t kRightHeavy = 2;
+
+    struct IndexedNode
+    {
+        Comparable element_;
+        uint32_t   left_;
+        uint32_t   right_ : 30;
+        uint32_t   balance_ : 2;
+
+        template <typename T>
+        explicit IndexedNode( T && ele )
+          : element_{ std::forward<T>( ele ) }, left_{ kNull }, right_{ kNull }, balance_{ kBalanced } { }
+    };
+
+    std::vector<IndexedNode> nodes_;
+    uint32_t root_;
+
+    const std::string & keyOf( uint32_t t ) const
+    {
+        return nodes_[ t ].element_.getRecSequence( );
+    }
+
+    /**
+     * Internal method to locate x, counting one recursion call per node visited plus one for the null link of
+     * a miss.
+     */
+    uint32_t findNode( const std::string & x, int & recursion_calls ) const
+    {
+        uint32_t t = root_;
+        for( ; ; )
+        {
+            ++recursion_calls;
+            if( t == kNull )
+                return kNull;
+            const std::string & key = keyOf( t );
+            if( x < key )
+                t = nodes_[ t ].left_;
+            else if( key < x )
+                t = nodes_[ t ].right_;
+            else
+                return t;
+        }
+    }
+
+    /**
+     * Internal method to insert into a subtree.
+     * x is the item to insert.
+     * t is the index of the node that roots the subtree.
+     * grew is set if the subtree became taller.
+     * Returns the new root of the subtree. Children are re-read by index after each recursive call, since
+     * adding a node may reallocate nodes_.
+     */
+    template <typename T>
+    uint32_t insert( T && x, uint32_t t, bool & grew )
+    {
+        if( t == kNull )
+        {
+            nodes_.emplace_back( std::forward<T>( x ) );
+            grew = true;
+            return static_cast<uint32_t>( nodes_.size( ) - 1 );
+        }
+        if( x.getRecSequence( ) < keyOf( t ) )
+        {
+            uint32_t child = insert( std::forward<T>( x ), nodes_[ t ].left_, grew );
+            nodes_[ t ].left_ = child;
+            if( grew )
+                t = leftGrew( t, grew );
+        }
+        else if( keyOf( t ) < x.getRecSequence( ) )
+        {
+            uint32_t child = insert( std::forward<T>( x ), nodes_[ t ].right_, grew );
+            nodes_[ t ].right_ = child;
+            if( grew )
+                t = rightGrew( t, grew );
+        }
+        else
+        {
+            nodes_[ t ].element_.Merge( std::forward<T>( x ) );  // Duplicate
+            grew = false;
+        }
+        return t;
+    }
+
+    /**
+      * Internal method to remove x from a subtree while counting number of recursion calls to do so.
+      * shrank is set if the subtree became shorter. unlinked is set to the index of the node taken out of the
+      * tree, whose slot fillHole() must then reclaim.
+      * Returns the new root of the subtree.
+     */
+    uint32_t remove( const std::string & x, uint32_t t, bool & shrank, uint32_t & unlinked, int & recursion_calls )
+    {
+        ++recursion_calls;
+        if( t == kNull )
+        {
+            shrank = false;
+            return kNull;   // Item not found
+        }
+        if( x < keyOf( t ) )
+        {
+            nodes_[ t ].left_ = remove( x, nodes_[ t ].left_, shrank, unlinked, recursion_calls );
+            if( shrank )
+                t = leftShrank( t, shrank );
+        }
+        else if( keyOf( t ) < x )
+        {
+            nodes_[ t ].right_ = remove( x, nodes_[ t ].right_, shrank, unlinked, recursion_calls );
+            if( shrank )
+                t = rightShrank( t, shrank );
+        }
+        else if( nodes_[ t ].left_ != kNull && nodes_[ t ].right_ != kNull ) // Two children
+        {
+            nodes_[ t ].right_ = removeMin( nodes_[ t ].right_, shrank, unlinked, recursion_calls );
+            nodes_[ t ].element_ = std::move( nodes_[ unlinked ].element_ );
+            if( shrank )
+                t = rightShrank( t, shrank );
+        }
+        else
+        {
+            unlinked = t;
+            shrank = true;
+            return nodes_[ t ].left_ != kNull ? nodes_[ t ].left_ : static_cast<uint32_t>( nodes_[ t ].right_ );
+        }
+        return t;
+    }
+
+    /**
+     * Internal method to unlink the smallest node of a non-empty subtree. unlinked is set to its index.
+     */
+    uint32_t removeMin( uint32_t t, bool & shrank, uint32_t & unlinked, int & recursion_calls )
+    {
+        ++recursion_calls;
+        if( nodes_[ t ].left_ == kNull )
+        {
+            unlinked = t;
+            shrank = true;
+            return nodes_[ t ].right_;
+        }
+        nodes_[ t ].left_ = removeMin( nodes_[ t ].left_, shrank, unlinked, recursion_calls );
+        if( shrank )
+            t = leftShrank( t, shrank );
+        return t;
+    }
+
+    /**
+     * Internal method to reclaim the slot of an unlinked node by moving the last node of nodes_ into it and
+     * repointing the last node's parent, so nodes_ stays dense.
+     */
+    void fillHole( uint32_t hole )
+    {
+        uint32_t last = static_cast<uint32_t>( nodes_.size( ) - 1 );
+        if( hole != last )
+        {
+            const std::string & key = keyOf( last );
+            if( root_ == last )
+                root_ = hole;
+            else
+                for( uint32_t t = root_; ; )
+                    if( key < keyOf( t ) )
+                    {
+                        if( nodes_[ t ].left_ == last )
+                        {
+                            nodes_[ t ].left_ = hole;
+                            break;
+                        }
+                        t = nodes_[ t ].left_;
+                    }
+                    else
+                    {
+                        if( nodes_[ t ].right_ == last )
+                        {
+                            nodes_[ t ].right_ = hole;
+                            break;
+                        }
+                        t = nodes_[ t ].right_;
+                    }
+            nodes_[ hole ] = std::move( nodes_[ last ] );
+        }
+        nodes_.pop_back( );
+    }
+
+    // Balance maintenance. Each function is told which side of t changed height and returns the new subtree root.
+
+    /**
+     * The left subtree of t grew by one. grew stays set if t's subtree grew as well.
+     */
+    uint32_t leftGrew( uint32_t t, bool & grew )
+    {
+        if( nodes_[ t ].balance_ == kRightHeavy )
+        {
+            nodes_[ t ].balance_ = kBalanced;
+            grew = false;
+        }
+        else if( nodes_[ t ].balance_ == kBalanced )
+            nodes_[ t ].balance_ = kLeftHeavy;
+        else
+        {
+            bool reduced;
+            t = rotateLeftHeavy( t, reduced );
+            grew = false;
+        }
+        return t;
+    }
+
+    /**
+     * The right subtree of t grew by one. grew stays set if t's subtree grew as well.
+     */
+    uint32_t rightGrew( uint32_t t, bool & grew )
+    {
+        if( nodes_[ t ].balance_ == kLeftHeavy )
+        {
+            nodes_[ t ].balance_ = kBalanced;
+            grew = false;
+        }
+        else if( nodes_[ t ].balance_ == kBalanced )
+            nodes_[ t ].balance_ = kRightHeavy;
+        else
+        {
+            bool reduced;
+            t = rotateRightHeavy( t, reduced );
+            grew = false;
+        }
+        return t;
+    }
+
+    /**
+     * The left subtree of t shrank by one. shrank stays set if t's subtree shrank as well.
+     */
+    uint32_t leftShrank( uint32_t t, bool & shrank )
+    {
+        if( nodes_[ t ].balance_ == kLeftHeavy )
+            nodes_[ t ].balance_ = kBalanced;
+        else if( nodes_[ t ].balance_ == kBalanced )
+        {
+            nodes_[ t ].balance_ = kRightHeavy;
+            shrank = false;
+        }
+        else
+            t = rotateRightHeavy( t, shrank );
+        return t;
+    }
+
+    /**
+     * The right subtree of t shrank by one. shrank stays set if t's subtree shrank as well.
+     */
+    uint32_t rightShrank( uint32_t t, bool & shrank )
+    {
+        if( nodes_[ t ].balance_ == kRightHeavy )
+            nodes_[ t ].balance_ = kBalanced;
+        else if( nodes_[ t ].balance_ == kBalanced )
+        {
+            nodes_[ t ].balance_ = kLeftHeavy;
+            shrank = false;
+        }
+        else
+            t = rotateLeftHeavy( t, shrank );
+        return t;
+    }
+
+    /**
+     * t is left heavy and its left subtree just became two taller than its right (cases 1 and 2).
+     * Rotates, fixes the balance factors and sets reduced if the rotated subtree is shorter than the
+     * unbalanced one was.
+     */
+    uint32_t rotateLeftHeavy( uint32_t t, bool & reduced )
+    {
+        uint32_t k1 = nodes_[ t ].left_;
+        if( nodes_[ k1 ].balance_ != kRightHeavy )       // Single rotation
+        {
+            reduced = nodes_[ k1 ].balance_ == kLeftHeavy;
+            nodes_[ t ].left_ = nodes_[ k1 ].right_;
+            nodes_[ k1 ].right_ = t;
+            nodes_[ t ].balance_ = reduced ? kBalanced : kLeftHeavy;
+            nodes_[ k1 ].balance_ = reduced ? kBalanced : kRightHeavy;
+            return k1;
+        }
+        uint32_t k2 = nodes_[ k1 ].right_;                // Double rotation
+        nodes_[ k1 ].right_ = nodes_[ k2 ].left_;
+        nodes_[ t ].left_ = nodes_[ k2 ].right_;
+        nodes_[ k2 ].left_ = k1;
+        nodes_[ k2 ].right_ = t;
+        nodes_[ k1 ].balance_ = nodes_[ k2 ].balance_ == kRightHeavy ? kLeftHeavy : kBalanced;
+        nodes_[ t ].balance_ = nodes_[ k2 ].balance_ == kLeftHeavy ? kRightHeavy : kBalanced;
+        nodes_[ k2 ].balance_ = kBalanced;
+        reduced = true;
+        return k2;
+    }
+
+    /**
+     * Mirror image of rotateLeftHeavy() (cases 3 and 4).
+     */
+    uint32_t rotateRightHeavy( uint32_t t, bool & reduced )
+    {
+        uint32_t k1 = nodes_[ t ].right_;
+        if( nodes_[ k1 ].balance_ != kLeftHeavy )        // Single rotation
+        {
+            reduced = nodes_[ k1 ].balance_ == kRightHeavy;
+            nodes_[ t ].right_ = nodes_[ k1 ].left_;
+            nodes_[ k1 ].left_ = t;
+            nodes_[ t ].balance_ = reduced ? kBalanced : kRightHeavy;
+            nodes_[ k1 ].balance_ = reduced ? kBalanced : kLeftHeavy;
+            return k1;
+        }
+        uint32_t k2 = nodes_[ k1 ].left_;                 // Double rotation
+        nodes_[ k1 ].left_ = nodes_[ k2 ].right_;
+        nodes_[ t ].right_ = nodes_[ k2 ].left_;
+        nodes_[ k2 ].right_ = k1;
+        nodes_[ k2 ].left_ = t;
+        nodes_[ k1 ].balance_ = nodes_[ k2 ].balance_ == kLeftHeavy ? kRightHeavy : kBalanced;
+        nodes_[ t ].balance_ = nodes_[ k2 ].balance_ == kRightHeavy ? kLeftHeavy : kBalanced;
+        nodes_[ k2 ].balance_ = kBalanced;
+        reduced = true;
+        return k2;
+    }
+
+    /**
+     * Internal method to print a subtree rooted at t in sorted order.
+     */
+    void printTree( uint32_t t ) const
+    {
+        if( t != kNull )
+        {
+            printTree( nodes_[ t ].left_ );
+            std::cout << nodes_[ t ].element_ << " ";
+            printTree( nodes_[ t ].right_ );
+        }
+    }
+
+    /**
+      * Internal function to sum depth of each node in tree.
+     */
+    int calculate_IPL( uint32_t t, int depth ) const
+    {
+        if( t == kNull ) return 0;
+        else return calculate_IPL( nodes_[ t ].left_, depth + 1 ) + calculate_IPL( nodes_[ t ].right_, depth + 1 ) + depth;
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2, uint32_t t ) const
+    {
+        if( t != kNull ) {
+            const std::string & key = keyOf( t );
+            if( key > str1 )
+                print_Between( str1, str2, nodes_[ t ].left_ );
+            if( ( key > str1 ) && ( key < str2 ) )
+                std::cout << nodes_[ t ].element_ << " ";
+            if( key <= str2 )
+                print_Between( str1, str2, nodes_[ t ].right_ );
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,607 @@
+/*
+ Title: InlineKeyAvlTree.h
+ Description: An AVL tree with the same interface as AvlTree but a cache-conscious node layout. Each node is one
+        64 byte cache line holding the first 32 bytes of the key (zero padded), the child pointers and the height.
+        The element itself (key and enzyme acronyms) lives in a separately allocated "cold" record that is only
+        touched on a hit, or when two keys longer than 32 bytes share their first 32 bytes. A comparison is two
+        16 byte SIMD compares on data already in the node, instead of a pointer chase into a std::string buffer.
+        Assumes keys contain no '\0' bytes, so that zero padding orders a key before its extensions.
+ Modifications:
+    10.19.26: insert() of an rvalue Merge()s a duplicate by move.
+ */
+#ifndef INLINE_KEY_AVL_TREE_H
+#define INLINE_KEY_AVL_TREE_H
+
+#include "dsexceptions.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "SequenceMap.h"
+
+// InlineKeyAvlTree class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// void insert( x )       --> Insert x; Merge() into the stored item if the key is already present
+// bool remove( x, i)     --> If x is found in tree, it is removed and call returns true.
+// bool contains( x )     --> Return true if x is present
+// void find_and_print( x)--> Prints vector associated with x if x is present
+// bool find( x, i )      --> Returns true if x is present
+// Comparable findMin( )  --> Return smallest item
+// Comparable findMax( )  --> Return largest item
+// boolean isEmpty( )     --> Return true if empty; else false
+// void makeEmpty( )      --> Remove all items
+// void printTree( )      --> Print tree in sorted order
+// int count_Nodes( )     --> Return number of nodes
+// int calculate_IPL()    --> Return Internal Path Length
+// int calculate_Avg_Depth()-> Return Average Depth of all Nodes
+// double calculate_ratio()-> Return Ratio of Avg Depth to log2n
+// print_Between(k1, k2)  --> prints all elements with keys between k1 and k2
+// ******************ERRORS********************************
+// Throws UnderflowException as warranted
+
+template <typename Comparable>
+class InlineKeyAvlTree
+{
+  public:
+    InlineKeyAvlTree( ) : root_{ nullptr }
+      { }
+
+    InlineKeyAvlTree( const InlineKeyAvlTree & rhs ) : root_{ nullptr }
+    {
+        root_ = clone( rhs.root_ );
+    }
+
+    InlineKeyAvlTree( InlineKeyAvlTree && rhs ) : root_{ rhs.root_ }
+    {
+        rhs.root_ = nullptr;
+    }
+
+    ~InlineKeyAvlTree( )
+    {
+        makeEmpty( );
+    }
+
+    /**
+     * Deep copy.
+     */
+    InlineKeyAvlTree & operator=( const InlineKeyAvlTree & rhs )
+    {
+        InlineKeyAvlTree copy = rhs;
+        std::swap( *this, copy );
+        return *this;
+    }
+
+    /**
+     * Move.
+     */
+    InlineKeyAvlTree & operator=( InlineKeyAvlTree && rhs )
+    {
+        std::swap( root_, rhs.root_ );
+        return *this;
+    }
+
+    /**
+     * Find the smallest item in the tree.
+     * Throw UnderflowException if empty.
+     */
+    const Comparable & findMin( ) const
+    {
+        if( isEmpty( ) )
+            throw UnderflowException{ };
+        return *findMin( root_ )->cold_;
+    }
+
+    /**
+     * Find the largest item in the tree.
+     * Throw UnderflowException if empty.
+     */
+    const Comparable & findMax( ) const
+    {
+        if( isEmpty( ) )
+            throw UnderflowException{ };
+        InlineNode *t = root_;
+        while( t->right_ != nullptr )
+            t = t->right_;
+        return *t->cold_;
+    }
+
+    /**
+     * Returns true if x is found in the tree.
+     */
+    bool contains( const Comparable & x ) const
+    {
+        int recursion_calls = 0;
+        return find( x.getRecSequence( ), recursion_calls );
+    }
+
+    /**
+      * This is specific to an object T with a string data member that can be retrieved using getRecSequence().
+      * Post Condition: returns true if x is found. recursion_calls is updated to indicate the number of times
+      * find() is called, counted the same way as AvlTree::find().
+     */
+    bool find( const std::string & x, int & recursion_calls ) const
+    {
+        recursion_calls = 0;
+        SearchKey key{ x };
+        return findNode( key, recursion_calls ) != nullptr;
+    }
+
+    /**
+      * If x is located in the tree, its associated vector is printed.
+     */
+    void find_and_print( const std::string & x ) const
+    {
+        int recursion_calls = 0;
+        SearchKey key{ x };
+        InlineNode *t = findNode( key, recursion_calls );
+        if( t == nullptr )
+            std::cout << "Not found in this tree." << std::endl;
+        else
+            t->cold_->Print_Vector( );
+    }
+
+    /**
+     * Test if the tree is logically empty.
+     */
+    bool isEmpty( ) const
+    {
+        return root_ == nullptr;
+    }
+
+    /**
+     * Print the tree contents in sorted order.
+     */
+    void printTree( ) const
+    {
+        if( isEmpty( ) )
+            std::cout << "Empty tree" << std::endl;
+        else
+            printTree( root_ );
+        std::cout << std::endl;
+    }
+
+    /**
+     * Make the tree logically empty.
+     */
+    void makeEmpty( )
+    {
+        makeEmpty( root_ );
+    }
+
+    /**
+     * Insert x into the tree; if the key is present, x is merged into the stored item.
+     * This function assumes all Comparables have a Merge() function.
+     */
+    void insert( const Comparable & x )
+    {
+        SearchKey key{ x.getRecSequence( ) };
+        insert( x, key, root_ );
+    }
+
+    /**
+     * Insert x into the tree; if the key is present, x is merged into the stored item.
+     */
+    void insert( Comparable && x )
+    {
+        SearchKey key{ x.getRecSequence( ) };
+        insert( std::move( x ), key, root_ );
+    }
+
+    /**
+     * Remove x from the tree. Nothing is done if x is not found.
+     */
+    void remove( const Comparable & x )
+    {
+        int recursion_calls = 0;
+        remove( x.getRecSequence( ), recursion_calls );
+    }
+
+    /**
+      * Remove x from the tree.
+      * Post-Condition: If x is not found, returns false. recursion_calls is updated to indicate total number of
+      * recursion calls it took to run remove().
+     */
+    bool remove( const std::string & x, int & recursion_calls )
+    {
+        recursion_calls = 0;
+        SearchKey key{ x };
+        return remove( key, root_, recursion_calls );
+    }
+
+    int heightOfTree( ) const
+    {
+        return heightOfNode( root_ );
+    }
+
+    /**
+     * Returns number of nodes in tree.
+     */
+    int count_Nodes( ) const
+    {
+        return count_Nodes( root_ );
+    }
+
+    /**
+      * Returns the sum of the depth of each node in a tree.
+     */
+    int calculate_IPL( ) const
+    {
+        return calculate_IPL( root_, 0 );
+    }
+
+    /**
+      * Return the average depth of the tree.
+     */
+    int calculate_Avg_Depth( ) const
+    {
+        return calculate_IPL( ) / count_Nodes( );
+    }
+
+    /**
+      * Returns the ratio of the average depth to log2n where n is the number of nodes
+     */
+    double calculate_ratio( ) const
+    {
+        int avg_depth = calculate_Avg_Depth( );
+        return avg_depth / log2( count_Nodes( ) );
+    }
+
+    /**
+      * Prints all elements in tree between the value str1 and str2.
+     */
+    void print_Between( const std::string & str1, const std::string & str2 ) const
+    {
+        print_Between( str1, str2, root_ );
+    }
+
+  private:
+    static const size_t kInlineKeyBytes = 32;
+
+    /**
+     * One cache line: the key prefix and the search metadata. The payload is behind cold_.
+     */
+    struct alignas( 64 ) InlineNode
+    {
+        char         key_[ kInlineKeyBytes ];   // First kInlineKeyBytes of the key, zero padded
+        InlineNode  *left_;
+        InlineNode  *right_;
+        Comparable  *cold_;                     // The element; only dereferenced on a hit or a long-key tie
+        int32_t      height_;
+        uint32_t     key_size_;                 // Full key length; > kInlineKeyBytes means the prefix is truncated
+
+        InlineNode( Comparable *cold, InlineNode *lt, InlineNode *rt, int h = 0 )
+          : left_{ lt }, right_{ rt }, cold_{ cold }, height_{ h }
+        {
+            setKey( cold_->getRecSequence( ) );
+        }
+
+        void setKey( const std::string & key )
+        {
+            std::memset( key_, 0, kInlineKeyBytes );
+            std::memcpy( key_, key.data( ), key.size( ) < kInlineKeyBytes ? key.size( ) : kInlineKeyBytes );
+            key_size_ = static_cast<uint32_t>( key.size( ) );
+        }
+    };
+
+    /**
+     * A search key laid out like a node's key bytes, built once per operation.
+     */
+    struct SearchKey
+    {
+        alignas( 16 ) char prefix_[ kInlineKeyBytes ];
+        const std::string *full_;
+
+        explicit SearchKey( const std::string & key ) : full_{ &key }
+        {
+            std::memset( prefix_, 0, kInlineKeyBytes );
+            std::memcpy( prefix_, key.data( ), key.size( ) < kInlineKeyBytes ? key.size( ) : kInlineKeyBytes );
+        }
+    };
+
+    InlineNode *root_;
+
+    /**
+     * Returns <0, 0 or >0 as the first kInlineKeyBytes of a compare to those of b.
+     */
+    static int comparePrefix( const char *a, const char *b )
+    {
+#ifdef __SSE2__
+        for( size_t offset = 0; offset < kInlineKeyBytes; offset += 16 )
+        {
+            __m128i lhs = _mm_loadu_si128( reinterpret_cast<const __m128i *>( a + offset ) );
+            __m128i rhs = _mm_loadu_si128( reinterpret_cast<const __m128i *>( b + offset ) );
+            unsigned int diff = ~static_cast<unsigned int>( _mm_movemask_epi8( _mm_cmpeq_epi8( lhs, rhs ) ) ) & 0xFFFFu;
+            if( diff != 0 )
+            {
+                size_t i = offset + __builtin_ctz( diff );
+                return static_cast<unsigned char>( a[ i ] ) - static_cast<unsigned char>( b[ i ] );
+            }
+        }
+        return 0;
+#else
+        return std::memcmp( a, b, kInlineKeyBytes );
+#endif
+    }
+
+    /**
+     * Returns <0, 0 or >0 as key orders before, equal to, or after the key of node t.
+     * Only touches t's cold record if both keys agree on all inline bytes and one of them is longer.
+     */
+    static int compare( const SearchKey & key, const InlineNode *t )
+    {
+        int result = comparePrefix( key.prefix_, t->key_ );
+        if( result != 0 || ( key.full_->size( ) <= kInlineKeyBytes && t->key_size_ <= kInlineKeyBytes ) )
+            return result;
+        return key.full_->compare( t->cold_->getRecSequence( ) );
+    }
+
+    /**
+     * Internal method to locate key, counting one recursion call per node visited plus one for the null link
+     * of a miss, as AvlTree::find() does.
+     */
+    InlineNode * findNode( const SearchKey & key, int & recursion_calls ) const
+    {
+        InlineNode *t = root_;
+        for( ; ; )
+        {
+            ++recursion_calls;
+            if( t == nullptr )
+                return nullptr;
+            int cmp = compare( key, t );
+            if( cmp < 0 )
+                t = t->left_;
+            else if( cmp > 0 )
+                t = t->right_;
+            else
+                return t;
+        }
+    }
+
+    /**
+     * Internal method to insert into a subtree.
+     * x is the item to insert and key its search key.
+     * t is the node that roots the subtree.
+     */
+    template <typename T>
+    void insert( T && x, const SearchKey & key, InlineNode * & t )
+    {
+        if( t == nullptr )
+        {
+            t = new InlineNode{ new Comparable{ std::forward<T>( x ) }, nullptr, nullptr };
+            return;
+        }
+        int cmp = compare( key, t );
+        if( cmp < 0 )
+            insert( std::forward<T>( x ), key, t->left_ );
+        else if( cmp > 0 )
+            insert( std::forward<T>( x ), key, t->right_ );
+        else
+        {
+            t->cold_->Merge( std::forward<T>( x ) );  // Duplicate
+            return;
+        }
+        balance( t );
+    }
+
+    /**
+      * Internal method to remove key from subtree while counting number of recursion calls to do so.
+     */
+    bool remove( const SearchKey & key, InlineNode * & t, int & recursion_calls )
+    {
+        ++recursion_calls;
+        if( t == nullptr )
+            return false;   // Item not found
+        int cmp = compare( key, t );
+        bool removed = true;
+        if( cmp < 0 )
+            removed = remove( key, t->left_, recursion_calls );
+        else if( cmp > 0 )
+            removed = remove( key, t->right_, recursion_calls );
+        else if( t->left_ != nullptr && t->right_ != nullptr ) // Two children
+        {
+            InlineNode *successor = findMin( t->right_ );
+            delete t->cold_;
+            t->cold_ = successor->cold_;
+            t->setKey( t->cold_->getRecSequence( ) );
+            successor->cold_ = nullptr;
+            removeMin( t->right_, recursion_calls );
+        }
+        else
+        {
+            InlineNode *oldNode = t;
+            t = ( t->left_ != nullptr ) ? t->left_ : t->right_;
+            delete oldNode->cold_;
+            delete oldNode;
+            return true;
+        }
+        balance( t );
+        return removed;
+    }
+
+    /**
+     * Internal method to unlink the smallest node of a non-empty subtree. Its cold record has already been
+     * handed to another node.
+     */
+    void removeMin( InlineNode * & t, int & recursion_calls )
+    {
+        ++recursion_calls;
+        if( t->left_ == nullptr )
+        {
+            InlineNode *oldNode = t;
+            t = t->right_;
+            delete oldNode;
+            return;
+        }
+        removeMin( t->left_, recursion_calls );
+        balance( t );
+    }
+
+    static const int ALLOWED_IMBALANCE = 1;
+
+    // Assume t is balanced or within one of being balanced
+    void balance( InlineNode * & t )
+    {
+        if( t == nullptr )
+            return;
+
+        if( heightOfNode( t->left_ ) - heightOfNode( t->right_ ) > ALLOWED_IMBALANCE ) {
+            if( heightOfNode( t->left_->left_ ) >= heightOfNode( t->left_->right_ ) )
+                rotateWithLeftChild( t );
+            else
+                doubleWithLeftChild( t );
+        } else if( heightOfNode( t->right_ ) - heightOfNode( t->left_ ) > ALLOWED_IMBALANCE ) {
+            if( heightOfNode( t->right_->right_ ) >= heightOfNode( t->right_->left_ ) )
+                rotateWithRightChild( t );
+            else
+                doubleWithRightChild( t );
+        }
+        t->height_ = max( heightOfNode( t->left_ ), heightOfNode( t->right_ ) ) + 1;
+    }
+
+    /**
+     * Internal method to find the smallest item in a subtree t.
+     */
+    InlineNode * findMin( InlineNode *t ) const
+    {
+        if( t != nullptr )
+            while( t->left_ != nullptr )
+                t = t->left_;
+        return t;
+    }
+
+    /**
+     * Internal method to make subtree empty.
+     */
+    void makeEmpty( InlineNode * & t )
+    {
+        if( t != nullptr )
+        {
+            makeEmpty( t->left_ );
+            makeEmpty( t->right_ );
+            delete t->cold_;
+            delete t;
+        }
+        t = nullptr;
+    }
+
+    /**
+     * Internal method to print a subtree rooted at t in sorted order.
+     */
+    void printTree( InlineNode *t ) const
+    {
+        if( t != nullptr )
+        {
+            printTree( t->left_ );
+            std::cout << *t->cold_ << " ";
+            printTree( t->right_ );
+        }
+    }
+
+    /**
+     * Internal method to clone subtree.
+     */
+    InlineNode * clone( InlineNode *t ) const
+    {
+        if( t == nullptr )
+            return nullptr;
+        else
+            return new InlineNode{ new Comparable{ *t->cold_ }, clone( t->left_ ), clone( t->right_ ), t->height_ };
+    }
+
+    /**
+     * Return the height of node t or -1 if nullptr.
+     */
+    int heightOfNode( InlineNode *t ) const
+    {
+        return t == nullptr ? -1 : t->height_;
+    }
+
+    int max( int lhs, int rhs ) const
+    {
+        return lhs > rhs ? lhs : rhs;
+    }
+
+    /**
+     * Rotate binary tree node with left child.
+     */
+    void rotateWithLeftChild( InlineNode * & k2 )
+    {
+        InlineNode *k1 = k2->left_;
+        k2->left_ = k1->right_;
+        k1->right_ = k2;
+        k2->height_ = max( heightOfNode( k2->left_ ), heightOfNode( k2->right_ ) ) + 1;
+        k1->height_ = max( heightOfNode( k1->left_ ), k2->height_ ) + 1;
+        k2 = k1;
+    }
+
+    /**
+     * Rotate binary tree node with right child.
+     */
+    void rotateWithRightChild( InlineNode * & k1 )
+    {
+        InlineNode *k2 = k1->right_;
+        k1->right_ = k2->left_;
+        k2->left_ = k1;
+        k1->height_ = max( heightOfNode( k1->left_ ), heightOfNode( k1->right_ ) ) + 1;
+        k2->height_ = max( heightOfNode( k2->right_ ), k1->height_ ) + 1;
+        k1 = k2;
+    }
+
+    /**
+     * Double rotate binary tree node: first left child with its right child; then node k3 with new left child.
+     */
+    void doubleWithLeftChild( InlineNode * & k3 )
+    {
+        rotateWithRightChild( k3->left_ );
+        rotateWithLeftChild( k3 );
+    }
+
+    /**
+     * Double rotate binary tree node: first right child with its left child; then node k1 with new right child.
+     */
+    void doubleWithRightChild( InlineNode * & k1 )
+    {
+        rotateWithLeftChild( k1->right_ );
+        rotateWithRightChild( k1 );
+    }
+
+    /**
+     * Internal function to count nodes.
+     */
+    int count_Nodes( InlineNode *t ) const
+    {
+        if( t != nullptr ) return count_Nodes( t->left_ ) + count_Nodes( t->right_ ) + 1;
+        else return 0;
+    }
+
+    /**
+      * Internal function to sum depth of each node in tree.
+     */
+    int calculate_IPL( InlineNode *t, int depth ) const
+    {
+        if( t == nullptr ) return 0;
+        else return calculate_IPL( t->left_, depth + 1 ) + calculate_IPL( t->right_, depth + 1 ) + depth;
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2, const InlineNode *t ) const
+    {
+        if( t != nullptr ) {
+            const std::string & key = t->cold_->getRecSequence( );
+            if( key > str1 )
+                print_Between( str1, str2, t->left_ );
+            if( ( key > str1 ) && ( key < str2 ) )
+                std::cout << *t->cold_ << " ";
+            if( key <= str2 )
+                print_Between( str1, str2, t->right_ );
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,399 @@
+/*
+ Title: LearnedIndex.h
+ Description: A read-only index over a frozen, sorted array of an AvlTree's elements that replaces the ~20-level
+        pointer chase of a tree lookup with a learned model of where each key sits in the array.
+        Keys are packed into 64-bit integers that sort as the strings do: every character of the keys is given a
+        code from 1 up in character order, as few bits as the alphabet needs, and the first 64 / bits characters
+        are packed high to low, with 0 past the end. For the recognition sequences (12 characters, 4 bits, keys
+        of at most 15) the packing is exact, so a hit is confirmed without reading the string.
+        The model has two stages, as in RadixSpline: a radix table on the top bits of the packed key narrows the
+        search to a few knots of a linear spline, and the spline maps the key to a position. The knots are chosen
+        greedily so that every key's predicted position is within max_error of its real one, and the error is
+        measured again after the build so that rounding cannot break the bound. A lookup evaluates the spline,
+        then counts the packed keys below its own in a window of about 2 * max_error + 4 slots around the
+        prediction, four at a time with AVX2 where the build enables it. The window scan is one or two cache
+        lines of contiguous keys and never branches on the data.
+        Nothing can be inserted or removed; build a new index from the tree to pick up changes.
+ Modifications:
+ */
+#ifndef LEARNED_INDEX_H
+#define LEARNED_INDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "AvlTree.h"
+
+// LearnedIndex class
+//
+// CONSTRUCTION: from an AvlTree, whose elements are copied in key order, and the largest error the spline may make
+//
+// ******************PUBLIC OPERATIONS*********************
+// bool find( x, i )      --> Return true if x is present; i is the number of array slots examined
+// find_Element( x )      --> Return a pointer to the element whose key is x, or nullptr
+// void find_and_print( x )--> Prints vector associated with x if x is present
+// find_and_print( x, out )-> same, written to stream out
+// print_Between( k1, k2 )--> prints all elements with keys between k1 and k2
+// print_Between( k1, k2, out )--> same, written to stream out
+// for_Each_Between( k1, k2, f )--> Calls f( element ) for the elements print_Between( k1, k2 ) would print
+// boolean isEmpty( )     --> Return true if empty; else false
+// int count_Nodes( )     --> Return number of elements
+// size_t knot_Count( )   --> Return number of spline knots
+// size_t model_Bytes( )  --> Return memory taken by the radix table and the spline
+// size_t key_Bytes( )    --> Return memory taken by the packed keys
+// size_t max_Error( )    --> Return the largest distance of a predicted position from the real one
+// ******************ERRORS********************************
+// None
+
+template <typename Comparable>
+class LearnedIndex
+{
+  public:
+    static const size_t kDefaultMaxError = 32;
+    static const int kMaxRadixBits = 20;
+
+    explicit LearnedIndex( const AvlTree<Comparable> & tree, size_t max_error = kDefaultMaxError )
+      : bits_{ 1 }, chars_{ 64 }, radix_bits_{ 0 }, shift_{ 0 }, min_key_{ 0 }, max_key_{ 0 }, error_{ 0 }
+    {
+        tree.for_Each( [ this ]( const Comparable & x ) { elements_.push_back( x ); } );
+        buildCodes( );
+        packed_.reserve( elements_.size( ) + kPadding );
+        bool unused;
+        for( const Comparable & x : elements_ )
+            packed_.push_back( pack( x.getRecSequence( ), unused ) );
+        packed_.insert( packed_.end( ), kPadding, ~uint64_t( 0 ) );
+        if( elements_.empty( ) )
+            return;
+        min_key_ = packed_.front( );
+        max_key_ = packed_[ elements_.size( ) - 1 ];
+        buildSpline( std::max( max_error, size_t( 1 ) ) );
+        buildRadix( );
+        measureError( );
+    }
+
+    bool find( const std::string & x, int & probes ) const
+    {
+        probes = 0;
+        return find_Element( x, probes ) != nullptr;
+    }
+
+    const Comparable * find_Element( const std::string & x ) const
+    {
+        int probes = 0;
+        return find_Element( x, probes );
+    }
+
+    void find_and_print( const std::string & x ) const
+    {
+        find_and_print( x, std::cout );
+    }
+
+    void find_and_print( const std::string & x, std::ostream & out ) const
+    {
+        const Comparable *found = find_Element( x );
+        if( found == nullptr )
+            out << "Not found in this tree." << std::endl;
+        else
+            found->Print_Vector( out );
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2 ) const
+    {
+        print_Between( str1, str2, std::cout );
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2, std::ostream & out ) const
+    {
+        for_Each_Between( str1, str2, [ &out ]( const Comparable & x ) { out << x << " "; } );
+    }
+
+    /**
+      * Calls visit( element ) for every element with a key strictly between str1 and str2, in key order: one
+      * lookup for str1, then a walk along the array.
+     */
+    template <typename Visit>
+    void for_Each_Between( const std::string & str1, const std::string & str2, Visit visit ) const
+    {
+        int probes = 0;
+        size_t i = lowerBound( str1, probes );
+        if( i < elements_.size( ) && elements_[ i ].getRecSequence( ) == str1 )
+            ++i;
+        for( ; i < elements_.size( ) && elements_[ i ].getRecSequence( ) < str2; ++i )
+            visit( elements_[ i ] );
+    }
+
+    bool isEmpty( ) const
+    {
+        return elements_.empty( );
+    }
+
+    int count_Nodes( ) const
+    {
+        return elements_.size( );
+    }
+
+    size_t knot_Count( ) const
+    {
+        return knots_.size( );
+    }
+
+    size_t model_Bytes( ) const
+    {
+        return knots_.size( ) * sizeof( Knot ) + radix_.size( ) * sizeof( uint32_t ) + sizeof( code_ ) + sizeof( below_ );
+    }
+
+    size_t key_Bytes( ) const
+    {
+        return packed_.size( ) * sizeof( uint64_t );
+    }
+
+    size_t max_Error( ) const
+    {
+        return error_;
+    }
+
+  private:
+    static const size_t kPadding = 4;       // ~0 keys past the end, so the window scan may read whole groups of 4
+
+    struct Knot
+    {
+        uint64_t key_;
+        double position_;
+        double slope_;          // Positions per unit of key up to the next knot; 0 for the last
+    };
+
+    std::vector<Comparable> elements_;
+    std::vector<uint64_t> packed_;          // elements_' keys packed, then kPadding ~0s
+    uint8_t code_[ 256 ];                   // Each character's code, 0 if no key holds it
+    uint8_t below_[ 256 ];                  // The code of the highest character below it that some key holds
+    int bits_;                              // Bits per character
+    size_t chars_;                          // Characters packed
+    std::vector<Knot> knots_;
+    std::vector<uint32_t> radix_;           // radix_[ b ] is the first knot whose key has top bits b or more
+    int radix_bits_;
+    int shift_;                             // ( key - min_key_ ) >> shift_ is the key's top radix_bits_ bits
+    uint64_t min_key_;
+    uint64_t max_key_;
+    size_t error_;                          // Largest measured distance of a prediction from the real position
+
+    /**
+     * Internal method to give the characters the keys use codes 1, 2, ... in character order, and to pick the
+     * fewest bits that hold them.
+     */
+    void buildCodes( )
+    {
+        bool seen[ 256 ] = { };
+        for( const Comparable & x : elements_ )
+            for( unsigned char c : x.getRecSequence( ) )
+                seen[ c ] = true;
+        int next = 0;
+        for( int c = 0; c < 256; ++c )
+        {
+            below_[ c ] = next;
+            code_[ c ] = seen[ c ] ? ++next : 0;
+        }
+        while( ( 1 << bits_ ) <= next )
+            ++bits_;
+        chars_ = 64 / bits_;
+    }
+
+    /**
+     * Internal method to pack key x so that packed keys compare as the strings do, ties aside. exact is set if
+     * the packing is one-to-one on x, that is if x is shorter than chars_ and all its characters have codes;
+     * only then does an equal packed key mean an equal string. A character no key holds is packed as the highest
+     * one below it followed by all ones, or, with none below it, as the end of the key.
+     */
+    uint64_t pack( const std::string & x, bool & exact ) const
+    {
+        uint64_t packed = 0;
+        int shift = 64;
+        exact = x.size( ) < chars_;
+        for( size_t i = 0; i < x.size( ) && i < chars_; ++i )
+        {
+            unsigned char c = x[ i ];
+            shift -= bits_;
+            if( code_[ c ] != 0 )
+            {
+                packed |= uint64_t( code_[ c ] ) << shift;
+                continue;
+            }
+            exact = false;
+            if( below_[ c ] == 0 )
+                return packed;
+            packed |= uint64_t( below_[ c ] ) << shift;
+            return shift == 0 ? packed : packed | ( ( uint64_t( 1 ) << shift ) - 1 );
+        }
+        return packed;
+    }
+
+    /**
+     * Internal method to fit the spline to the first position of each distinct packed key, as in GreedySpline-
+     * Corridor: extend the current segment while a line from its first knot can pass within max_error of every
+     * point so far, and start a new one at the last point that fit when it cannot.
+     */
+    void buildSpline( size_t max_error )
+    {
+        double error = max_error;
+        std::vector<std::pair<uint64_t, double> > points;
+        for( size_t i = 0; i < elements_.size( ); ++i )
+            if( i == 0 || packed_[ i ] != packed_[ i - 1 ] )
+                points.emplace_back( packed_[ i ], double( i ) );
+        auto slope = [ ]( const std::pair<uint64_t, double> & from, uint64_t key, double position )
+            { return ( position - from.second ) / double( key - from.first ); };
+
+        std::pair<uint64_t, double> base = points[ 0 ];
+        knots_.push_back( Knot{ base.first, base.second, 0 } );
+        double upper = 0, lower = 0;
+        for( size_t i = 1; i < points.size( ); ++i )
+        {
+            const std::pair<uint64_t, double> & point = points[ i ];
+            if( points[ i - 1 ] != base )
+            {
+                double to_point = slope( base, point.first, point.second );
+                if( to_point <= upper && to_point >= lower )
+                {
+                    upper = std::min( upper, slope( base, point.first, point.second + error ) );
+                    lower = std::max( lower, slope( base, point.first, point.second - error ) );
+                    continue;
+                }
+                base = points[ i - 1 ];
+                knots_.push_back( Knot{ base.first, base.second, 0 } );
+            }
+            upper = slope( base, point.first, point.second + error );
+            lower = slope( base, point.first, point.second - error );
+        }
+        if( points.back( ) != base )
+            knots_.push_back( Knot{ points.back( ).first, points.back( ).second, 0 } );
+        for( size_t k = 0; k + 1 < knots_.size( ); ++k )
+            knots_[ k ].slope_ = ( knots_[ k + 1 ].position_ - knots_[ k ].position_ )
+                                 / double( knots_[ k + 1 ].key_ - knots_[ k ].key_ );
+    }
+
+    /**
+     * Internal method to build the radix table, with about one entry per knot.
+     */
+    void buildRadix( )
+    {
+        radix_bits_ = 1;
+        while( radix_bits_ < kMaxRadixBits && ( size_t( 1 ) << radix_bits_ ) < knots_.size( ) )
+            ++radix_bits_;
+        int range_bits = 0;
+        while( range_bits < 64 && ( ( max_key_ - min_key_ ) >> range_bits ) != 0 )
+            ++range_bits;
+        shift_ = std::max( range_bits - radix_bits_, 0 );
+        radix_.assign( ( size_t( 1 ) << radix_bits_ ) + 1, uint32_t( knots_.size( ) ) );
+        for( size_t k = knots_.size( ); k-- > 0; )
+            radix_[ ( knots_[ k ].key_ - min_key_ ) >> shift_ ] = k;
+        for( size_t b = radix_.size( ) - 1; b-- > 0; )
+            radix_[ b ] = std::min( radix_[ b ], radix_[ b + 1 ] );
+    }
+
+    /**
+     * Internal method to set error_ to the largest distance of the model's prediction from the first position of
+     * each distinct packed key, as evaluated by lookups, rounding included.
+     */
+    void measureError( )
+    {
+        double worst = 0;
+        for( size_t i = 0; i < elements_.size( ); ++i )
+            if( i == 0 || packed_[ i ] != packed_[ i - 1 ] )
+                worst = std::max( worst, std::fabs( predict( packed_[ i ] ) - double( i ) ) );
+        error_ = size_t( std::ceil( worst ) );
+    }
+
+    /**
+     * Internal method to return the model's position for packed key key, which lies between min_key_ and
+     * max_key_.
+     */
+    double predict( uint64_t key ) const
+    {
+        size_t bucket = ( key - min_key_ ) >> shift_;
+        auto first = knots_.begin( ) + radix_[ bucket ], last = knots_.begin( ) + radix_[ bucket + 1 ];
+        auto next = std::upper_bound( first, last, key, [ ]( uint64_t k, const Knot & knot ) { return k < knot.key_; } );
+        const Knot & knot = next == knots_.begin( ) ? knots_.front( ) : *( next - 1 );
+        return knot.position_ + double( key - knot.key_ ) * knot.slope_;
+    }
+
+    /**
+     * Internal method to return the number of packed keys below key in slots first .. last - 1, counting whole
+     * groups of four past last, which the sorted order and the padding make harmless.
+     */
+    size_t countBelow( size_t first, size_t last, uint64_t key ) const
+    {
+        size_t count = 0;
+#ifdef __AVX2__
+        const __m256i flip = _mm256_set1_epi64x( int64_t( uint64_t( 1 ) << 63 ) );
+        const __m256i probe = _mm256_xor_si256( _mm256_set1_epi64x( int64_t( key ) ), flip );
+        for( size_t i = first; i < last; i += 4 )
+        {
+            __m256i keys = _mm256_xor_si256( _mm256_loadu_si256( reinterpret_cast<const __m256i *>( &packed_[ i ] ) ), flip );
+            count += __builtin_popcount( _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpgt_epi64( probe, keys ) ) ) );
+        }
+#else
+        for( size_t i = first; i < last; ++i )
+            count += packed_[ i ] < key;
+#endif
+        return count;
+    }
+
+    /**
+     * Internal method to return the first slot whose packed key is not below key's: the model's window is counted,
+     * and the whole array searched in the rare case the count shows the answer lies outside it.
+     */
+    size_t lowerBoundPacked( uint64_t key, int & probes ) const
+    {
+        size_t n = elements_.size( );
+        if( n == 0 || key <= min_key_ )
+            return 0;
+        if( key > max_key_ )
+            return n;
+        double predicted = std::max( predict( key ), 0.0 );
+        size_t reach = error_ + 2;
+        size_t first = predicted > double( reach ) ? size_t( predicted ) - reach : 0;
+        size_t last = std::min( size_t( predicted ) + reach + 1, n );
+        size_t found = first + countBelow( first, last, key );
+        probes += last - first;
+        if( ( found == first && first > 0 && packed_[ first - 1 ] >= key ) || ( found >= last && found < n && packed_[ found ] < key ) )
+            return std::lower_bound( packed_.begin( ), packed_.begin( ) + n, key ) - packed_.begin( );
+        return found;
+    }
+
+    /**
+     * Internal method to return the first slot whose key is not below x.
+     */
+    size_t lowerBound( const std::string & x, int & probes ) const
+    {
+        bool exact;
+        uint64_t key = pack( x, exact );
+        size_t i = lowerBoundPacked( key, probes );
+        if( !exact )
+            while( i < elements_.size( ) && packed_[ i ] == key && elements_[ i ].getRecSequence( ) < x )
+            {
+                ++i;
+                ++probes;
+            }
+        return i;
+    }
+
+    const Comparable * find_Element( const std::string & x, int & probes ) const
+    {
+        bool exact;
+        uint64_t key = pack( x, exact );
+        size_t i = lowerBoundPacked( key, probes );
+        if( exact )
+            return i < elements_.size( ) && packed_[ i ] == key ? &elements_[ i ] : nullptr;
+        for( ; i < elements_.size( ) && packed_[ i ] == key; ++i, ++probes )
+            if( elements_[ i ].getRecSequence( ) == x )
+                return &elements_[ i ];
+        return nullptr;
+    }
+};
+
+#endif
@@ -0,0 +1,501 @@
+/*
+ Title: LockFreeSkipList.h
+ Description: A lock-free skip list of elements keyed by recognition sequence, for workloads where many threads
+        insert, remove and search at once. No operation takes a lock: the links are changed with compare-and-swap,
+        and a thread that loses a race retries instead of waiting, so a stalled thread never blocks the others.
+        Removal is logical, then physical: remove( ) marks the node's links, bottom level last, and the thread that
+        marks the bottom level owns the removal; every traversal that meets a marked node unlinks it. find( ) only
+        reads. Each node's element is immutable once published; insert( ) of a key that is already present copies
+        the element, Merge( )s into the copy and swaps it in with compare-and-swap, so concurrent merges into one
+        key all take effect and a reader always sees a whole element.
+        Unlinked nodes and replaced elements are freed through an EpochReclaimer once no thread can still hold
+        them. A node is retired by whichever of its inserter and its remover finishes last, since an insert( ) still
+        linking the upper levels of its node could otherwise link it back after the remover's clean-up.
+        print_Between( ) and count_Nodes( ) walk the bottom level and are weakly consistent: they see every element
+        present throughout the walk and none that was absent throughout, and may or may not see those that came or
+        went meanwhile. makeEmpty( ) and the destructor require that no other thread is using the list.
+        Levels are drawn with probability 1/4 per level, so a node has 1.33 links on average.
+ Modifications:
+ */
+#ifndef LOCK_FREE_SKIP_LIST_H
+#define LOCK_FREE_SKIP_LIST_H
+
+#include "EpochReclaimer.h"
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <new>
+#include <string>
+#include <utility>
+
+// LockFreeSkipList class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// void insert( x )       --> Insert x, or Merge( ) it into the element with the same key; thread-safe
+// bool remove( x, i )    --> Remove the element whose key is x; i is the number of nodes visited; thread-safe
+// bool find( x, i )      --> Return true if x is present; i is the number of nodes visited; lock-free, read-only
+// void find_and_print( x )--> Prints vector associated with x if x is present
+// find_and_print( x, out )-> same, written to stream out
+// for_Each_Between( k1, k2, v )--> Call v( element ) for the elements with keys between k1 and k2, in key order
+// print_Between( k1, k2 )--> prints all elements with keys between k1 and k2
+// print_Between( k1, k2, out )--> same, written to stream out
+// boolean isEmpty( )     --> Return true if empty; else false
+// void makeEmpty( )      --> Remove all items; not thread-safe
+// void printTree( )      --> Print the elements in sorted order
+// int count_Nodes( )     --> Return number of elements
+// int heightOfTree( )    --> Return number of levels in use
+// int calculate_IPL( )   --> Return sum over all elements of the nodes find( ) visits to reach them
+// int calculate_Avg_Depth( )-> Return average number of nodes find( ) visits to reach an element
+// double calculate_ratio( )-> Return Ratio of Avg Depth to log2n
+// ******************ERRORS********************************
+// None
+
+template <typename Comparable>
+class LockFreeSkipList
+{
+  public:
+    static const int kMaxLevel = 16;            // Enough for 4^16 elements
+
+    LockFreeSkipList( ) : head_{ newNode( std::string{ }, nullptr, kMaxLevel ) }, levels_{ 1 }
+      { }
+
+    LockFreeSkipList( const LockFreeSkipList & rhs ) = delete;
+    LockFreeSkipList & operator=( const LockFreeSkipList & rhs ) = delete;
+
+    ~LockFreeSkipList( )
+    {
+        makeEmpty( );
+        deleteNode( head_ );
+    }
+
+    void insert( const Comparable & x )
+    {
+        insert( new Comparable{ x } );
+    }
+
+    void insert( Comparable && x )
+    {
+        insert( new Comparable{ std::move( x ) } );
+    }
+
+    /**
+      * Marks the node with key x removed, then unlinks it. If several threads remove x at once, one returns true.
+     */
+    bool remove( const std::string & x, int & recursion_calls )
+    {
+        auto guard = reclaimer_.pin( );
+        Node *preds[ kMaxLevel ], *succs[ kMaxLevel ];
+        recursion_calls = 0;
+        if( !findPosition( x, preds, succs, recursion_calls ) )
+            return false;
+        Node *victim = succs[ 0 ];
+        for( int level = victim->height_ - 1; level > 0; --level )
+        {
+            uintptr_t next = victim->next_[ level ].load( std::memory_order_acquire );
+            while( !isMarked( next ) && !victim->next_[ level ].compare_exchange_weak( next, next | 1 ) )
+                ;
+        }
+        uintptr_t next = victim->next_[ 0 ].load( std::memory_order_acquire );
+        for( ;; )
+        {
+            if( isMarked( next ) )
+                return false;           // Another remove( ) got there first
+            if( victim->next_[ 0 ].compare_exchange_weak( next, next | 1 ) )
+                break;
+        }
+        int ignored = 0;
+        findPosition( x, preds, succs, ignored );      // Unlinks victim from every level
+        dropOwner( victim );
+        return true;
+    }
+
+    bool find( const std::string & x, int & recursion_calls ) const
+    {
+        auto guard = reclaimer_.pin( );
+        recursion_calls = 0;
+        return findNode( x, recursion_calls ) != nullptr;
+    }
+
+    void find_and_print( const std::string & x ) const
+    {
+        find_and_print( x, std::cout );
+    }
+
+    void find_and_print( const std::string & x, std::ostream & out ) const
+    {
+        auto guard = reclaimer_.pin( );
+        int recursion_calls = 0;
+        const Node *found = findNode( x, recursion_calls );
+        if( found == nullptr )
+            out << "Not found in this tree." << std::endl;
+        else
+            found->element_.load( std::memory_order_acquire )->Print_Vector( out );
+    }
+
+    /**
+      * Calls visit( element ) for the elements with keys strictly between str1 and str2, in key order. visit must not
+      * keep the reference past its return, and should be quick, since the calling thread stays pinned throughout.
+     */
+    template <typename Visit>
+    void for_Each_Between( const std::string & str1, const std::string & str2, Visit visit ) const
+    {
+        auto guard = reclaimer_.pin( );
+        int visited = 0;
+        const Node *pred = lowerBound( str1, visited );
+        for( const Node *t = pointer( pred->next_[ 0 ].load( std::memory_order_acquire ) ); t != nullptr;
+             t = pointer( t->next_[ 0 ].load( std::memory_order_acquire ) ) )
+        {
+            if( !( t->key_ < str2 ) )
+                break;
+            if( str1 < t->key_ && !isMarked( t->next_[ 0 ].load( std::memory_order_acquire ) ) )
+                visit( *t->element_.load( std::memory_order_acquire ) );
+        }
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2 ) const
+    {
+        print_Between( str1, str2, std::cout );
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2, std::ostream & out ) const
+    {
+        for_Each_Between( str1, str2, [ &out ]( const Comparable & x ) { out << x << " "; } );
+    }
+
+    bool isEmpty( ) const
+    {
+        auto guard = reclaimer_.pin( );
+        return firstLive( ) == nullptr;
+    }
+
+    /**
+      * Pre-Condition: no other thread is using the list.
+     */
+    void makeEmpty( )
+    {
+        Node *t = pointer( head_->next_[ 0 ].load( std::memory_order_relaxed ) );
+        while( t != nullptr )
+        {
+            Node *next = pointer( t->next_[ 0 ].load( std::memory_order_relaxed ) );
+            deleteNode( t );
+            t = next;
+        }
+        for( int level = 0; level < kMaxLevel; ++level )
+            head_->next_[ level ].store( 0, std::memory_order_relaxed );
+        levels_.store( 1, std::memory_order_relaxed );
+    }
+
+    void printTree( ) const
+    {
+        if( isEmpty( ) )
+            std::cout << "Empty tree" << std::endl;
+        else
+            forEach( [ ]( const Node *t ) { std::cout << *t->element_.load( std::memory_order_acquire ) << " "; } );
+        std::cout << std::endl;
+    }
+
+    int count_Nodes( ) const
+    {
+        int nodes = 0;
+        forEach( [ &nodes ]( const Node * ) { ++nodes; } );
+        return nodes;
+    }
+
+    int heightOfTree( ) const
+    {
+        return levels_.load( std::memory_order_relaxed );
+    }
+
+    /**
+      * The skip list analogue of the trees' internal path length: the nodes each element's find( ) visits, summed.
+     */
+    int calculate_IPL( ) const
+    {
+        int total = 0;
+        forEach( [ this, &total ]( const Node *t )
+        {
+            int visited = 0;
+            findNode( t->key_, visited );
+            total += visited;
+        } );
+        return total;
+    }
+
+    int calculate_Avg_Depth( ) const
+    {
+        return calculate_IPL( ) / count_Nodes( );
+    }
+
+    double calculate_ratio( ) const
+    {
+        int avg_depth = calculate_Avg_Depth( );
+        return avg_depth / log2( count_Nodes( ) );
+    }
+
+  private:
+    struct Node
+    {
+        const std::string key_;
+        std::atomic<Comparable *> element_;
+        std::atomic<int> owners_;               // The inserter and the remover, until each lets go
+        int height_;
+        std::atomic<uintptr_t> next_[ 1 ];      // height_ links; the low bit marks the node removed at that level
+
+        Node( std::string key, Comparable *element, int height )
+          : key_{ std::move( key ) }, element_{ element }, owners_{ 2 }, height_{ height }
+          { }
+    };
+
+    Node *head_;                                // Has kMaxLevel levels and no element
+    std::atomic<int> levels_;                   // Levels that may have nodes; searches start at the top one
+    EpochReclaimer reclaimer_;
+
+    static bool isMarked( uintptr_t link )
+    {
+        return ( link & 1 ) != 0;
+    }
+
+    static Node * pointer( uintptr_t link )
+    {
+        return reinterpret_cast<Node *>( link & ~uintptr_t( 1 ) );
+    }
+
+    static uintptr_t linkTo( Node *t )
+    {
+        return reinterpret_cast<uintptr_t>( t );
+    }
+
+    /**
+     * Internal method to allocate a node with room for height links, all null.
+     */
+    static Node * newNode( std::string key, Comparable *element, int height )
+    {
+        void *memory = ::operator new( sizeof( Node ) + ( height - 1 ) * sizeof( std::atomic<uintptr_t> ) );
+        Node *t = ::new( memory ) Node{ std::move( key ), element, height };
+        for( int level = 1; level < height; ++level )
+            ::new( static_cast<void *>( &t->next_[ level ] ) ) std::atomic<uintptr_t>{ 0 };
+        t->next_[ 0 ].store( 0, std::memory_order_relaxed );
+        return t;
+    }
+
+    static void deleteNode( void *p )
+    {
+        Node *t = static_cast<Node *>( p );
+        delete t->element_.load( std::memory_order_relaxed );
+        t->~Node( );
+        ::operator delete( p );
+    }
+
+    /**
+     * Internal method to draw a level: each level above the first with probability 1/4.
+     */
+    static int randomHeight( )
+    {
+        thread_local uint64_t state = 0x9e3779b97f4a7c15ULL ^ reinterpret_cast<uintptr_t>( &state );
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int height = 1;
+        for( uint64_t bits = state; height < kMaxLevel && ( bits & 3 ) == 0; bits >>= 2 )
+            ++height;
+        return height;
+    }
+
+    /**
+     * Internal method to drop one of t's two owners, retiring t when it was the last.
+     */
+    void dropOwner( Node *t )
+    {
+        if( t->owners_.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+            reclaimer_.retire( t, &deleteNode );
+    }
+
+    /**
+     * Internal method for insert( ): takes ownership of element.
+     */
+    void insert( Comparable *element )
+    {
+        auto guard = reclaimer_.pin( );
+        const std::string & x = element->getRecSequence( );
+        Node *preds[ kMaxLevel ], *succs[ kMaxLevel ];
+        int height = randomHeight( ), ignored = 0;
+        Node *fresh = nullptr;
+        for( ;; )
+        {
+            if( findPosition( x, preds, succs, ignored ) )
+            {
+                if( mergeInto( succs[ 0 ], *element ) )
+                {
+                    delete element;
+                    if( fresh != nullptr )
+                    {
+                        fresh->element_.store( nullptr, std::memory_order_relaxed );
+                        deleteNode( fresh );
+                    }
+                    return;
+                }
+                continue;               // The node was removed meanwhile; insert a new one
+            }
+            if( fresh == nullptr )
+                fresh = newNode( x, element, height );
+            for( int level = 0; level < height; ++level )
+                fresh->next_[ level ].store( linkTo( succs[ level ] ), std::memory_order_relaxed );
+            uintptr_t expected = linkTo( succs[ 0 ] );
+            if( preds[ 0 ]->next_[ 0 ].compare_exchange_strong( expected, linkTo( fresh ) ) )
+                break;
+        }
+        raiseLevels( height );
+        for( int level = 1; level < height; ++level )
+            for( ;; )
+            {
+                uintptr_t next = fresh->next_[ level ].load( std::memory_order_acquire );
+                if( isMarked( next ) )
+                    break;              // Being removed; leave the upper levels unlinked
+                if( pointer( next ) != succs[ level ] &&
+                    !fresh->next_[ level ].compare_exchange_strong( next, linkTo( succs[ level ] ) ) )
+                    break;              // Marked while we looked
+                uintptr_t expected = linkTo( succs[ level ] );
+                if( preds[ level ]->next_[ level ].compare_exchange_strong( expected, linkTo( fresh ) ) )
+                    break;
+                findPosition( x, preds, succs, ignored );
+                if( succs[ 0 ] != fresh )
+                    break;              // Removed, perhaps already unlinked below; stop linking
+            }
+        if( isMarked( fresh->next_[ height - 1 ].load( std::memory_order_acquire ) ) )
+            findPosition( x, preds, succs, ignored );  // A remove( ) may have run its clean-up before our links
+        dropOwner( fresh );
+    }
+
+    /**
+     * Internal method to replace t's element by a copy with x merged in. Returns false, merging nothing that a
+     * reader could see, if t has been removed.
+     */
+    bool mergeInto( Node *t, const Comparable & x )
+    {
+        Comparable *current = t->element_.load( std::memory_order_acquire );
+        for( ;; )
+        {
+            if( isMarked( t->next_[ 0 ].load( std::memory_order_acquire ) ) )
+                return false;
+            Comparable *merged = new Comparable{ *current };
+            merged->Merge( x );
+            if( t->element_.compare_exchange_strong( current, merged ) )
+            {
+                reclaimer_.retire( current );
+                return true;
+            }
+            delete merged;
+        }
+    }
+
+    void raiseLevels( int height )
+    {
+        int levels = levels_.load( std::memory_order_relaxed );
+        while( levels < height && !levels_.compare_exchange_weak( levels, height ) )
+            ;
+    }
+
+    /**
+     * Internal method to find, at every level, the last node with key below x and the node after it, unlinking the
+     * marked nodes it passes. Returns true if the bottom level holds an unmarked node with key x, in succs[ 0 ].
+     * Levels above the ones in use get head_ and nullptr.
+     */
+    bool findPosition( const std::string & x, Node **preds, Node **succs, int & visited )
+    {
+      retry:
+        Node *pred = head_;
+        int top = levels_.load( std::memory_order_acquire );
+        for( int level = kMaxLevel - 1; level >= top; --level )
+        {
+            preds[ level ] = head_;
+            succs[ level ] = pointer( head_->next_[ level ].load( std::memory_order_acquire ) );
+        }
+        for( int level = top - 1; level >= 0; --level )
+        {
+            Node *curr = pointer( pred->next_[ level ].load( std::memory_order_acquire ) );
+            while( curr != nullptr )
+            {
+                ++visited;
+                uintptr_t next = curr->next_[ level ].load( std::memory_order_acquire );
+                if( isMarked( next ) )
+                {
+                    uintptr_t expected = linkTo( curr );
+                    if( !pred->next_[ level ].compare_exchange_strong( expected, next & ~uintptr_t( 1 ) ) )
+                        goto retry;
+                    curr = pointer( next );
+                    continue;
+                }
+                if( !( curr->key_ < x ) )
+                    break;
+                pred = curr;
+                curr = pointer( next );
+            }
+            preds[ level ] = pred;
+            succs[ level ] = curr;
+        }
+        return succs[ 0 ] != nullptr && succs[ 0 ]->key_ == x;
+    }
+
+    /**
+     * Internal method to return the last unmarked node with key below x, or head_, stepping over marked nodes
+     * without unlinking them.
+     */
+    const Node * lowerBound( const std::string & x, int & visited ) const
+    {
+        const Node *pred = head_;
+        for( int level = levels_.load( std::memory_order_acquire ) - 1; level >= 0; --level )
+        {
+            const Node *curr = pointer( pred->next_[ level ].load( std::memory_order_acquire ) );
+            while( curr != nullptr )
+            {
+                ++visited;
+                uintptr_t next = curr->next_[ level ].load( std::memory_order_acquire );
+                if( !isMarked( next ) )
+                {
+                    if( !( curr->key_ < x ) )
+                        break;
+                    pred = curr;
+                }
+                curr = pointer( next );
+            }
+        }
+        return pred;
+    }
+
+    /**
+     * Internal method to return the unmarked node with key x, or nullptr. Only reads.
+     */
+    const Node * findNode( const std::string & x, int & visited ) const
+    {
+        const Node *pred = lowerBound( x, visited );
+        const Node *t = pointer( pred->next_[ 0 ].load( std::memory_order_acquire ) );
+        while( t != nullptr && isMarked( t->next_[ 0 ].load( std::memory_order_acquire ) ) )
+            t = pointer( t->next_[ 0 ].load( std::memory_order_acquire ) );
+        return t != nullptr && t->key_ == x ? t : nullptr;
+    }
+
+    const Node * firstLive( ) const
+    {
+        const Node *t = pointer( head_->next_[ 0 ].load( std::memory_order_acquire ) );
+        while( t != nullptr && isMarked( t->next_[ 0 ].load( std::memory_order_acquire ) ) )
+            t = pointer( t->next_[ 0 ].load( std::memory_order_acquire ) );
+        return t;
+    }
+
+    /**
+     * Internal method to call visit( t ) for every unmarked node, in key order.
+     */
+    template <typename Visit>
+    void forEach( Visit visit ) const
+    {
+        auto guard = reclaimer_.pin( );
+        for( const Node *t = firstLive( ); t != nullptr; t = pointer( t->next_[ 0 ].load( std::memory_order_acquire ) ) )
+            if( !isMarked( t->next_[ 0 ].load( std::memory_order_acquire ) ) )
+                visit( t );
+    }
+};
+
+#endif
@@ -0,0 +1,363 @@
+/*
+ Title: LookupCache.h
+ Description: A thread-safe cache of lookup results in front of a tree. Clients ask for the same popular recognition
+        sequences over and over, so CachedTree keeps the text find_and_print() produced for recently asked keys and
+        answers repeats without touching the tree or its lock.
+        LookupCache splits its keys over shards by hash, each with its own lock and CLOCK replacement: an entry's
+        reference bit is set on every hit, and the clock hand evicts the first entry whose bit is clear, clearing
+        bits as it passes, so entries that keep being hit survive a scan of one-off keys.
+        Admission is filtered by a doorkeeper as in TinyLFU: a key is only stored on its second miss within a
+        window, so keys asked for once never push out popular ones, and a miss on such a key costs no eviction.
+        The doorkeeper is a bit per hash bucket that is cleared after about one store attempt per bit.
+        A write invalidates exactly the key it changes. A lookup that misses renders the answer outside the shard's
+        lock, so a write to the same shard in the meantime could make that answer stale; each shard counts its
+        invalidations, and the answer is only stored if the count has not moved since the miss.
+ Modifications:
+ */
+#ifndef LOOKUP_CACHE_H
+#define LOOKUP_CACHE_H
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// LookupCache class
+//
+// CONSTRUCTION: with the total number of entries and the number of shards
+//
+// ******************PUBLIC OPERATIONS*********************
+// Value lookup( k, f )   --> Return the cached value of key k; on a miss, cache and return f( )
+// void invalidate( k )   --> Drop key k's entry, and any value for k being computed right now
+// void clear( )          --> Drop every entry
+// size_t size( )         --> Return number of cached entries
+// uint64_t hits( ), misses( ), rejections( ), evictions( ), invalidations( ) --> Return the counters;
+//                            rejections are misses the doorkeeper kept out of the cache
+// ******************ERRORS********************************
+// None
+
+template <typename Value>
+class LookupCache
+{
+  public:
+    LookupCache( size_t capacity, size_t num_shards = 16 )
+    {
+        num_shards = num_shards < 1 ? 1 : num_shards;
+        size_t per_shard = ( capacity + num_shards - 1 ) / num_shards;
+        for( size_t i = 0; i < num_shards; ++i )
+            shards_.emplace_back( new Shard{ per_shard < 1 ? 1 : per_shard } );
+    }
+
+    LookupCache( const LookupCache & rhs ) = delete;
+    LookupCache & operator=( const LookupCache & rhs ) = delete;
+
+    /**
+      * Returns key's cached value, or calls compute( ) without holding any lock, caches its result if the
+      * doorkeeper admits key, and returns it. The result is not cached if key was invalidated while compute( ) ran.
+     */
+    template <typename Compute>
+    Value lookup( const std::string & key, Compute compute )
+    {
+        size_t hash = std::hash<std::string>{ }( key );
+        Shard & shard = shard_Of( hash );
+        uint64_t generation;
+        bool admitted;
+        {
+            std::lock_guard<std::mutex> guard{ shard.lock_ };
+            Entry *entry = shard.find( hash, key );
+            if( entry != nullptr )
+            {
+                entry->referenced_ = true;
+                ++shard.hits_;
+                return entry->value_;
+            }
+            ++shard.misses_;
+            admitted = shard.admit( hash / shards_.size( ) );
+            if( !admitted )
+                ++shard.rejections_;
+            generation = shard.invalidations_;
+        }
+        Value value = compute( );   // Outside the lock: compute( ) may take locks that writers hold while invalidating
+        if( !admitted )
+            return value;
+        std::lock_guard<std::mutex> guard{ shard.lock_ };
+        if( shard.invalidations_ == generation && shard.find( hash, key ) == nullptr )
+            shard.store( hash, key, value );
+        return value;
+    }
+
+    void invalidate( const std::string & key )
+    {
+        size_t hash = std::hash<std::string>{ }( key );
+        Shard & shard = shard_Of( hash );
+        std::lock_guard<std::mutex> guard{ shard.lock_ };
+        ++shard.invalidations_;
+        if( shard.find( hash, key ) != nullptr )
+            shard.release( shard.index_[ hash ] );
+    }
+
+    void clear( )
+    {
+        for( const std::unique_ptr<Shard> & shard : shards_ )
+        {
+            std::lock_guard<std::mutex> guard{ shard->lock_ };
+            ++shard->invalidations_;
+            while( !shard->index_.empty( ) )
+                shard->release( shard->index_.begin( )->second );
+        }
+    }
+
+    size_t size( ) const
+    {
+        return sum( [ ]( const Shard & shard ) -> uint64_t { return shard.index_.size( ); } );
+    }
+
+    uint64_t hits( ) const
+    {
+        return sum( [ ]( const Shard & shard ) { return shard.hits_; } );
+    }
+
+    uint64_t misses( ) const
+    {
+        return sum( [ ]( const Shard & shard ) { return shard.misses_; } );
+    }
+
+    uint64_t rejections( ) const
+    {
+        return sum( [ ]( const Shard & shard ) { return shard.rejections_; } );
+    }
+
+    uint64_t evictions( ) const
+    {
+        return sum( [ ]( const Shard & shard ) { return shard.evictions_; } );
+    }
+
+    uint64_t invalidations( ) const
+    {
+        return sum( [ ]( const Shard & shard ) { return shard.invalidations_; } );
+    }
+
+  private:
+    struct Entry
+    {
+        std::string key_;
+        Value value_;
+        size_t hash_ = 0;
+        bool referenced_ = false;
+    };
+
+    struct alignas( 64 ) Shard
+    {
+        explicit Shard( size_t capacity ) : entries_( capacity ), seen_( 8 * capacity ), seen_count_{ 0 }
+        {
+            for( size_t i = capacity; i > 0; --i )
+                free_.push_back( i - 1 );
+        }
+
+        mutable std::mutex lock_;
+        std::vector<Entry> entries_;                    // The clock's slots
+        std::vector<size_t> free_;                      // Unused slots
+        std::unordered_map<size_t, size_t> index_;      // Hash of key to slot, so the key is hashed once
+        size_t hand_ = 0;
+        std::vector<bool> seen_;                        // The doorkeeper
+        size_t seen_count_;                             // Bits set since it was last cleared
+        uint64_t hits_ = 0, misses_ = 0, rejections_ = 0, evictions_ = 0, invalidations_ = 0;
+
+        /**
+         * Returns key's entry, or nullptr. A different key with the same hash counts as absent.
+         */
+        Entry * find( size_t hash, const std::string & key )
+        {
+            auto found = index_.find( hash );
+            if( found == index_.end( ) || entries_[ found->second ].key_ != key )
+                return nullptr;
+            return &entries_[ found->second ];
+        }
+
+        /**
+         * Returns true if a key with this hash missed before in the current window; otherwise remembers it.
+         */
+        bool admit( size_t hash )
+        {
+            std::vector<bool>::reference seen = seen_[ hash % seen_.size( ) ];
+            if( seen )
+                return true;
+            seen = true;
+            if( ++seen_count_ >= seen_.size( ) / 2 )
+            {
+                seen_.assign( seen_.size( ), false );
+                seen_count_ = 0;
+            }
+            return false;
+        }
+
+        /**
+         * Puts key in a free slot, evicting the first unreferenced entry after the hand if there is none. An entry
+         * for another key with the same hash is replaced.
+         */
+        void store( size_t hash, const std::string & key, const Value & value )
+        {
+            auto colliding = index_.find( hash );
+            if( colliding != index_.end( ) )
+                release( colliding->second );
+            if( free_.empty( ) )
+            {
+                while( entries_[ hand_ ].referenced_ )
+                {
+                    entries_[ hand_ ].referenced_ = false;
+                    hand_ = ( hand_ + 1 ) % entries_.size( );
+                }
+                release( hand_ );
+                ++evictions_;
+                hand_ = ( hand_ + 1 ) % entries_.size( );
+            }
+            size_t slot = free_.back( );
+            free_.pop_back( );
+            Entry & entry = entries_[ slot ];
+            entry.key_ = key;
+            entry.value_ = value;
+            entry.hash_ = hash;
+            entry.referenced_ = false;
+            index_.emplace( hash, slot );
+        }
+
+        /**
+         * Empties slot, which must be in use, and drops it from the index.
+         */
+        void release( size_t slot )
+        {
+            index_.erase( entries_[ slot ].hash_ );
+            entries_[ slot ] = Entry{ };
+            free_.push_back( slot );
+        }
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    Shard & shard_Of( size_t hash )
+    {
+        return *shards_[ hash % shards_.size( ) ];
+    }
+
+    template <typename Count>
+    uint64_t sum( Count count ) const
+    {
+        uint64_t total = 0;
+        for( const std::unique_ptr<Shard> & shard : shards_ )
+        {
+            std::lock_guard<std::mutex> guard{ shard->lock_ };
+            total += count( *shard );
+        }
+        return total;
+    }
+};
+
+// CachedTree class
+//
+// CONSTRUCTION: with the cache's number of entries and shards
+//
+// ******************PUBLIC OPERATIONS*********************
+// void insert( x )       --> Insert x into the tree, Merge() on a duplicate; invalidates x's key
+// bool remove( x, i )    --> Remove x from the tree; invalidates x. i is the number of recursion calls
+// bool remove_Acronym( x, a )--> Remove acronym a from x's element, as in AvlTree; invalidates x
+// bool find( x, i )      --> Return true if x is present; i is the number of recursion calls. Not cached
+// void find_and_print( x )--> Prints vector associated with x if x is present, from the cache when possible
+// find_and_print( x, out )-> same, written to stream out
+// int count_Nodes( )     --> Return number of nodes in the tree
+// cache( )               --> Return the LookupCache, for its counters; its values are the printed text
+// ******************ERRORS********************************
+// None. TreeType must provide find_and_print( x, out ).
+
+template <typename TreeType>
+class CachedTree
+{
+  public:
+    explicit CachedTree( size_t cache_entries, size_t cache_shards = 16 ) : cache_{ cache_entries, cache_shards }
+      { }
+
+    CachedTree( const CachedTree & rhs ) = delete;
+    CachedTree & operator=( const CachedTree & rhs ) = delete;
+
+    /**
+      * Inserts x while no reader is in the tree, then drops its key from the cache, so the next lookup of the key
+      * sees the merged element.
+     */
+    template <typename Comparable>
+    void insert( Comparable && x )
+    {
+        std::string key = x.getRecSequence( );
+        std::unique_lock<std::shared_mutex> guard{ tree_lock_ };
+        tree_.insert( std::forward<Comparable>( x ) );
+        cache_.invalidate( key );
+    }
+
+    bool remove( const std::string & x, int & recursion_calls )
+    {
+        std::unique_lock<std::shared_mutex> guard{ tree_lock_ };
+        bool removed = tree_.remove( x, recursion_calls );
+        cache_.invalidate( x );
+        return removed;
+    }
+
+    bool remove_Acronym( const std::string & x, const std::string & acronym )
+    {
+        std::unique_lock<std::shared_mutex> guard{ tree_lock_ };
+        bool removed = tree_.remove_Acronym( x, acronym );
+        cache_.invalidate( x );
+        return removed;
+    }
+
+    bool find( const std::string & x, int & recursion_calls ) const
+    {
+        std::shared_lock<std::shared_mutex> guard{ tree_lock_ };
+        return tree_.find( x, recursion_calls );
+    }
+
+    void find_and_print( const std::string & x )
+    {
+        find_and_print( x, std::cout );
+    }
+
+    /**
+      * Writes what TreeType::find_and_print( x ) would print to out. Misses, which print "Not found", are cached
+      * too, and are invalidated when x is inserted.
+     */
+    void find_and_print( const std::string & x, std::ostream & out )
+    {
+        out << *cache_.lookup( x, [ this, &x ]( )
+        {
+            static thread_local std::ostringstream rendered;
+            rendered.str( "" );
+            {
+                std::shared_lock<std::shared_mutex> guard{ tree_lock_ };
+                tree_.find_and_print( x, rendered );
+            }
+            return std::make_shared<const std::string>( rendered.str( ) );
+        } );
+    }
+
+    int count_Nodes( ) const
+    {
+        std::shared_lock<std::shared_mutex> guard{ tree_lock_ };
+        return tree_.count_Nodes( );
+    }
+
+    const LookupCache<std::shared_ptr<const std::string> > & cache( ) const
+    {
+        return cache_;
+    }
+
+  private:
+    mutable std::shared_mutex tree_lock_;
+    TreeType tree_;
+    LookupCache<std::shared_ptr<const std::string> > cache_;    // Shared, so a hit does not copy the text
+};
+
+#endif
@@ -0,0 +1,289 @@
+/*
+ Title: NodeArena.h
+ Description: Contiguous storage for the nodes of a tree, filled by compaction. After heavy insert() and remove()
+        churn a tree's nodes are scattered over the heap, so a lookup misses the cache and the TLB at nearly every
+        level. compact_Step() moves the nodes, a bounded number at a time, into chunks of consecutive slots and
+        rewires the links to them, so a serving process can compact between requests without a long pause.
+        Nodes are laid out in blocks of kBlockLevels levels: each block is a subtree cut kBlockLevels deep, stored
+        breadth-first in about 2.5 KiB, and blocks are queued breadth-first from the root. The top of the tree ends
+        up packed together, and a root-to-leaf path crosses one block, within one or two pages, every kBlockLevels
+        levels instead of a new page at every level. This is a single level of the van Emde Boas layout; it needs no
+        subtree heights, so it suits BinarySearchTree as well as AvlTree.
+        Nodes created after a compaction come from the heap as before. release( ) frees either kind, and a chunk is
+        returned once all of its nodes are gone. Compaction remembers where it was between steps as a queue of
+        links held by nodes it already moved, so the tree may change between steps: a node removed meanwhile has
+        its slot marked dead and its queued links are dropped, and the chunks the compaction fills are kept until
+        it ends so no queued link dangles. Nodes inserted, or rotated into a part of the tree already laid out,
+        during a compaction stay where they are until the next one.
+ Modifications:
+ */
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// NodeArena class
+//
+// CONSTRUCTION: zero parameter. Node must have left_ and right_ links and a move constructor.
+//
+// ******************PUBLIC OPERATIONS*********************
+// void release( t )      --> Destroy and free node t, wherever it was allocated
+// void discard( t )      --> Destroy node t without freeing its slot; for whole-tree teardown, from any thread
+// void clear( )          --> Free every chunk once all nodes are destroyed, and forget any compaction
+// bool compact_Step( r, n )--> Move up to n nodes of the tree rooted at r into the arena; true when done
+// bool isCompacting( )   --> Return true while a compaction is unfinished
+// size_t chunk_Count( )  --> Return number of chunks allocated
+// ******************ERRORS********************************
+// None
+
+template <typename Node>
+class NodeArena
+{
+  public:
+    static const int kBlockLevels = 5;          // 31 nodes per block
+    static const size_t kChunkNodes = 4096;
+
+    NodeArena( ) : generation_{ 0 }, filling_{ nullptr }, compacting_{ false }, restart_{ false }
+      { }
+
+    NodeArena( const NodeArena & rhs ) = delete;
+    NodeArena & operator=( const NodeArena & rhs ) = delete;
+
+    /**
+      * Takes rhs's chunks. A compaction in progress restarts its walk, since its first link was to rhs's root.
+     */
+    NodeArena( NodeArena && rhs ) : NodeArena( )
+    {
+        swap( rhs );
+    }
+
+    NodeArena & operator=( NodeArena && rhs )
+    {
+        swap( rhs );
+        return *this;
+    }
+
+    ~NodeArena( )
+    {
+        clear( );
+    }
+
+    void release( Node *t )
+    {
+        auto chunk = chunkOf( t );
+        if( chunk == chunks_.end( ) )
+        {
+            delete t;
+            return;
+        }
+        t->~Node( );
+        Chunk & owner = chunk->second;
+        owner.dead_[ t - owner.slots_ ] = true;
+        if( --owner.live_ == 0 && !( compacting_ && owner.generation_ == generation_ ) )
+        {
+            std::allocator<Node>{ }.deallocate( chunk->second.slots_, kChunkNodes );
+            chunks_.erase( chunk );
+        }
+    }
+
+    /**
+      * Destroys t, leaving its slot for clear( ) to free. Changes nothing shared, so a parallel teardown may call
+      * it on many nodes at once.
+     */
+    void discard( Node *t ) const
+    {
+        if( chunkOf( t ) == chunks_.end( ) )
+            delete t;
+        else
+            t->~Node( );
+    }
+
+    /**
+      * Pre-Condition: every node in the arena has been destroyed, by release( ) or discard( ).
+     */
+    void clear( )
+    {
+        for( auto & chunk : chunks_ )
+            std::allocator<Node>{ }.deallocate( chunk.second.slots_, kChunkNodes );
+        chunks_.clear( );
+        filling_ = nullptr;
+        blocks_.clear( );
+        level_.clear( );
+        compacting_ = false;
+    }
+
+    /**
+      * Moves up to max_nodes nodes of the tree rooted at root, taking over where the last step stopped, and
+      * returns true once the walk has reached every node. Nodes this compaction already moved, met again after a
+      * restart or a rotation, are passed over but count towards max_nodes.
+     */
+    bool compact_Step( Node * & root, size_t max_nodes )
+    {
+        if( !compacting_ )
+        {
+            ++generation_;
+            filling_ = nullptr;
+            compacting_ = true;
+            restart_ = true;
+        }
+        if( restart_ )
+        {
+            blocks_.clear( );
+            level_.clear( );
+            if( root != nullptr )
+                blocks_.push_back( &root );
+            restart_ = false;
+        }
+        for( size_t moved = 0; moved < max_nodes; ++moved )
+        {
+            if( level_.empty( ) )
+            {
+                if( blocks_.empty( ) )
+                {
+                    finish( );
+                    return true;
+                }
+                level_.emplace_back( blocks_.front( ), 0 );
+                blocks_.pop_front( );
+            }
+            Node * *link = level_.front( ).first;
+            int depth = level_.front( ).second;
+            level_.pop_front( );
+            if( holderGone( link ) || *link == nullptr )
+                continue;
+            if( !isCompacted( *link ) )
+                *link = relocate( *link );
+            for( Node * *child : { &( *link )->left_, &( *link )->right_ } )
+                if( *child != nullptr )
+                {
+                    if( depth + 1 < kBlockLevels )
+                        level_.emplace_back( child, depth + 1 );
+                    else
+                        blocks_.push_back( child );
+                }
+        }
+        return false;
+    }
+
+    bool isCompacting( ) const
+    {
+        return compacting_;
+    }
+
+    size_t chunk_Count( ) const
+    {
+        return chunks_.size( );
+    }
+
+  private:
+    struct Chunk
+    {
+        Node *slots_;               // kChunkNodes slots, of which the first used_ have been handed out
+        size_t used_;
+        size_t live_;               // Slots still holding a node
+        long generation_;           // The compaction that filled the chunk
+        std::vector<bool> dead_;    // Slots whose node has been released
+    };
+
+    std::map<const Node *, Chunk, std::greater<const Node *> > chunks_;    // By first slot, highest first
+    long generation_;
+    Chunk *filling_;                                // The chunk relocate( ) fills; nullptr between compactions
+    bool compacting_;
+    std::deque<Node * *> blocks_;                   // Links to the roots of blocks still to be laid out
+    std::deque<std::pair<Node * *, int> > level_;   // Breadth-first queue within the current block, with depths
+    bool restart_;                                  // The next step walks from the root again
+
+    /**
+     * Internal method to return the chunk holding t, or chunks_.end( ) if t came from the heap.
+     */
+    typename std::map<const Node *, Chunk, std::greater<const Node *> >::iterator chunkOf( const Node *t )
+    {
+        auto chunk = chunks_.lower_bound( t );     // The chunk starting at or below t
+        if( chunk == chunks_.end( ) || t >= chunk->second.slots_ + kChunkNodes )
+            return chunks_.end( );
+        return chunk;
+    }
+
+    typename std::map<const Node *, Chunk, std::greater<const Node *> >::const_iterator chunkOf( const Node *t ) const
+    {
+        auto chunk = chunks_.lower_bound( t );
+        if( chunk == chunks_.end( ) || t >= chunk->second.slots_ + kChunkNodes )
+            return chunks_.end( );
+        return chunk;
+    }
+
+    /**
+     * Internal method to test whether the node holding link, a queued child link, has been released since it was
+     * queued. The root link is held by the tree itself.
+     */
+    bool holderGone( Node * *link )
+    {
+        const Node *slot = reinterpret_cast<const Node *>( link );
+        auto chunk = chunkOf( slot );
+        if( chunk == chunks_.end( ) )
+            return false;
+        size_t index = ( reinterpret_cast<const char *>( link ) - reinterpret_cast<const char *>( chunk->second.slots_ ) )
+                       / sizeof( Node );
+        return chunk->second.dead_[ index ];
+    }
+
+    bool isCompacted( const Node *t )
+    {
+        auto chunk = chunkOf( t );
+        return chunk != chunks_.end( ) && chunk->second.generation_ == generation_;
+    }
+
+    /**
+     * Internal method to move t into the next free slot of the chunk being filled, and free t's old storage.
+     */
+    Node * relocate( Node *t )
+    {
+        if( filling_ == nullptr || filling_->used_ == kChunkNodes )
+        {
+            Node *slots = std::allocator<Node>{ }.allocate( kChunkNodes );
+            filling_ = &chunks_.emplace( slots, Chunk{ slots, 0, 0, generation_, std::vector<bool>( kChunkNodes ) } ).first->second;
+        }
+        Node *moved = filling_->slots_ + filling_->used_++;
+        ::new( static_cast<void *>( moved ) ) Node( std::move( *t ) );
+        ++filling_->live_;
+        release( t );
+        return moved;
+    }
+
+    /**
+     * Internal method to end a compaction. The chunks it filled may now be freed when they empty, and those that
+     * already have are.
+     */
+    void finish( )
+    {
+        for( auto chunk = chunks_.begin( ); chunk != chunks_.end( ); )
+            if( chunk->second.live_ == 0 )
+            {
+                std::allocator<Node>{ }.deallocate( chunk->second.slots_, kChunkNodes );
+                chunk = chunks_.erase( chunk );
+            }
+            else
+                ++chunk;
+        filling_ = nullptr;
+        compacting_ = false;
+    }
+
+    void swap( NodeArena & rhs )
+    {
+        std::swap( chunks_, rhs.chunks_ );
+        std::swap( generation_, rhs.generation_ );
+        std::swap( filling_, rhs.filling_ );
+        std::swap( compacting_, rhs.compacting_ );
+        std::swap( blocks_, rhs.blocks_ );
+        std::swap( level_, rhs.level_ );
+        restart_ = rhs.restart_ = true;
+    }
+};
+
+#endif
@@ -0,0 +1,267 @@
+/*
+ Title: OpStats.h
+ Description: Per-operation latency and probe-depth histograms for the trees. Each tree holds an OpStats and times
+        its insert(), find(), remove() and range queries with an OpStats::Timer; dump_stats() writes the
+        percentiles, maximum, throughput and probe-depth distribution of each operation as JSON. BinarySearchTree
+        has no range queries, so its "range" entry always has a count of 0.
+        Latencies go into log-linear buckets in the style of HdrHistogram: every power of two is split into 16
+        buckets, so a reported percentile is within about 6% of the true value over the whole range. Counters are
+        relaxed atomics, so threads searching a tree at once record without locking.
+        Recording is compiled in only when TREE_STATS is defined (g++ -DTREE_STATS ...). Otherwise OpStats and its
+        Timer are empty, the trees pay nothing, and dump_stats() writes { "enabled": false }.
+ Modifications:
+    10.19.2026: Noted that BinarySearchTree records no "range" operations, since it has no print_Between().
+ */
+#ifndef OP_STATS_H
+#define OP_STATS_H
+
+#include <ostream>
+
+#ifdef TREE_STATS
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// LatencyHistogram class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// void record( v )       --> Count one value v
+// uint64_t count( )      --> Return number of values recorded
+// uint64_t max( )        --> Return largest value recorded
+// double mean( )         --> Return mean of the values recorded
+// uint64_t percentile( q )-> Return the value below which a fraction q of the recorded values fall
+// void reset( )          --> Forget all values
+// ******************ERRORS********************************
+// None
+
+class LatencyHistogram
+{
+  public:
+    LatencyHistogram( )
+    {
+        reset( );
+    }
+
+    LatencyHistogram( const LatencyHistogram & rhs ) = delete;
+    LatencyHistogram & operator=( const LatencyHistogram & rhs ) = delete;
+
+    void record( uint64_t value )
+    {
+        buckets_[ bucket_Of( value ) ].fetch_add( 1, std::memory_order_relaxed );
+        count_.fetch_add( 1, std::memory_order_relaxed );
+        sum_.fetch_add( value, std::memory_order_relaxed );
+        uint64_t seen = max_.load( std::memory_order_relaxed );
+        while( value > seen && !max_.compare_exchange_weak( seen, value, std::memory_order_relaxed ) )
+            ;
+    }
+
+    uint64_t count( ) const
+    {
+        return count_.load( std::memory_order_relaxed );
+    }
+
+    uint64_t max( ) const
+    {
+        return max_.load( std::memory_order_relaxed );
+    }
+
+    double mean( ) const
+    {
+        uint64_t n = count( );
+        return n == 0 ? 0 : double( sum_.load( std::memory_order_relaxed ) ) / n;
+    }
+
+    /**
+      * Returns the highest value of the bucket holding the value of rank ceil( q * count( ) ), capped at max( ).
+      * Returns 0 if nothing was recorded.
+     */
+    uint64_t percentile( double q ) const
+    {
+        uint64_t n = count( );
+        if( n == 0 )
+            return 0;
+        uint64_t rank = std::max<uint64_t>( 1, uint64_t( q * n + 0.999999 ) ), seen = 0;
+        for( int i = 0; i < kBuckets; ++i )
+        {
+            seen += buckets_[ i ].load( std::memory_order_relaxed );
+            if( seen >= rank )
+                return std::min( highest_In( i ), max( ) );
+        }
+        return max( );
+    }
+
+    void reset( )
+    {
+        for( std::atomic<uint64_t> & bucket : buckets_ )
+            bucket.store( 0, std::memory_order_relaxed );
+        count_.store( 0, std::memory_order_relaxed );
+        sum_.store( 0, std::memory_order_relaxed );
+        max_.store( 0, std::memory_order_relaxed );
+    }
+
+  private:
+    static const int kSubBucketBits = 4;
+    static const int kSubBuckets = 1 << kSubBucketBits;
+    static const int kBuckets = ( 64 - kSubBucketBits + 1 ) * kSubBuckets;
+
+    std::atomic<uint64_t> buckets_[ kBuckets ];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+
+    /**
+     * Values below kSubBuckets get a bucket each; above that, each power of two [ 2^e, 2^( e + 1 ) ) is split into
+     * kSubBuckets equal buckets.
+     */
+    static int bucket_Of( uint64_t value )
+    {
+        if( value < uint64_t( kSubBuckets ) )
+            return int( value );
+        int shift = 63 - __builtin_clzll( value ) - kSubBucketBits;
+        return ( shift + 1 ) * kSubBuckets + int( ( value >> shift ) - kSubBuckets );
+    }
+
+    static uint64_t highest_In( int bucket )
+    {
+        if( bucket < kSubBuckets )
+            return uint64_t( bucket );
+        int shift = bucket / kSubBuckets - 1;
+        uint64_t lowest = uint64_t( kSubBuckets + bucket % kSubBuckets ) << shift;
+        return lowest + ( ( uint64_t{ 1 } << shift ) - 1 );
+    }
+};
+
+// OpStats class
+//
+// CONSTRUCTION: zero parameter; the throughput clock starts then
+//
+// ******************PUBLIC OPERATIONS*********************
+// Timer t( stats, op, d )--> Time the enclosing scope as one op; if d is given, record *d as its probe depth
+// void dump( out )       --> Write every operation's statistics to out as JSON
+// void reset( )          --> Forget everything and restart the throughput clock
+// ******************ERRORS********************************
+// None
+
+class OpStats
+{
+  public:
+    enum Op { INSERT, FIND, REMOVE, RANGE, kOpCount };
+
+    class Timer
+    {
+      public:
+        Timer( OpStats & stats, Op op, const int *depth = nullptr )
+          : stats_( stats ), op_{ op }, depth_{ depth }, start_{ std::chrono::steady_clock::now( ) }
+          { }
+
+        Timer( const Timer & rhs ) = delete;
+        Timer & operator=( const Timer & rhs ) = delete;
+
+        ~Timer( )
+        {
+            auto elapsed = std::chrono::steady_clock::now( ) - start_;
+            stats_.latency_[ op_ ].record( std::chrono::duration_cast<std::chrono::nanoseconds>( elapsed ).count( ) );
+            if( depth_ != nullptr )
+            {
+                int depth = std::min( std::max( *depth_, 0 ), int( kMaxDepth ) );
+                stats_.depth_[ op_ ][ depth ].fetch_add( 1, std::memory_order_relaxed );
+            }
+        }
+
+      private:
+        OpStats & stats_;
+        Op op_;
+        const int *depth_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    OpStats( )
+    {
+        reset( );
+    }
+
+    OpStats( const OpStats & rhs ) = delete;
+    OpStats & operator=( const OpStats & rhs ) = delete;
+
+    void reset( )
+    {
+        for( int op = 0; op < kOpCount; ++op )
+        {
+            latency_[ op ].reset( );
+            for( std::atomic<uint64_t> & count : depth_[ op ] )
+                count.store( 0, std::memory_order_relaxed );
+        }
+        start_ = std::chrono::steady_clock::now( );
+    }
+
+    /**
+      * Writes one JSON object with, per operation, the count, throughput since construction or reset( ), latency
+      * percentiles in nanoseconds and the number of operations at each probe depth. Depths of kMaxDepth or more
+      * are counted as kMaxDepth.
+     */
+    void dump( std::ostream & out ) const
+    {
+        static const char * const kNames[ kOpCount ] = { "insert", "find", "remove", "range" };
+        double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now( ) - start_ ).count( );
+        out << "{ \"enabled\": true, \"elapsed_seconds\": " << seconds << ", \"operations\": {";
+        for( int op = 0; op < kOpCount; ++op )
+        {
+            const LatencyHistogram & latency = latency_[ op ];
+            out << ( op == 0 ? "" : "," ) << "\n  \"" << kNames[ op ] << "\": { \"count\": " << latency.count( )
+                << ", \"ops_per_sec\": " << ( seconds > 0 ? latency.count( ) / seconds : 0 )
+                << ", \"latency_ns\": { \"mean\": " << latency.mean( )
+                << ", \"p50\": " << latency.percentile( 0.50 ) << ", \"p90\": " << latency.percentile( 0.90 )
+                << ", \"p99\": " << latency.percentile( 0.99 ) << ", \"p999\": " << latency.percentile( 0.999 )
+                << ", \"max\": " << latency.max( ) << " }, \"probe_depth\": {";
+            bool first = true;
+            for( int depth = 0; depth <= kMaxDepth; ++depth )
+            {
+                uint64_t count = depth_[ op ][ depth ].load( std::memory_order_relaxed );
+                if( count == 0 )
+                    continue;
+                out << ( first ? " " : ", " ) << "\"" << depth << "\": " << count;
+                first = false;
+            }
+            out << ( first ? "} }" : " } }" );
+        }
+        out << "\n} }" << std::endl;
+    }
+
+  private:
+    static const int kMaxDepth = 64;
+
+    LatencyHistogram latency_[ kOpCount ];
+    std::atomic<uint64_t> depth_[ kOpCount ][ kMaxDepth + 1 ];
+    std::chrono::steady_clock::time_point start_;
+};
+
+#else
+
+class OpStats
+{
+  public:
+    enum Op { INSERT, FIND, REMOVE, RANGE, kOpCount };
+
+    class Timer
+    {
+      public:
+        Timer( OpStats &, Op, const int * = nullptr )
+          { }
+    };
+
+    void reset( )
+      { }
+
+    void dump( std::ostream & out ) const
+    {
+        out << "{ \"enabled\": false }" << std::endl;
+    }
+};
+
+#endif
+
+#endif
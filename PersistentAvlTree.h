@@ -0,0 +1,507 @@
+/*
+ Title: PersistentAvlTree.h
+ Description: A persistent (path-copying) AVL tree. Nodes are immutable and reference counted; insert() and remove()
+        build new copies of the O(log n) nodes on the search path and share every other subtree with the version
+        they started from. A PersistentAvlTree object is a handle on one version: copying it is O(1), and updating
+        a copy never changes the original, so keeping one handle per database release answers lookups "as of"
+        that release. A node is freed when no version reaches it any more.
+
+        diff( older, newer ) walks two versions together and skips every subtree they share, so comparing two
+        releases that differ in k keys costs about O(k log^2 n) instead of walking both trees.
+ Modifications:
+    10.19.26: insert() returns whether the key was new, and remove_Acronym( x, a, e ) whether x went, for DatabaseDelta.
+    10.19.26: insert( ) of a temporary duplicate moves its acronyms into the new element instead of copying them.
+ */
+#ifndef PERSISTENT_AVL_TREE_H
+#define PERSISTENT_AVL_TREE_H
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// PersistentAvlTree class
+//
+// CONSTRUCTION: zero parameter. Copying a tree copies the handle, not the nodes.
+//
+// ******************PUBLIC OPERATIONS*********************
+// bool insert( x )       --> Insert x; Merge() into the copy of an existing element with x's key and return false
+// void remove( x )       --> Remove x
+// bool remove( x, i)     --> If x is found in tree, it is removed and call returns true.
+// bool remove_Acronym( x, a )--> Remove acronym a from x's element; x is removed once it has no acronyms left
+// bool remove_Acronym( x, a, e )--> Same; e is set to whether x was removed
+// bool find( x, i )      --> Returns true if x is present; i is the number of recursion calls
+// void find_and_print( x)--> Prints vector associated with x if x is present
+// boolean isEmpty( )     --> Return true if empty; else false
+// void makeEmpty( )      --> Make this version empty; other versions are unaffected
+// void printTree( )      --> Print tree in sorted order
+// int count_Nodes( )     --> Return number of nodes
+// int calculate_IPL()    --> Return Internal Path Length
+// int calculate_Avg_Depth()-> Return Average Depth of all Nodes
+// double calculate_ratio()-> Return Ratio of Avg Depth to log2n
+// print_Between(k1, k2)  --> prints all elements with keys between k1 and k2
+// diff( a, b, visit )    --> Call visit( in_a, in_b ) for every key that differs between versions a and b
+// ******************ERRORS********************************
+// None
+
+template <typename Comparable>
+class PersistentAvlTree
+{
+  private:
+    struct PersistentNode;
+    typedef std::shared_ptr<const PersistentNode> NodePtr;
+
+  public:
+    PersistentAvlTree( ) : root_{ nullptr }
+      { }
+
+    /**
+     * Insert x into the tree; a duplicate key is merged into a copy of the existing element, and false returned.
+     */
+    bool insert( const Comparable & x )
+    {
+        bool added = true;
+        root_ = insert( x, root_, added );
+        return added;
+    }
+
+    bool insert( Comparable && x )
+    {
+        bool added = true;
+        root_ = insert( std::move( x ), root_, added );
+        return added;
+    }
+
+    /**
+     * Remove x from the tree. Nothing is done if x is not found.
+     */
+    void remove( const Comparable & x )
+    {
+        int recursion_calls = 0;
+        remove( x.getRecSequence( ), recursion_calls );
+    }
+
+    /**
+      * Remove x from the tree.
+      * Post-Condition: If x is not found, returns false and the version is unchanged. recursion_calls is updated to
+      * indicate total number of recursion calls it took to run remove().
+     */
+    bool remove( const std::string & x, int & recursion_calls )
+    {
+        recursion_calls = 0;
+        bool removed = false;
+        root_ = remove( x, root_, recursion_calls, removed );
+        return removed;
+    }
+
+    /**
+      * Removes acronym from the element whose key is x. An element left with no acronyms is removed from the tree.
+      * Assumes T has Remove_Acronym() and getEnzymeAcronyms() functions.
+      * Post-Condition: Returns false, and changes nothing, if x is not in the tree or its element does not list acronym.
+     */
+    bool remove_Acronym( const std::string & x, const std::string & acronym )
+    {
+        bool emptied;
+        return remove_Acronym( x, acronym, emptied );
+    }
+
+    /**
+      * remove_Acronym() that sets emptied to true if the element had no acronyms left and x was removed.
+     */
+    bool remove_Acronym( const std::string & x, const std::string & acronym, bool & emptied )
+    {
+        emptied = false;
+        const PersistentNode *t = findNode( x );
+        if( t == nullptr )
+            return false;
+        Comparable updated{ t->element_ };
+        if( !updated.Remove_Acronym( acronym ) )
+            return false;
+        emptied = updated.getEnzymeAcronyms( ).empty( );
+        if( emptied )
+            remove( updated );
+        else
+            root_ = replace( std::move( updated ), root_ );
+        return true;
+    }
+
+    /**
+      * Returns true if x is in the tree. recursion_calls is the number of recursive calls needed to find x.
+     */
+    bool find( const std::string & x, int & recursion_calls ) const
+    {
+        recursion_calls = 0;
+        return find( x, root_.get( ), recursion_calls );
+    }
+
+    /**
+      * If x is located in the tree, its associated vector is printed.
+     */
+    void find_and_print( const std::string & x ) const
+    {
+        const PersistentNode *t = findNode( x );
+        if( t == nullptr )
+            std::cout << "Not found in this tree." << std::endl;
+        else
+            t->element_.Print_Vector( );
+    }
+
+    bool isEmpty( ) const
+    {
+        return root_ == nullptr;
+    }
+
+    /**
+     * Make this version empty. Nodes still reachable from other versions are kept.
+     */
+    void makeEmpty( )
+    {
+        root_ = nullptr;
+    }
+
+    /**
+     * Print the tree contents in sorted order.
+     */
+    void printTree( ) const
+    {
+        if( isEmpty( ) )
+            std::cout << "Empty tree" << std::endl;
+        else
+            printTree( root_.get( ) );
+        std::cout << std::endl;
+    }
+
+    int count_Nodes( ) const
+    {
+        return count_Nodes( root_.get( ) );
+    }
+
+    int calculate_IPL( ) const
+    {
+        return calculate_IPL( root_.get( ), 0 );
+    }
+
+    int calculate_Avg_Depth( ) const
+    {
+        return calculate_IPL( ) / count_Nodes( );
+    }
+
+    double calculate_ratio( ) const
+    {
+        return calculate_Avg_Depth( ) / log2( count_Nodes( ) );
+    }
+
+    /**
+      * Prints all elements in tree between the value str1 and str2.
+     */
+    void print_Between( const std::string & str1, const std::string & str2 ) const
+    {
+        print_Between( str1, str2, root_.get( ) );
+    }
+
+    /**
+      * Walks versions older and newer in key order together and calls visit( in_older, in_newer ) for each key whose
+      * element differs: in_older is nullptr for a key only in newer, in_newer is nullptr for a key only in older,
+      * and both are set for a key whose element changed. Subtrees the two versions share are skipped whole.
+      * Assumes T has an operator==.
+      * Post-Condition: Returns the number of nodes expanded, a measure of the work done.
+     */
+    template <typename Visitor>
+    static long diff( const PersistentAvlTree & older, const PersistentAvlTree & newer, Visitor visit )
+    {
+        std::vector<DiffFrame> a, b;
+        if( older.root_ != nullptr )
+            a.push_back( DiffFrame{ older.root_.get( ), false } );
+        if( newer.root_ != nullptr )
+            b.push_back( DiffFrame{ newer.root_.get( ), false } );
+        long expanded = 0;
+        while( !a.empty( ) && !b.empty( ) )
+        {
+            DiffFrame fa = a.back( ), fb = b.back( );
+            if( !fa.single_ && !fb.single_ )
+            {
+                if( fa.node_ == fb.node_ )                      // Shared subtree
+                {
+                    a.pop_back( );
+                    b.pop_back( );
+                }
+                else if( fa.node_->height_ >= fb.node_->height_ )
+                    expanded += expand( a );
+                else
+                    expanded += expand( b );
+            }
+            else if( !fa.single_ )
+            {
+                // fb's key is only in newer if it sorts before everything left in a.
+                if( fb.node_->element_ < leftmost( fa.node_ )->element_ )
+                {
+                    visit( nullptr, &fb.node_->element_ );
+                    b.pop_back( );
+                }
+                else
+                    expanded += expand( a );
+            }
+            else if( !fb.single_ )
+            {
+                if( fa.node_->element_ < leftmost( fb.node_ )->element_ )
+                {
+                    visit( &fa.node_->element_, nullptr );
+                    a.pop_back( );
+                }
+                else
+                    expanded += expand( b );
+            }
+            else if( fa.node_->element_ < fb.node_->element_ )
+            {
+                visit( &fa.node_->element_, nullptr );
+                a.pop_back( );
+            }
+            else if( fb.node_->element_ < fa.node_->element_ )
+            {
+                visit( nullptr, &fb.node_->element_ );
+                b.pop_back( );
+            }
+            else
+            {
+                if( fa.node_ != fb.node_ && !( fa.node_->element_ == fb.node_->element_ ) )
+                    visit( &fa.node_->element_, &fb.node_->element_ );
+                a.pop_back( );
+                b.pop_back( );
+            }
+        }
+        while( !a.empty( ) )
+            if( !a.back( ).single_ )
+                expanded += expand( a );
+            else
+            {
+                visit( &a.back( ).node_->element_, nullptr );
+                a.pop_back( );
+            }
+        while( !b.empty( ) )
+            if( !b.back( ).single_ )
+                expanded += expand( b );
+            else
+            {
+                visit( nullptr, &b.back( ).node_->element_ );
+                b.pop_back( );
+            }
+        return expanded;
+    }
+
+  private:
+    struct PersistentNode
+    {
+        const Comparable element_;
+        const NodePtr left_;
+        const NodePtr right_;
+        const int height_;
+
+        PersistentNode( Comparable && ele, NodePtr lt, NodePtr rt )
+          : element_{ std::move( ele ) }, left_{ std::move( lt ) }, right_{ std::move( rt ) },
+            height_{ std::max( heightOfNode( left_.get( ) ), heightOfNode( right_.get( ) ) ) + 1 } { }
+    };
+
+    // One entry of a diff() stack: the whole subtree at node_, or (single_) just node_'s element.
+    struct DiffFrame
+    {
+        const PersistentNode *node_;
+        bool single_;
+    };
+
+    NodePtr root_;
+
+    static const int ALLOWED_IMBALANCE = 1;
+
+    /**
+     * Return the height of node t or -1 if nullptr.
+     */
+    static int heightOfNode( const PersistentNode *t )
+    {
+        return t == nullptr ? -1 : t->height_;
+    }
+
+    static NodePtr makeNode( Comparable element, NodePtr lt, NodePtr rt )
+    {
+        return std::make_shared<const PersistentNode>( std::move( element ), std::move( lt ), std::move( rt ) );
+    }
+
+    /**
+     * Internal method to build a node with element, lt and rt, rotating if lt and rt differ in height by two.
+     * Only the nodes the rotation rearranges are copied.
+     */
+    static NodePtr balance( const Comparable & element, NodePtr lt, NodePtr rt )
+    {
+        if( heightOfNode( lt.get( ) ) - heightOfNode( rt.get( ) ) > ALLOWED_IMBALANCE )
+        {
+            if( heightOfNode( lt->left_.get( ) ) >= heightOfNode( lt->right_.get( ) ) )     // Single rotation
+                return makeNode( lt->element_, lt->left_, makeNode( element, lt->right_, std::move( rt ) ) );
+            const PersistentNode *lr = lt->right_.get( );                                 // Double rotation
+            return makeNode( lr->element_, makeNode( lt->element_, lt->left_, lr->left_ ),
+                             makeNode( element, lr->right_, std::move( rt ) ) );
+        }
+        if( heightOfNode( rt.get( ) ) - heightOfNode( lt.get( ) ) > ALLOWED_IMBALANCE )
+        {
+            if( heightOfNode( rt->right_.get( ) ) >= heightOfNode( rt->left_.get( ) ) )
+                return makeNode( rt->element_, makeNode( element, std::move( lt ), rt->left_ ), rt->right_ );
+            const PersistentNode *rl = rt->left_.get( );
+            return makeNode( rl->element_, makeNode( element, std::move( lt ), rl->left_ ),
+                             makeNode( rt->element_, rl->right_, rt->right_ ) );
+        }
+        return makeNode( element, std::move( lt ), std::move( rt ) );
+    }
+
+    /**
+     * Internal method to insert into a subtree. Returns the root of the new version of the subtree, and sets added
+     * to false if x was merged into a duplicate.
+     * This function assumes all Comparables have a Merge() function.
+     */
+    template <typename X>
+    static NodePtr insert( X && x, const NodePtr & t, bool & added )
+    {
+        if( t == nullptr )
+            return makeNode( Comparable{ std::forward<X>( x ) }, nullptr, nullptr );
+        if( x < t->element_ )
+            return balance( t->element_, insert( std::forward<X>( x ), t->left_, added ), t->right_ );
+        if( t->element_ < x )
+            return balance( t->element_, t->left_, insert( std::forward<X>( x ), t->right_, added ) );
+        added = false;
+        Comparable merged{ t->element_ };
+        merged.Merge( std::forward<X>( x ) );
+        return makeNode( std::move( merged ), t->left_, t->right_ );
+    }
+
+    /**
+     * Internal method to replace the element with x's key by x. Returns the root of the new version of the subtree.
+     * Pre-Condition: x's key is in the subtree.
+     */
+    static NodePtr replace( Comparable && x, const NodePtr & t )
+    {
+        if( x < t->element_ )
+            return makeNode( t->element_, replace( std::move( x ), t->left_ ), t->right_ );
+        if( t->element_ < x )
+            return makeNode( t->element_, t->left_, replace( std::move( x ), t->right_ ) );
+        return makeNode( std::move( x ), t->left_, t->right_ );
+    }
+
+    /**
+     * Internal method to remove x from a subtree while counting recursion calls. Returns the root of the new version
+     * of the subtree, which is t itself if x was not found.
+     */
+    static NodePtr remove( const std::string & x, const NodePtr & t, int & recursion_calls, bool & removed )
+    {
+        ++recursion_calls;
+        if( t == nullptr )
+            return t;   // Item not found; do nothing
+        if( x < t->element_.getRecSequence( ) )
+        {
+            NodePtr lt = remove( x, t->left_, recursion_calls, removed );
+            return removed ? balance( t->element_, std::move( lt ), t->right_ ) : t;
+        }
+        if( t->element_.getRecSequence( ) < x )
+        {
+            NodePtr rt = remove( x, t->right_, recursion_calls, removed );
+            return removed ? balance( t->element_, t->left_, std::move( rt ) ) : t;
+        }
+        if( t->left_ != nullptr && t->right_ != nullptr )   // Two children
+        {
+            const Comparable & successor = leftmost( t->right_.get( ) )->element_;
+            NodePtr rt = remove( successor.getRecSequence( ), t->right_, recursion_calls, removed );
+            return balance( successor, t->left_, std::move( rt ) );
+        }
+        removed = true;
+        return t->left_ != nullptr ? t->left_ : t->right_;
+    }
+
+    /**
+     * Internal method to find the node with key x, or nullptr.
+     */
+    const PersistentNode * findNode( const std::string & x ) const
+    {
+        const PersistentNode *t = root_.get( );
+        while( t != nullptr && t->element_.getRecSequence( ) != x )
+            t = x < t->element_.getRecSequence( ) ? t->left_.get( ) : t->right_.get( );
+        return t;
+    }
+
+    /**
+     * Internal method to return the node with the smallest item in the non-empty subtree t.
+     */
+    static const PersistentNode * leftmost( const PersistentNode *t )
+    {
+        while( t->left_ != nullptr )
+            t = t->left_.get( );
+        return t;
+    }
+
+    /**
+     * Internal method to replace the subtree frame on top of stack by its right subtree, its element and its left
+     * subtree, in that order, so the top is again the next item in key order. Returns 1.
+     */
+    static long expand( std::vector<DiffFrame> & stack )
+    {
+        const PersistentNode *t = stack.back( ).node_;
+        stack.pop_back( );
+        if( t->right_ != nullptr )
+            stack.push_back( DiffFrame{ t->right_.get( ), false } );
+        stack.push_back( DiffFrame{ t, true } );
+        if( t->left_ != nullptr )
+            stack.push_back( DiffFrame{ t->left_.get( ), false } );
+        return 1;
+    }
+
+    /**
+      * Internal Method to test if an item in a subtree is present, counting recursion calls.
+     */
+    bool find( const std::string & x, const PersistentNode *t, int & recursion_calls ) const
+    {
+        ++recursion_calls;
+        if( t == nullptr )
+            return false;
+        else if( x < t->element_.getRecSequence( ) )
+            return find( x, t->left_.get( ), recursion_calls );
+        else if( t->element_.getRecSequence( ) < x )
+            return find( x, t->right_.get( ), recursion_calls );
+        else
+            return true;    // Match
+    }
+
+    void printTree( const PersistentNode *t ) const
+    {
+        if( t != nullptr )
+        {
+            printTree( t->left_.get( ) );
+            std::cout << t->element_ << " ";
+            printTree( t->right_.get( ) );
+        }
+    }
+
+    int count_Nodes( const PersistentNode *t ) const
+    {
+        return t == nullptr ? 0 : count_Nodes( t->left_.get( ) ) + count_Nodes( t->right_.get( ) ) + 1;
+    }
+
+    int calculate_IPL( const PersistentNode *t, int depth ) const
+    {
+        if( t == nullptr )
+            return 0;
+        return calculate_IPL( t->left_.get( ), depth + 1 ) + calculate_IPL( t->right_.get( ), depth + 1 ) + depth;
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2, const PersistentNode *t ) const
+    {
+        if( t != nullptr )
+        {
+            if( t->element_.getRecSequence( ) > str1 )
+                print_Between( str1, str2, t->left_.get( ) );
+            if( t->element_.getRecSequence( ) > str1 && t->element_.getRecSequence( ) < str2 )
+                std::cout << t->element_ << " ";
+            if( t->element_.getRecSequence( ) <= str2 )
+                print_Between( str1, str2, t->right_.get( ) );
+        }
+    }
+};
+
+#endif
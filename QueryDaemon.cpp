@@ -0,0 +1,503 @@
+/*
+ Title: QueryDaemon.cpp
+ Description: Loads the enzyme database into an AvlTree<SequenceMap> once and answers queries from many clients over
+        a Unix domain socket, so each query costs a round trip instead of a process start and a tree build.
+        One thread runs an epoll loop that accepts connections, reads requests and writes answers without
+        blocking; the queries themselves run on a pool of reader threads, which search the tree at the same time
+        since nothing modifies it after loading.
+        Protocol: one request per line, and a client may send any number of requests before reading an answer.
+            GET <sequence>          the acronyms of <sequence>, as find_and_print() prints them
+            RANGE <lower> <upper>   the elements with keys strictly between <lower> and <upper>, as print_Between()
+            PREFIX <prefix>         the elements whose keys start with <prefix>, as print_Prefix()
+            QUIT                    close the connection once earlier requests are answered
+        Each answer is the line "OK <n>" followed by exactly n bytes of text, or the single line "ERR <message>".
+        Answers come back in the order the requests were sent: a connection's waiting requests are handed to the
+        pool in batches of up to kBatchRequests, and its next batch is only handed over once the previous one has
+        been answered. A request line longer than kMaxLineBytes is answered with ERR and the connection is closed.
+        A connection is not read from while it has more than kMaxQueuedRequests requests waiting or more than
+        kMaxPendingBytes of answers unsent, so a client that sends without reading cannot exhaust the daemon.
+        SIGINT or SIGTERM stops the daemon and removes the socket file.
+ Usage: QueryDaemon <database filename> <socket path> [-threads=N] [-cache=N]
+        -threads=N  Answer queries on N reader threads (default: one per core).
+        -cache=N    Keep the answers to up to N recognition sequences asked for with GET in a LookupCache shared by
+                    the reader threads. The tree never changes while the daemon runs, so nothing is invalidated.
+        QueryLoadGen measures the daemon's throughput and latency.
+ Build with: make QueryDaemon
+ Modifications:
+    10.19.2026: The database loader moves each SequenceMap into the tree instead of copying it.
+    10.19.2026: Added the -cache=N option.
+    10.19.2026: A request counts as answered once its answer has been written to the socket, not when it is dispatched.
+ */
+
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "SequenceMap.h"
+#include "AvlTree.h"
+#include "WorkStealingPool.h"
+#include "LookupCache.h"
+
+const size_t kBatchRequests = 64;               // Most requests of one connection handed to the pool at once
+const size_t kMaxLineBytes = 64 * 1024;         // Longest request line accepted
+const size_t kMaxPendingBytes = 1 << 20;        // Unsent answers above which a connection is not read from
+const size_t kMaxQueuedRequests = 4 * kBatchRequests;   // Waiting requests above which a connection is not read from
+
+typedef LookupCache<std::shared_ptr<const std::string> > AnswerCache;  // GET answers by sequence, shared so a hit does not copy
+
+/**
+  * One client connection. Only the epoll thread touches it; the pool sees copies of its requests.
+ */
+struct Connection {
+    int fd_;
+    std::string in_;                    // Bytes read but not yet split into requests
+    std::deque<std::string> requests_;  // Complete request lines not yet handed to the pool
+    std::string out_;                   // Answers not yet written
+    size_t out_sent_ = 0;               // Bytes of out_ already written
+    std::deque<size_t> answer_ends_;    // Where each answer in out_ not yet wholly written ends
+    bool busy_ = false;                 // A batch of this connection's requests is on the pool
+    bool closing_ = false;              // Read no more, and close once every answer is written
+    uint32_t events_ = EPOLLIN;         // The events epoll watches fd_ for
+    explicit Connection(int fd) : fd_(fd) { }
+};
+
+/**
+  * The answers to one batch of a connection's requests.
+ */
+struct Answers {
+    uint64_t id_;                       // The connection's id
+    std::string text_;
+    std::vector<size_t> ends_;          // Where each answer ends in text_
+    bool quit_;                         // The batch ended with QUIT or a request line that was too long
+};
+
+/**
+  * Answers handed back from the pool to the epoll thread, which is woken through an eventfd.
+ */
+struct Completions {
+    std::mutex lock_;
+    std::vector<Answers> answers_;
+    int event_fd_;
+};
+
+/**
+  * Checks to make sure a file opens and issues an error message if not.
+ */
+void CheckFile(const std::string& filename);
+
+/**
+  * FillTree() takes the input from db_filename, parses it and stores it in a_tree as SequenceMap objects.
+  * Pre-Condition: a_tree is empty.
+  * Pre-Condition: Each line in db_filename in this format: EnzymeAcronym/Sequence1/Sequence2/.../Sequence n//
+  * Pre-Condition: The file provided has a 10 line header that will be skipped over.
+ */
+template <typename TreeType>
+void FillTree(const std::string& db_filename, TreeType &a_tree);
+
+/**
+  * GetEnzymeAcronym() takes a line from a file and returns the Enzyme Acronym.
+ */
+std::string GetEnzymeAcronym(const std::string& db_line, size_t first_slash);
+
+/**
+  * Parses the db_line string to pull out the next sequence after first_slash. Returns false when none remain.
+ */
+bool GetNextRecognitionSequence(const std::string& db_line, std::string& a_reco_seq, size_t& first_slash);
+
+/**
+  * Seconds elapsed since start.
+ */
+double SecondsSince(std::chrono::steady_clock::time_point start);
+
+/**
+  * Appends the answer to one request line to answers, in the protocol described above. Sets quit for QUIT and for
+  * a line longer than kMaxLineBytes, after which the connection is closed. GET answers come from cache, unless it
+  * is nullptr.
+ */
+void AnswerRequest(const AvlTree<SequenceMap>& a_tree, AnswerCache* cache, const std::string& request, std::string& answers,
+                   bool& quit);
+
+/**
+  * Creates a nonblocking Unix domain socket listening at socket_path, replacing a stale socket file. Exits on error.
+ */
+int ListenAt(const std::string& socket_path);
+
+/**
+  * Runs the epoll loop until SIGINT or SIGTERM arrives at signal_fd. Returns the number of requests whose answers
+  * were written in full.
+ */
+long ServeQueries(const AvlTree<SequenceMap>& a_tree, AnswerCache* cache, int listen_fd, int signal_fd, size_t threads);
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0] << " <databasefilename> <socketpath> [-threads=N] [-cache=N]" << std::endl;
+        return 0;
+    }
+    std::string db_filename(argv[1]);
+    std::string socket_path(argv[2]);
+    size_t threads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+    size_t cache_entries = 0;
+    for (int i = 3; i < argc; i++) {
+        std::string option(argv[i]);
+        if (option.compare(0, 9, "-threads=") == 0 && atoi(option.c_str() + 9) > 0)
+            threads = atoi(option.c_str() + 9);
+        else if (option.compare(0, 7, "-cache=") == 0 && atoi(option.c_str() + 7) > 0)
+            cache_entries = atoi(option.c_str() + 7);
+        else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+    CheckFile(db_filename);
+
+    // Block the stop signals before any thread starts, so every thread inherits the mask and they reach signal_fd.
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+    int signal_fd = signalfd(-1, &stop_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    AvlTree<SequenceMap> a_tree;
+    auto start = std::chrono::steady_clock::now();
+    FillTree(db_filename, a_tree);
+    std::cout << "Built " << a_tree.count_Nodes() << " nodes from " << db_filename << " in "
+              << SecondsSince(start) << " s." << std::endl;
+    int listen_fd = ListenAt(socket_path);
+    std::cout << "Serving on " << socket_path << " with " << threads << " reader threads." << std::endl;
+    std::unique_ptr<AnswerCache> cache;
+    if (cache_entries > 0)
+        cache.reset(new AnswerCache(cache_entries));
+
+    start = std::chrono::steady_clock::now();
+    long answered = ServeQueries(a_tree, cache.get(), listen_fd, signal_fd, threads);
+    close(listen_fd);
+    close(signal_fd);
+    unlink(socket_path.c_str());
+    std::cout << "Answered " << answered << " requests in " << SecondsSince(start) << " s." << std::endl;
+    if (cache)
+        std::cout << "Cache: " << cache->hits() << " hits, " << cache->misses() << " misses, " << cache->size()
+                  << " answers kept." << std::endl;
+    return 0;
+}
+
+int ListenAt(const std::string& socket_path) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long." << std::endl;
+        exit(1);
+    }
+    strcpy(address.sun_path, socket_path.c_str());
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(socket_path.c_str());
+    if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0
+        || listen(listen_fd, SOMAXCONN) < 0) {
+        std::cerr << "Cannot listen on " << socket_path << ": " << strerror(errno) << std::endl;
+        exit(1);
+    }
+    return listen_fd;
+}
+
+void AnswerRequest(const AvlTree<SequenceMap>& a_tree, AnswerCache* cache, const std::string& request, std::string& answers,
+                   bool& quit) {
+    if (request.size() > kMaxLineBytes) {
+        quit = true;
+        answers += "ERR request too long\n";
+        return;
+    }
+    std::istringstream words(request);
+    std::string command, first, second, extra;
+    words >> command >> first >> second >> extra;
+    if (command == "GET" && !first.empty() && second.empty() && cache != nullptr) {
+        std::shared_ptr<const std::string> text = cache->lookup(first, [&]() {
+            std::ostringstream rendered;
+            a_tree.find_and_print(first, rendered);
+            return std::make_shared<const std::string>(rendered.str());
+        });
+        answers += "OK " + std::to_string(text->size()) + "\n";
+        answers += *text;
+        return;
+    }
+    std::ostringstream payload;
+    if (command == "GET" && !first.empty() && second.empty())
+        a_tree.find_and_print(first, payload);
+    else if (command == "RANGE" && !second.empty() && extra.empty())
+        a_tree.print_Between(first, second, payload);
+    else if (command == "PREFIX" && !first.empty() && second.empty())
+        a_tree.print_Prefix(first, payload);
+    else if (command == "QUIT" && first.empty()) {
+        quit = true;
+        answers += "OK 0\n";
+        return;
+    }
+    else {
+        answers += "ERR bad request\n";
+        return;
+    }
+    std::string text = payload.str();
+    answers += "OK " + std::to_string(text.size()) + "\n";
+    answers += text;
+}
+
+long ServeQueries(const AvlTree<SequenceMap>& a_tree, AnswerCache* cache, int listen_fd, int signal_fd, size_t threads) {
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    Completions completions;
+    completions.event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+    uint64_t next_id = 3;           // Ids 0 to 2 stand for the listening socket, the eventfd and the signalfd
+    long answered = 0;
+
+    auto watch = [&](int fd, uint32_t events, uint64_t id, int op) {
+        epoll_event event;
+        event.events = events;
+        event.data.u64 = id;
+        epoll_ctl(epoll_fd, op, fd, &event);
+    };
+    watch(listen_fd, EPOLLIN, 0, EPOLL_CTL_ADD);
+    watch(completions.event_fd_, EPOLLIN, 1, EPOLL_CTL_ADD);
+    watch(signal_fd, EPOLLIN, 2, EPOLL_CTL_ADD);
+
+    WorkStealingPool pool(threads);
+    WorkStealingPool::TaskGroup in_flight(pool);
+
+    auto close_connection = [&](uint64_t id) {
+        close(connections[id]->fd_);    // Closing also removes fd from the epoll set
+        connections.erase(id);          // Answers still on the pool for id are dropped when they come back
+    };
+
+    // Writes as much of the connection's answers as the socket takes, counts the answers now written in full, and
+    // watches for writability if some remain. Returns false if the connection was closed.
+    auto flush = [&](uint64_t id, Connection& connection) {
+        bool failed = false;
+        while (connection.out_sent_ < connection.out_.size()) {
+            ssize_t sent = send(connection.fd_, connection.out_.data() + connection.out_sent_,
+                                connection.out_.size() - connection.out_sent_, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR)
+                continue;
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+            if (sent < 0) {
+                failed = true;
+                break;
+            }
+            connection.out_sent_ += sent;
+        }
+        while (!connection.answer_ends_.empty() && connection.answer_ends_.front() <= connection.out_sent_) {
+            connection.answer_ends_.pop_front();
+            answered++;
+        }
+        if (failed) {
+            close_connection(id);
+            return false;
+        }
+        if (connection.out_sent_ == connection.out_.size()) {
+            connection.out_.clear();
+            connection.out_sent_ = 0;
+            if (connection.closing_ && !connection.busy_ && connection.requests_.empty()) {
+                close_connection(id);
+                return false;
+            }
+        }
+        bool want_read = !connection.closing_ && connection.requests_.size() < kMaxQueuedRequests
+                         && connection.out_.size() - connection.out_sent_ < kMaxPendingBytes;
+        uint32_t events = (want_read ? uint32_t(EPOLLIN) : 0) | (connection.out_.empty() ? 0 : uint32_t(EPOLLOUT));
+        if (events != connection.events_) {
+            watch(connection.fd_, events, id, EPOLL_CTL_MOD);
+            connection.events_ = events;
+        }
+        return true;
+    };
+
+    // Hands the connection's next batch of requests to the pool, unless one is already there or the client is
+    // not reading its answers.
+    auto dispatch = [&](uint64_t id, Connection& connection) {
+        if (connection.busy_ || connection.requests_.empty()
+            || connection.out_.size() - connection.out_sent_ >= kMaxPendingBytes)
+            return;
+        std::vector<std::string> batch;
+        while (!connection.requests_.empty() && batch.size() < kBatchRequests) {
+            batch.push_back(std::move(connection.requests_.front()));
+            connection.requests_.pop_front();
+        }
+        connection.busy_ = true;
+        in_flight.run([&a_tree, cache, &completions, id, batch]() {
+            Answers answers{id, std::string(), std::vector<size_t>(), false};
+            for (const std::string& request : batch) {
+                AnswerRequest(a_tree, cache, request, answers.text_, answers.quit_);
+                answers.ends_.push_back(answers.text_.size());
+                if (answers.quit_)
+                    break;
+            }
+            {
+                std::lock_guard<std::mutex> guard(completions.lock_);
+                completions.answers_.push_back(std::move(answers));
+            }
+            uint64_t one = 1;
+            ssize_t written = write(completions.event_fd_, &one, sizeof(one));
+            (void)written;
+        });
+    };
+
+    // Reads what the client sent and splits it into request lines, until the socket is drained or enough requests
+    // are waiting. An unfinished line longer than kMaxLineBytes is queued as it is, to be answered with ERR.
+    auto receive = [&](uint64_t id, Connection& connection) {
+        char buffer[16384];
+        while (!connection.closing_ && connection.requests_.size() < kMaxQueuedRequests) {
+            ssize_t received = recv(connection.fd_, buffer, sizeof(buffer), 0);
+            if (received < 0 && errno == EINTR)
+                continue;
+            if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+            if (received <= 0) {
+                connection.closing_ = true;     // End of input: answer what was asked, then close
+                break;
+            }
+            size_t line_start = 0, newline = connection.in_.size();
+            connection.in_.append(buffer, received);
+            while ((newline = connection.in_.find('\n', newline)) != std::string::npos) {
+                size_t line_end = newline > line_start && connection.in_[newline - 1] == '\r' ? newline - 1 : newline;
+                connection.requests_.push_back(connection.in_.substr(line_start, line_end - line_start));
+                line_start = ++newline;
+            }
+            connection.in_.erase(0, line_start);
+            if (connection.in_.size() > kMaxLineBytes) {
+                connection.requests_.push_back(std::move(connection.in_));
+                connection.in_.clear();
+                connection.closing_ = true;
+            }
+        }
+        dispatch(id, connection);
+        return flush(id, connection);
+    };
+
+    bool stopping = false;
+    epoll_event events[64];
+    while (!stopping) {
+        int ready = epoll_wait(epoll_fd, events, 64, -1);
+        if (ready < 0 && errno == EINTR)
+            continue;
+        for (int i = 0; i < ready && !stopping; i++) {
+            uint64_t id = events[i].data.u64;
+            if (id == 0) {
+                int client_fd;
+                while ((client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    connections[next_id].reset(new Connection(client_fd));
+                    watch(client_fd, EPOLLIN, next_id++, EPOLL_CTL_ADD);
+                }
+            }
+            else if (id == 1) {
+                uint64_t count;
+                ssize_t got = read(completions.event_fd_, &count, sizeof(count));
+                (void)got;
+                std::vector<Answers> done;
+                {
+                    std::lock_guard<std::mutex> guard(completions.lock_);
+                    done.swap(completions.answers_);
+                }
+                for (Answers& answers : done) {
+                    auto found = connections.find(answers.id_);
+                    if (found == connections.end())
+                        continue;
+                    Connection& connection = *found->second;
+                    connection.busy_ = false;
+                    for (size_t end : answers.ends_)
+                        connection.answer_ends_.push_back(connection.out_.size() + end);
+                    connection.out_ += answers.text_;
+                    if (answers.quit_) {
+                        connection.requests_.clear();
+                        connection.closing_ = true;
+                    }
+                    dispatch(answers.id_, connection);
+                    flush(answers.id_, connection);
+                }
+            }
+            else if (id == 2)
+                stopping = true;
+            else {
+                auto found = connections.find(id);
+                if (found == connections.end())
+                    continue;
+                Connection& connection = *found->second;
+                if ((events[i].events & (EPOLLERR | EPOLLHUP)) && !(events[i].events & EPOLLIN)) {
+                    close_connection(id);
+                    continue;
+                }
+                if ((events[i].events & EPOLLIN) && !receive(id, connection))
+                    continue;
+                if ((events[i].events & EPOLLOUT) && flush(id, connection)) {
+                    dispatch(id, connection);   // Writing may have let a held-back batch go
+                    flush(id, connection);
+                }
+            }
+        }
+    }
+    in_flight.wait();
+    for (auto& connection : connections)
+        close(connection.second->fd_);
+    close(completions.event_fd_);
+    close(epoll_fd);
+    return answered;
+}
+
+void CheckFile(const std::string& filename) {
+    ifstream inStream(filename);
+    if (inStream.fail()) {
+        std::cerr << "Filename not found." << std::endl;
+        exit(1);
+    }
+}
+
+template <typename TreeType>
+void FillTree(const std::string& db_filename, TreeType &a_tree) {
+    ifstream inStream(db_filename);
+    std::string db_line, an_enz_acro, a_reco_seq, garbage_line;
+    for (int i = 0; i < 10; i ++)                               //Skip over the header and begin reading on line 11.
+        getline(inStream, garbage_line);
+    while (std::getline (inStream, db_line)) {
+        if (db_line.empty()) continue;
+        size_t first_slash = db_line.find("/");
+        an_enz_acro = GetEnzymeAcronym(db_line, first_slash);
+        while (GetNextRecognitionSequence(db_line, a_reco_seq, first_slash)) {
+            SequenceMap new_sequence_map(a_reco_seq, an_enz_acro);
+            a_tree.insert(std::move(new_sequence_map));
+        }
+    }
+}
+
+std::string GetEnzymeAcronym(const std::string& db_line, size_t first_slash) {
+    return db_line.substr(0, first_slash);
+}
+
+bool GetNextRecognitionSequence(const std::string& db_line, std::string& a_reco_seq, size_t& first_slash) {
+    size_t next_slash = db_line.find("/", first_slash+1);
+    if (next_slash == first_slash + 1)    //see if there are two '/' in a row
+        return false;                     //there are no more recognition sequences (all db_lines end in "//")
+    a_reco_seq = db_line.substr(first_slash+1, next_slash-first_slash-1);
+    first_slash = next_slash;
+    return true;
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,272 @@
+/*
+ Title: QueryLoadGen.cpp
+ Description: Load generator for QueryDaemon. Opens several connections to the daemon's socket, each on its own
+        thread, and keeps a fixed number of requests in flight on each by pipelining: a new request is sent as soon
+        as an answer comes back. Requests are taken in turn from the queries file; a chosen percentage become RANGE
+        and PREFIX requests around the query instead of GETs. Prints the throughput and the latency percentiles of
+        all requests, timed from sending a request to reading the end of its answer.
+ Usage: QueryLoadGen <socket path> <queries filename> [-connections=N] [-depth=D] [-requests=R] [-range=P] [-prefix=P]
+        -connections=N  Connections to open (default 4)
+        -depth=D        Requests in flight per connection (default 16)
+        -requests=R     Requests to send in all (default 200000)
+        -range=P        Percentage of RANGE requests (default 0)
+        -prefix=P       Percentage of PREFIX requests (default 0)
+ Build with: make QueryLoadGen
+ Modifications:
+ */
+
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/**
+  * What one connection measured.
+ */
+struct ConnectionResult {
+    std::vector<double> latencies_;     // Microseconds, one per answered request
+    long errors_ = 0;                   // ERR answers
+    long answer_bytes_ = 0;             // Payload bytes of OK answers
+    bool failed_ = false;               // The connection broke before every request was answered
+};
+
+/**
+  * Checks to make sure a file opens and issues an error message if not.
+ */
+void CheckFile(const std::string& filename);
+
+/**
+  * Reads one recognition sequence per line from query_filename, skipping empty lines.
+ */
+std::vector<std::string> ReadQueries(const std::string& query_filename);
+
+/**
+  * Seconds elapsed since start.
+ */
+double SecondsSince(std::chrono::steady_clock::time_point start);
+
+/**
+  * Returns a connected Unix domain socket, or -1 after printing why it could not connect.
+ */
+int ConnectTo(const std::string& socket_path);
+
+/**
+  * Returns the request line for the i-th request of a connection: a RANGE request with probability range_percent,
+  * a PREFIX request with probability prefix_percent, else a GET. RANGE asks for the keys between the query and the
+  * query with its last character raised by one; PREFIX asks for the query without its last two characters.
+ */
+std::string MakeRequest(const std::string& query, long i, int range_percent, int prefix_percent);
+
+/**
+  * Sends requests requests over one connection, keeping depth of them in flight, and records each one's latency.
+  * Connection c takes the queries from index c onwards, so connections ask for different sequences.
+ */
+void RunConnection(const std::string& socket_path, const std::vector<std::string>& queries, int c, long requests,
+                   int depth, int range_percent, int prefix_percent, ConnectionResult& result);
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0] << " <socketpath> <queryfilename> [-connections=N] [-depth=D] "
+                  << "[-requests=R] [-range=P] [-prefix=P]" << std::endl;
+        return 0;
+    }
+    std::string socket_path(argv[1]);
+    std::string query_filename(argv[2]);
+    int connections = 4, depth = 16, range_percent = 0, prefix_percent = 0;
+    long requests = 200000;
+    for (int i = 3; i < argc; i++) {
+        std::string option(argv[i]);
+        std::string name = option.substr(0, option.find('=') + 1);
+        long value = name.size() < option.size() ? atol(option.c_str() + name.size()) : -1;
+        if (name == "-connections=" && value > 0)
+            connections = value;
+        else if (name == "-depth=" && value > 0)
+            depth = value;
+        else if (name == "-requests=" && value > 0)
+            requests = value;
+        else if (name == "-range=" && value >= 0 && value <= 100)
+            range_percent = value;
+        else if (name == "-prefix=" && value >= 0 && value <= 100)
+            prefix_percent = value;
+        else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+    if (range_percent + prefix_percent > 100) {
+        std::cerr << "-range and -prefix add up to more than 100." << std::endl;
+        return 1;
+    }
+    CheckFile(query_filename);
+    std::vector<std::string> queries = ReadQueries(query_filename);
+    if (queries.empty()) {
+        std::cerr << "No queries in " << query_filename << "." << std::endl;
+        return 1;
+    }
+
+    std::vector<ConnectionResult> results(connections);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < connections; c++) {
+        long share = requests / connections + (c < requests % connections ? 1 : 0);
+        threads.emplace_back(RunConnection, std::cref(socket_path), std::cref(queries), c, share, depth,
+                             range_percent, prefix_percent, std::ref(results[c]));
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    double seconds = SecondsSince(start);
+
+    std::vector<double> latencies;
+    long errors = 0, answer_bytes = 0, failed = 0;
+    for (const ConnectionResult& result : results) {
+        latencies.insert(latencies.end(), result.latencies_.begin(), result.latencies_.end());
+        errors += result.errors_;
+        answer_bytes += result.answer_bytes_;
+        failed += result.failed_;
+    }
+    if (latencies.empty()) {
+        std::cerr << "No requests were answered." << std::endl;
+        return 1;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double q) {
+        return latencies[std::min(latencies.size() - 1, size_t(q * latencies.size()))];
+    };
+    std::cout << latencies.size() << " requests over " << connections << " connections at depth " << depth
+              << " in " << seconds << " s: " << latencies.size() / seconds << " requests/s, "
+              << answer_bytes / seconds / 1e6 << " MB/s of answers." << std::endl;
+    std::cout << "Latency (us): p50 " << percentile(0.50) << ", p90 " << percentile(0.90) << ", p99 "
+              << percentile(0.99) << ", p99.9 " << percentile(0.999) << ", max " << latencies.back() << "." << std::endl;
+    if (errors > 0 || failed > 0)
+        std::cout << errors << " ERR answers; " << failed << " connections broke." << std::endl;
+    return failed > 0 ? 1 : 0;
+}
+
+int ConnectTo(const std::string& socket_path) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        std::cerr << "Cannot connect to " << socket_path << ": " << strerror(errno) << std::endl;
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+std::string MakeRequest(const std::string& query, long i, int range_percent, int prefix_percent) {
+    int roll = int((i * 37) % 100);     // Spreads the RANGE and PREFIX requests evenly over the run
+    if (roll < range_percent) {
+        std::string upper = query;
+        upper.back()++;
+        return "RANGE " + query + " " + upper + "\n";
+    }
+    if (roll < range_percent + prefix_percent)
+        return "PREFIX " + query.substr(0, std::max<size_t>(1, query.size() - 2)) + "\n";
+    return "GET " + query + "\n";
+}
+
+void RunConnection(const std::string& socket_path, const std::vector<std::string>& queries, int c, long requests,
+                   int depth, int range_percent, int prefix_percent, ConnectionResult& result) {
+    int fd = ConnectTo(socket_path);
+    if (fd < 0) {
+        result.failed_ = true;
+        return;
+    }
+    result.latencies_.reserve(requests);
+    std::deque<std::chrono::steady_clock::time_point> sent_at;     // Of the requests in flight, oldest first
+    std::string in;                                                 // Bytes read but not yet parsed
+    size_t parsed = 0;
+    long sent = 0, answered = 0;
+    char buffer[65536];
+    while (answered < requests) {
+        std::string out;
+        while (sent < requests && long(sent_at.size()) < depth) {
+            out += MakeRequest(queries[(c + sent * 7919) % queries.size()], sent, range_percent, prefix_percent);
+            sent_at.push_back(std::chrono::steady_clock::now());
+            sent++;
+        }
+        for (size_t written = 0; written < out.size(); ) {
+            ssize_t n = send(fd, out.data() + written, out.size() - written, MSG_NOSIGNAL);
+            if (n <= 0) {
+                result.failed_ = true;
+                close(fd);
+                return;
+            }
+            written += n;
+        }
+
+        // Read until at least one whole answer is in, then take every whole answer there is.
+        bool took_one = false;
+        while (!took_one) {
+            for (;;) {
+                size_t newline = in.find('\n', parsed);
+                if (newline == std::string::npos)
+                    break;
+                size_t length = 0;
+                if (in.compare(parsed, 3, "OK ") == 0) {
+                    length = strtoul(in.c_str() + parsed + 3, nullptr, 10);
+                    if (in.size() - newline - 1 < length)
+                        break;
+                    result.answer_bytes_ += length;
+                }
+                else
+                    result.errors_++;
+                parsed = newline + 1 + length;
+                result.latencies_.push_back(std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - sent_at.front()).count());
+                sent_at.pop_front();
+                answered++;
+                took_one = true;
+            }
+            in.erase(0, parsed);
+            parsed = 0;
+            if (took_one)
+                break;
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                result.failed_ = true;
+                close(fd);
+                return;
+            }
+            in.append(buffer, n);
+        }
+    }
+    close(fd);
+}
+
+void CheckFile(const std::string& filename) {
+    std::ifstream inStream(filename);
+    if (inStream.fail()) {
+        std::cerr << "Filename not found." << std::endl;
+        exit(1);
+    }
+}
+
+std::vector<std::string> ReadQueries(const std::string& query_filename) {
+    std::ifstream inStream(query_filename);
+    std::vector<std::string> queries;
+    std::string sequence;
+    while (std::getline(inStream, sequence))
+        if (!sequence.empty())
+            queries.push_back(sequence);
+    return queries;
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -3,22 +3,109 @@
  Author: Emma Kimlin
  Created on: February 28th, 2016
  Description: This is a test program that makes use of a parser to input data from a file and into a BST or AVL tree. 
-        The user can then query the tree using recognition sequences.
- Usage: QueryTrees <database filename> <flag>, where <flag> is either "BST" or "AVL"
+        The user can then query the tree using enzyme acronyms or recognition sequences. Entering RELOAD re-reads the
+        database file in the background and swaps the new tree in without interrupting queries.
+ Usage: QueryTrees <database filename> <flag> [-memory=MB] [-cache=N], where <flag> is either "BST", "AVL", "HASH",
+        "DISK" or "SKIP"
+        -memory=MB  Let the DISK tree keep at most MB megabytes of pages in memory (default 64).
+        -cache=N    Keep the answers to up to N recognition sequences in a LookupCache; RELOAD starts a new cache.
  Build with: make QueryTrees
  Modifications:
     3.1.2016, Emma Kimlin: Debugged FillTree() and added functionality to insert into AVL Tree.
     3.6.2016, Emma Kimlin: Modified FillTree() so that it skips over header. 
     3.8.2016 Made class QueryTree so that this is neater. 
+    10.19.2026: Added the HASH tree type for O(1) exact lookups.
+    10.19.2026: TestQueryTree() answers enzyme acronyms through the tree's acronym index.
+    10.19.2026: Queries run against a ReloadableTree; added the RELOAD command.
+    10.19.2026: Added the DISK tree type (DiskBPlusTree) and the -memory=MB option. FillTree() uses the tree's bulk
+                loader when it has one.
+    10.19.2026: Added the SKIP tree type (LockFreeSkipList).
+    10.19.2026: FillTree() moves each SequenceMap into the tree instead of copying it.
+    10.19.2026: Added the -cache=N option.
  */
 
 #include "BinarySearchTree.h"
 #include "AvlTree.h"
+#include "HashTable.h"
 #include "SequenceMap.h"
+#include "ReloadableTree.h"
+#include "DiskBPlusTree.h"
+#include "LockFreeSkipList.h"
+#include "LookupCache.h"
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <fstream>
 #include <stdlib.h>
+#include <memory>
+
+/**
+  * Turns on the tree's acronym index. Post-Condition: Returns false for tree types that have none.
+ */
+template <typename TreeType>
+auto EnableAcronymIndex(TreeType& a_tree, int) -> decltype(a_tree.enable_Acronym_Index(), bool()) {
+    a_tree.enable_Acronym_Index();
+    return true;
+}
+template <typename TreeType>
+bool EnableAcronymIndex(TreeType&, long) {
+    return false;
+}
+
+/**
+  * Prints the recognition sequences of acronym if a_tree has an acronym index that knows it.
+  * Post-Condition: Returns false if nothing was printed.
+ */
+template <typename TreeType>
+auto PrintAcronym(const TreeType& a_tree, const std::string& acronym, int) -> decltype(a_tree.find_Acronym(acronym), bool()) {
+    const std::vector<std::string> *sequences = a_tree.find_Acronym(acronym);
+    if (sequences == nullptr)
+        return false;
+    for (size_t i = 0; i < sequences->size(); i++)
+        std::cout << (*sequences)[i] << " ";
+    std::cout << std::endl;
+    return true;
+}
+template <typename TreeType>
+bool PrintAcronym(const TreeType&, const std::string&, long) {
+    return false;
+}
+
+/**
+  * Limits the memory a disk-backed tree keeps its pages in. Post-Condition: Returns false for in-memory trees.
+ */
+template <typename TreeType>
+auto SetMemoryBudget(TreeType& a_tree, size_t bytes, int) -> decltype(a_tree.set_Memory_Budget(bytes), bool()) {
+    a_tree.set_Memory_Budget(bytes);
+    return true;
+}
+template <typename TreeType>
+bool SetMemoryBudget(TreeType&, size_t, long) {
+    return false;
+}
+
+/**
+  * Adds elements to a tree by insert(), for FillTree() on trees without a bulk loader.
+ */
+template <typename TreeType>
+struct InsertLoader {
+    TreeType& a_tree;
+    void add(SequenceMap&& x) { a_tree.insert(std::move(x)); }
+    void finish() {}
+};
+
+/**
+  * Returns the tree's bulk loader if it has one, which builds the tree when finish() is called, else an
+  * InsertLoader. Either way the tree ends up holding the same elements.
+ */
+template <typename TreeType>
+auto MakeLoader(TreeType& a_tree, int) -> decltype(a_tree.bulk_Loader()) {
+    return a_tree.bulk_Loader();
+}
+template <typename TreeType>
+InsertLoader<TreeType> MakeLoader(TreeType& a_tree, long) {
+    return InsertLoader<TreeType>{a_tree};
+}
 
 template <typename TreeType>
 class QueryTree {
@@ -26,19 +113,36 @@ public:
     /**
       * One Parameter Constructor
      */
-    QueryTree(std::string filename) {
-        db_filename = filename;
-        CheckFile();
-        FillTree();
-    }
+    QueryTree(std::string filename, size_t memory = 0, size_t cache_size = 0)
+        : db_filename(filename), memory_budget(memory), cache_entries(cache_size), trees(BuildTree()) {}
     /**
-      * TestQueryTree allows user to query a tree using a recognition sequence that they will be prompted to enter at
-      * keyboard. 
+      * TestQueryTree allows user to query a tree using an enzyme acronym or a recognition sequence that they will be 
+      * prompted to enter at keyboard. An acronym prints the sequences it recognizes; a sequence prints its enzymes.
     */
     void TestQueryTree();
 private:
     std::string db_filename;
-    TreeType a_tree;
+    size_t memory_budget;           // Bytes a disk-backed tree may keep in memory; 0 leaves the tree's default
+    size_t cache_entries;           // Answers the cache may hold; 0 turns the cache off
+    ReloadableTree<TreeType> trees;
+    std::unique_ptr<LookupCache<std::shared_ptr<const std::string> > > cache;
+    std::weak_ptr<const TreeType> cached_tree;                  //The tree the cached answers came from
+    /**
+      * Checks db_filename and returns a new tree filled from it.
+     */
+    std::shared_ptr<const TreeType> BuildTree();
+
+    /**
+      * Starts rebuilding the tree from db_filename in the background. Queries keep using the current tree until
+      *     the new one is published.
+     */
+    void Reload();
+
+    /**
+      * Prints what a_tree->find_and_print(rec_seq) would, from the cache when it is on and holds the answer.
+     */
+    void FindAndPrint(const std::shared_ptr<const TreeType>& a_tree, const std::string& rec_seq);
+
     /**
       * Takes the input from db_filename, parses it and stores it in either an AVL Tree or BST made of
       *     SequenceMap objects.
@@ -46,7 +150,7 @@ private:
       *     Each line in db_filename in this format: EnzymeAcronym/Sequence1/Sequence2/.../Sequence n//
       *     The file provided has a 10 line header that will be skipped over. 
      */
-    void FillTree();
+    void FillTree(TreeType& a_tree);
 
     /** 
      * Checks to make sure a file opens and issues an error message if not.
@@ -69,8 +173,19 @@ private:
 };
 
 int main(int argc, char **argv) {
-    if (argc != 3) {
-        std::cout << "Usage: " << argv[0] << " <databasefilename> <tree-type>" << std::endl;
+    size_t memory_budget = 0, cache_entries = 0;
+    bool usable = argc >= 3;
+    for (int i = 3; i < argc && usable; i++) {
+        std::string option(argv[i]);
+        if (option.compare(0, 8, "-memory=") == 0 && atof(argv[i] + 8) > 0)
+            memory_budget = size_t(atof(argv[i] + 8) * (1 << 20));
+        else if (option.compare(0, 7, "-cache=") == 0 && atoi(argv[i] + 7) > 0)
+            cache_entries = atoi(argv[i] + 7);
+        else
+            usable = false;
+    }
+    if (!usable) {
+        std::cout << "Usage: " << argv[0] << " <databasefilename> <tree-type> [-memory=MB] [-cache=N]" << std::endl;
         return 0;
     }
     std::string db_filename(argv[1]);
@@ -79,14 +194,26 @@ int main(int argc, char **argv) {
     
     if (param_tree == "BST") {
         std::cout << "I will run the BST code" << std::endl;
-        QueryTree<BinarySearchTree<SequenceMap> > a_tree(db_filename);
+        QueryTree<BinarySearchTree<SequenceMap> > a_tree(db_filename, 0, cache_entries);
         a_tree.TestQueryTree();
     } else if (param_tree == "AVL") {
         std::cout << "I will run the AVL code" << std::endl;
-        QueryTree<AvlTree<SequenceMap> > a_tree(db_filename);
+        QueryTree<AvlTree<SequenceMap> > a_tree(db_filename, 0, cache_entries);
+        a_tree.TestQueryTree();
+    } else if (param_tree == "HASH") {
+        std::cout << "I will run the HASH code" << std::endl;
+        QueryTree<HashTable<SequenceMap> > a_tree(db_filename, 0, cache_entries);
+        a_tree.TestQueryTree();
+    } else if (param_tree == "DISK") {
+        std::cout << "I will run the DISK code" << std::endl;
+        QueryTree<DiskBPlusTree<SequenceMap> > a_tree(db_filename, memory_budget, cache_entries);
+        a_tree.TestQueryTree();
+    } else if (param_tree == "SKIP") {
+        std::cout << "I will run the SKIP code" << std::endl;
+        QueryTree<LockFreeSkipList<SequenceMap> > a_tree(db_filename, 0, cache_entries);
         a_tree.TestQueryTree();
     } else
-        std::cout << "Unknown tree type " << param_tree << " (User should provide BST, or AVL)" << std::endl;
+        std::cout << "Unknown tree type " << param_tree << " (User should provide BST, AVL, HASH, DISK, or SKIP)" << std::endl;
     
     return 0;
 }
@@ -101,7 +228,53 @@ void QueryTree<TreeType>::CheckFile() {
 }
 
 template <typename TreeType>
-void QueryTree<TreeType>::FillTree () {
+std::shared_ptr<const TreeType> QueryTree<TreeType>::BuildTree() {
+    CheckFile();
+    std::shared_ptr<TreeType> a_tree = std::make_shared<TreeType>();
+    FillTree(*a_tree);
+    return a_tree;
+}
+
+template <typename TreeType>
+void QueryTree<TreeType>::Reload() {
+    if (ifstream(db_filename).fail()) {
+        std::cout << "Cannot open " << db_filename << "; still serving the current tree." << std::endl;
+        return;
+    }
+    if (trees.isReloading()) {
+        std::cout << "A reload is already running." << std::endl;
+        return;
+    }
+    std::cout << "Reloading " << db_filename << " in the background." << std::endl;
+    trees.reload([this](TreeType& a_tree) {
+        FillTree(a_tree);
+        std::cout << "Reload of " << db_filename << " finished; queries now use the new tree." << std::endl;
+    });
+}
+
+template <typename TreeType>
+void QueryTree<TreeType>::FindAndPrint(const std::shared_ptr<const TreeType>& a_tree, const std::string& rec_seq) {
+    if (cache_entries == 0) {
+        a_tree->find_and_print(rec_seq);
+        return;
+    }
+    if (!cache || cached_tree.owner_before(a_tree) || a_tree.owner_before(cached_tree)) {   //A reload swapped trees
+        cache.reset(new LookupCache<std::shared_ptr<const std::string> >(cache_entries));
+        cached_tree = a_tree;
+    }
+    std::cout << *cache->lookup(rec_seq, [&]() {
+        std::ostringstream rendered;
+        a_tree->find_and_print(rec_seq, rendered);
+        return std::make_shared<const std::string>(rendered.str());
+    });
+}
+
+template <typename TreeType>
+void QueryTree<TreeType>::FillTree (TreeType& a_tree) {
+    EnableAcronymIndex(a_tree, 0);
+    if (memory_budget > 0)
+        SetMemoryBudget(a_tree, memory_budget, 0);
+    auto loader = MakeLoader(a_tree, 0);
     ifstream inStream(db_filename);
     std::string db_line, an_enz_acro, a_reco_seq, garbage_line;
     for (int i = 0; i < 10; i ++)                               //Skip over the header and begin reading on line 11. 
@@ -112,9 +285,10 @@ void QueryTree<TreeType>::FillTree () {
         an_enz_acro = GetEnzymeAcronym(db_line, first_slash);
         while (GetNextRecognitionSequence(db_line, a_reco_seq, first_slash)) {
             SequenceMap new_sequence_map(a_reco_seq, an_enz_acro);
-            a_tree.insert(new_sequence_map);
+            loader.add(std::move(new_sequence_map));
         }
     }
+    loader.finish();
 }
 
 template <typename TreeType>
@@ -142,9 +316,16 @@ void QueryTree<TreeType>::TestQueryTree() {
     char ans;
     std::string rec_seq;
     do {
-        std::cout << "Query this tree by entering one enzyme acronym and pressing 'Enter'\n" << std::endl;
+        std::cout << "Query this tree by entering one enzyme acronym and pressing 'Enter'\n"
+                  << "(or enter RELOAD to re-read the database in the background)\n" << std::endl;
         std::cin >> rec_seq;
-        a_tree.find_and_print(rec_seq);
+        if (rec_seq == "RELOAD")
+            Reload();
+        else {
+            std::shared_ptr<const TreeType> a_tree = trees.acquire();   //Stays valid even if a reload swaps trees now
+            if (!PrintAcronym(*a_tree, rec_seq, 0))         //Not a known acronym, so treat it as a recognition sequence
+                FindAndPrint(a_tree, rec_seq);
+        }
         std::cout << "Would you like to query this tree again? Enter 'N' if no, \n"
                   << "and any other letter if yes." << std::endl;
         std::cin >> ans;
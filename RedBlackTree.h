@@ -0,0 +1,550 @@
+/*
+ Title: RedBlackTree.h
+ Description: A red-black tree with the same driver interface as AvlTree. A red-black tree keeps a looser balance
+        than an AVL tree (no path is more than twice as long as another, against about 1.44 log2 n for AVL), and in
+        return an insert does at most two rotations and a remove at most three, where an AVL remove may rotate at
+        every level on the way back up. That makes it the cheaper choice for write-heavy workloads; lookups cost a
+        little more because the tree is a little deeper.
+        Nodes keep a parent link so that rebalancing walks back up without recursion. Empty links count as black.
+ Modifications:
+    10.19.26: Added dump_stats() and reset_stats(). With TREE_STATS defined, insert(), find(), remove() and
+              print_Between() record their latency and probe depth (see OpStats.h).
+    10.19.26: Added find_and_print( x, out ), which writes to a given stream.
+    10.19.26: insert() of an rvalue Merge()s a duplicate by move.
+ */
+#ifndef RED_BLACK_TREE_H
+#define RED_BLACK_TREE_H
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+#include "ForkJoin.h"
+#include "OpStats.h"
+
+// RedBlackTree class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// void insert( x )       --> Insert x; Merge() into the existing element if x's key is present
+// void remove( x )       --> Remove x
+// bool remove( x, i)     --> If x is found in tree, it is removed and call returns true. i is the number of nodes
+//                            visited, counted as in AvlTree::remove( )
+// bool find( x, i )      --> Returns true if x is present; i is the number of recursion calls, as in AvlTree::find( )
+// void find_and_print( x)--> Prints vector associated with x if x is present
+// find_and_print( x, out )-> same, written to stream out
+// boolean isEmpty( )     --> Return true if empty; else false
+// void makeEmpty( )      --> Remove all items
+// void printTree( )      --> Print tree in sorted order
+// int count_Nodes( )     --> Return number of nodes
+// int calculate_IPL()    --> Return Internal Path Length
+// int calculate_Avg_Depth()-> Return Average Depth of all Nodes
+// double calculate_ratio()-> Return Ratio of Avg Depth to log2n
+// int heightOfTree( )    --> Return height of the tree; -1 if empty
+// long rotation_Count( ) --> Return number of single rotations done so far
+// print_Between(k1, k2)  --> prints all elements with keys between k1 and k2
+// print_Between(k1, k2, out)--> same, written to stream out
+// void dump_stats( out ) --> Write per-operation latency and probe-depth statistics to out as JSON (TREE_STATS)
+// void reset_stats( )    --> Clear the statistics
+// ******************ERRORS********************************
+// None
+
+template <typename Comparable>
+class RedBlackTree
+{
+  public:
+    RedBlackTree( ) : root_{ nullptr }, rotations_{ 0 }
+      { }
+
+    RedBlackTree( const RedBlackTree & rhs ) : root_{ clone( rhs.root_ ) }, rotations_{ 0 }
+      { }
+
+    RedBlackTree( RedBlackTree && rhs ) : root_{ rhs.root_ }, rotations_{ rhs.rotations_ }
+    {
+        rhs.root_ = nullptr;
+    }
+
+    ~RedBlackTree( )
+    {
+        makeEmpty( );
+    }
+
+    RedBlackTree & operator=( const RedBlackTree & rhs )
+    {
+        RedBlackTree copy = rhs;
+        std::swap( *this, copy );
+        return *this;
+    }
+
+    RedBlackTree & operator=( RedBlackTree && rhs )
+    {
+        std::swap( root_, rhs.root_ );
+        std::swap( rotations_, rhs.rotations_ );
+        return *this;
+    }
+
+    /**
+     * Insert x into the tree; a duplicate key is merged into the existing element.
+     * This function assumes all Comparables have a Merge() function.
+     */
+    void insert( const Comparable & x )
+    {
+        OpStats::Timer timer{ stats_, OpStats::INSERT };
+        insertNode( x );
+    }
+
+    void insert( Comparable && x )
+    {
+        OpStats::Timer timer{ stats_, OpStats::INSERT };
+        insertNode( std::move( x ) );
+    }
+
+    /**
+     * Remove x from the tree. Nothing is done if x is not found.
+     */
+    void remove( const Comparable & x )
+    {
+        int recursion_calls = 0;
+        remove( x.getRecSequence( ), recursion_calls );
+    }
+
+    /**
+      * Remove x from the tree.
+      * Post-Condition: If x is not found, returns false. recursion_calls is the number of nodes visited looking for
+      * x, plus one for the empty link reached when x is not present, plus the nodes visited finding x's successor.
+     */
+    bool remove( const std::string & x, int & recursion_calls )
+    {
+        OpStats::Timer timer{ stats_, OpStats::REMOVE, &recursion_calls };
+        recursion_calls = 0;
+        RbNode *t = findNode( x, recursion_calls );
+        if( t == nullptr )
+            return false;
+        eraseNode( t, recursion_calls );
+        return true;
+    }
+
+    /**
+      * Post-Condition: Returns true if x is found. recursion_calls is the number of nodes visited, plus one for the
+      * empty link reached when x is not present.
+     */
+    bool find( const std::string & x, int & recursion_calls ) const
+    {
+        OpStats::Timer timer{ stats_, OpStats::FIND, &recursion_calls };
+        recursion_calls = 0;
+        return findNode( x, recursion_calls ) != nullptr;
+    }
+
+    /**
+      * If x is located in the tree, its associated vector is printed.
+     */
+    void find_and_print( const std::string & x ) const
+    {
+        find_and_print( x, std::cout );
+    }
+
+    void find_and_print( const std::string & x, std::ostream & out ) const
+    {
+        int recursion_calls = 0;
+        RbNode *t = findNode( x, recursion_calls );
+        if( t != nullptr )
+            t->element_.Print_Vector( out );
+        else
+            out << "Not found in this tree." << std::endl;
+    }
+
+    bool isEmpty( ) const
+    {
+        return root_ == nullptr;
+    }
+
+    void makeEmpty( )
+    {
+        ParallelFold<int>( root_, 0, [ ]( RbNode *node, int, int, int ) { delete node; return 0; } );
+        root_ = nullptr;
+    }
+
+    /**
+     * Print the tree contents in sorted order.
+     */
+    void printTree( ) const
+    {
+        if( isEmpty( ) )
+            std::cout << "Empty tree" << std::endl;
+        else
+            ParallelInorder( root_, std::cout, [ ]( const RbNode *node, std::ostream & out ) { out << node->element_ << " "; } );
+        std::cout << std::endl;
+    }
+
+    int count_Nodes( ) const
+    {
+        return ParallelFold<int>( root_, 0, [ ]( RbNode *, int, int left_count, int right_count ) { return left_count + right_count + 1; } );
+    }
+
+    int calculate_IPL( ) const
+    {
+        return ParallelFold<int>( root_, 0, [ ]( RbNode *, int depth, int left_ipl, int right_ipl ) { return left_ipl + right_ipl + depth; } );
+    }
+
+    int calculate_Avg_Depth( ) const
+    {
+        return calculate_IPL( ) / count_Nodes( );
+    }
+
+    double calculate_ratio( ) const
+    {
+        return calculate_Avg_Depth( ) / log2( count_Nodes( ) );
+    }
+
+    int heightOfTree( ) const
+    {
+        return ParallelFold<int>( root_, 0, [ ]( RbNode *, int, int left_levels, int right_levels )
+            { return std::max( left_levels, right_levels ) + 1; } ) - 1;
+    }
+
+    /**
+     * Returns the number of single rotations done by insert() and remove() so far; a double rotation counts as two.
+     */
+    long rotation_Count( ) const
+    {
+        return rotations_;
+    }
+
+    /**
+      * Prints all elements in tree between the value str1 and str2.
+     */
+    void print_Between( const std::string & str1, const std::string & str2 ) const
+    {
+        print_Between( str1, str2, std::cout );
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2, std::ostream & out ) const
+    {
+        OpStats::Timer timer{ stats_, OpStats::RANGE };
+        print_Between( str1, str2, root_, out );
+    }
+
+    /**
+      * Writes the latency percentiles, throughput and probe-depth distribution of each operation as JSON.
+      * Writes { "enabled": false } unless compiled with TREE_STATS.
+     */
+    void dump_stats( std::ostream & out = std::cout ) const
+    {
+        stats_.dump( out );
+    }
+
+    void reset_stats( )
+    {
+        stats_.reset( );
+    }
+
+  private:
+    struct RbNode
+    {
+        Comparable element_;
+        RbNode *left_;
+        RbNode *right_;
+        RbNode *parent_;
+        bool red_;
+
+        RbNode( const Comparable & ele, RbNode *lt, RbNode *rt, RbNode *pt, bool red )
+          : element_{ ele }, left_{ lt }, right_{ rt }, parent_{ pt }, red_{ red } { }
+
+        RbNode( Comparable && ele, RbNode *lt, RbNode *rt, RbNode *pt, bool red )
+          : element_{ std::move( ele ) }, left_{ lt }, right_{ rt }, parent_{ pt }, red_{ red } { }
+    };
+
+    RbNode *root_;
+    long rotations_;
+    mutable OpStats stats_;
+
+    static bool isRed( const RbNode *t )
+    {
+        return t != nullptr && t->red_;
+    }
+
+    /**
+     * Internal method to find the node with key x, or nullptr. recursion_calls is increased as in find().
+     */
+    RbNode * findNode( const std::string & x, int & recursion_calls ) const
+    {
+        RbNode *t = root_;
+        for( ;; )
+        {
+            ++recursion_calls;
+            if( t == nullptr || x == t->element_.getRecSequence( ) )
+                return t;
+            t = x < t->element_.getRecSequence( ) ? t->left_ : t->right_;
+        }
+    }
+
+    /**
+     * Internal method to insert x as a red leaf, or to merge it into the element with the same key, and then
+     * restore the red-black properties.
+     */
+    template <typename X>
+    void insertNode( X && x )
+    {
+        RbNode *parent = nullptr;
+        RbNode **link = &root_;
+        while( *link != nullptr )
+        {
+            parent = *link;
+            if( x.getRecSequence( ) < parent->element_.getRecSequence( ) )
+                link = &parent->left_;
+            else if( parent->element_.getRecSequence( ) < x.getRecSequence( ) )
+                link = &parent->right_;
+            else
+            {
+                parent->element_.Merge( std::forward<X>( x ) );
+                return;
+            }
+        }
+        *link = new RbNode{ std::forward<X>( x ), nullptr, nullptr, parent, true };
+        insertFixup( *link );
+    }
+
+    /**
+     * Internal method to repair a red node z whose parent may also be red. Recolouring moves the violation up two
+     * levels at a time; at most two rotations end it.
+     */
+    void insertFixup( RbNode *z )
+    {
+        while( isRed( z->parent_ ) )
+        {
+            RbNode *parent = z->parent_;
+            RbNode *grandparent = parent->parent_;      // Exists, since a red node is never the root
+            if( parent == grandparent->left_ )
+            {
+                RbNode *uncle = grandparent->right_;
+                if( isRed( uncle ) )
+                {
+                    parent->red_ = uncle->red_ = false;
+                    grandparent->red_ = true;
+                    z = grandparent;
+                    continue;
+                }
+                if( z == parent->right_ )
+                {
+                    rotateLeft( parent );
+                    parent = z;
+                }
+                parent->red_ = false;
+                grandparent->red_ = true;
+                rotateRight( grandparent );
+                break;
+            }
+            else
+            {
+                RbNode *uncle = grandparent->left_;
+                if( isRed( uncle ) )
+                {
+                    parent->red_ = uncle->red_ = false;
+                    grandparent->red_ = true;
+                    z = grandparent;
+                    continue;
+                }
+                if( z == parent->left_ )
+                {
+                    rotateRight( parent );
+                    parent = z;
+                }
+                parent->red_ = false;
+                grandparent->red_ = true;
+                rotateLeft( grandparent );
+                break;
+            }
+        }
+        root_->red_ = false;
+    }
+
+    /**
+     * Internal method to unlink and delete node z. A node with two children is replaced by its successor, whose
+     * search adds to recursion_calls.
+     */
+    void eraseNode( RbNode *z, int & recursion_calls )
+    {
+        RbNode *x, *x_parent;       // The node that takes the removed node's place, which may be empty, and its parent
+        bool removed_black = !z->red_;
+        if( z->left_ == nullptr || z->right_ == nullptr )
+        {
+            x = z->left_ != nullptr ? z->left_ : z->right_;
+            x_parent = z->parent_;
+            transplant( z, x );
+        }
+        else
+        {
+            RbNode *successor = z->right_;
+            for( ++recursion_calls; successor->left_ != nullptr; ++recursion_calls )
+                successor = successor->left_;
+            removed_black = !successor->red_;
+            x = successor->right_;
+            if( successor->parent_ == z )
+                x_parent = successor;
+            else
+            {
+                x_parent = successor->parent_;
+                transplant( successor, x );
+                successor->right_ = z->right_;
+                successor->right_->parent_ = successor;
+            }
+            transplant( z, successor );
+            successor->left_ = z->left_;
+            successor->left_->parent_ = successor;
+            successor->red_ = z->red_;
+        }
+        delete z;
+        if( removed_black )
+            eraseFixup( x, x_parent );
+    }
+
+    /**
+     * Internal method to repair the black height after a black node was removed above x, which may be empty.
+     * x_parent is x's parent, needed because x itself may be nullptr.
+     */
+    void eraseFixup( RbNode *x, RbNode *x_parent )
+    {
+        while( x != root_ && !isRed( x ) )
+        {
+            if( x == x_parent->left_ )
+            {
+                RbNode *sibling = x_parent->right_;     // Not empty: it carries the black height x lost
+                if( isRed( sibling ) )
+                {
+                    sibling->red_ = false;
+                    x_parent->red_ = true;
+                    rotateLeft( x_parent );
+                    sibling = x_parent->right_;
+                }
+                if( !isRed( sibling->left_ ) && !isRed( sibling->right_ ) )
+                {
+                    sibling->red_ = true;
+                    x = x_parent;
+                    x_parent = x->parent_;
+                    continue;
+                }
+                if( !isRed( sibling->right_ ) )
+                {
+                    sibling->left_->red_ = false;
+                    sibling->red_ = true;
+                    rotateRight( sibling );
+                    sibling = x_parent->right_;
+                }
+                sibling->red_ = x_parent->red_;
+                x_parent->red_ = false;
+                sibling->right_->red_ = false;
+                rotateLeft( x_parent );
+            }
+            else
+            {
+                RbNode *sibling = x_parent->left_;
+                if( isRed( sibling ) )
+                {
+                    sibling->red_ = false;
+                    x_parent->red_ = true;
+                    rotateRight( x_parent );
+                    sibling = x_parent->left_;
+                }
+                if( !isRed( sibling->left_ ) && !isRed( sibling->right_ ) )
+                {
+                    sibling->red_ = true;
+                    x = x_parent;
+                    x_parent = x->parent_;
+                    continue;
+                }
+                if( !isRed( sibling->left_ ) )
+                {
+                    sibling->right_->red_ = false;
+                    sibling->red_ = true;
+                    rotateLeft( sibling );
+                    sibling = x_parent->left_;
+                }
+                sibling->red_ = x_parent->red_;
+                x_parent->red_ = false;
+                sibling->left_->red_ = false;
+                rotateRight( x_parent );
+            }
+            x = root_;
+        }
+        if( x != nullptr )
+            x->red_ = false;
+    }
+
+    /**
+     * Internal method to put subtree v, which may be empty, in u's place under u's parent.
+     */
+    void transplant( RbNode *u, RbNode *v )
+    {
+        if( u->parent_ == nullptr )
+            root_ = v;
+        else if( u == u->parent_->left_ )
+            u->parent_->left_ = v;
+        else
+            u->parent_->right_ = v;
+        if( v != nullptr )
+            v->parent_ = u->parent_;
+    }
+
+    /**
+     * Rotate binary tree node k1 with its right child k2, which takes k1's place.
+     */
+    void rotateLeft( RbNode *k1 )
+    {
+        ++rotations_;
+        RbNode *k2 = k1->right_;
+        k1->right_ = k2->left_;
+        if( k2->left_ != nullptr )
+            k2->left_->parent_ = k1;
+        transplant( k1, k2 );
+        k2->left_ = k1;
+        k1->parent_ = k2;
+    }
+
+    /**
+     * Rotate binary tree node k2 with its left child k1, which takes k2's place.
+     */
+    void rotateRight( RbNode *k2 )
+    {
+        ++rotations_;
+        RbNode *k1 = k2->left_;
+        k2->left_ = k1->right_;
+        if( k1->right_ != nullptr )
+            k1->right_->parent_ = k2;
+        transplant( k2, k1 );
+        k1->right_ = k2;
+        k2->parent_ = k1;
+    }
+
+    /**
+     * Internal method to clone subtree; the copy's root has no parent.
+     */
+    RbNode * clone( RbNode *t ) const
+    {
+        return ParallelFold<RbNode *>( t, 0, [ ]( RbNode *node, int, RbNode *lt, RbNode *rt )
+        {
+            RbNode *copy = new RbNode{ node->element_, lt, rt, nullptr, node->red_ };
+            if( lt != nullptr )
+                lt->parent_ = copy;
+            if( rt != nullptr )
+                rt->parent_ = copy;
+            return copy;
+        } );
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2, const RbNode *t, std::ostream & out ) const
+    {
+        if( t != nullptr )
+        {
+            if( t->element_.getRecSequence( ) > str1 )
+                print_Between( str1, str2, t->left_, out );
+            if( t->element_.getRecSequence( ) > str1 && t->element_.getRecSequence( ) < str2 )
+                out << t->element_ << " ";
+            if( t->element_.getRecSequence( ) <= str2 )
+                print_Between( str1, str2, t->right_, out );
+        }
+    }
+};
+
+#endif
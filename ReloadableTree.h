@@ -0,0 +1,139 @@
+/*
+ Title: ReloadableTree.h
+ Description: Holds the tree that queries currently run against and replaces it without stopping them. A reload
+        builds a new tree on a background thread while readers keep using the current one, then publishes it with
+        a single atomic pointer store. Readers hold a shared_ptr to the tree they started on, so the old tree stays
+        alive until the last in-flight query finishes; the reload thread then destroys it, which keeps the cost
+        of tearing down a large tree off the query path.
+ Modifications:
+ */
+#ifndef RELOADABLE_TREE_H
+#define RELOADABLE_TREE_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <utility>
+
+// ReloadableTree class
+//
+// CONSTRUCTION: with the initial tree
+//
+// ******************PUBLIC OPERATIONS*********************
+// acquire( )             --> Return a reference-counted handle to the current tree
+// void publish( t )      --> Make t the current tree; the old one is freed once no reader holds it
+// bool reload( build )   --> Start build( tree ) on a background thread and publish the result;
+//                            returns false if a reload is already running
+// bool isReloading( )    --> Return true while a background reload is running
+// void waitForReload( )  --> Block until the background reload, if any, has finished
+// long generation( )     --> Return the number of trees published so far
+// ******************ERRORS********************************
+// None
+
+template <typename TreeType>
+class ReloadableTree
+{
+  public:
+    explicit ReloadableTree( std::shared_ptr<const TreeType> initial )
+      : current_{ std::move( initial ) }, reloading_{ false }, generation_{ 0 }
+      { }
+
+    ReloadableTree( const ReloadableTree & rhs ) = delete;
+    ReloadableTree & operator=( const ReloadableTree & rhs ) = delete;
+
+    ~ReloadableTree( )
+    {
+        waitForReload( );
+    }
+
+    /**
+      * Returns the current tree. The tree stays valid for as long as the caller keeps the handle, even if a newer
+      * tree is published in the meantime.
+     */
+    std::shared_ptr<const TreeType> acquire( ) const
+    {
+#if defined( __cpp_lib_atomic_shared_ptr )
+        return current_.load( std::memory_order_acquire );
+#else
+        return std::atomic_load_explicit( &current_, std::memory_order_acquire );
+#endif
+    }
+
+    /**
+      * Makes fresh the current tree with one atomic pointer store.
+      * Post-Condition: Returns the previous tree. Readers that acquired it before the store may still be using it.
+     */
+    std::shared_ptr<const TreeType> publish( std::shared_ptr<const TreeType> fresh )
+    {
+#if defined( __cpp_lib_atomic_shared_ptr )
+        std::shared_ptr<const TreeType> old = current_.exchange( std::move( fresh ), std::memory_order_acq_rel );
+#else
+        std::shared_ptr<const TreeType> old = std::atomic_exchange_explicit( &current_, std::move( fresh ), std::memory_order_acq_rel );
+#endif
+        ++generation_;
+        return old;
+    }
+
+    /**
+      * Builds a replacement tree on a background thread by calling build( tree ) on an empty TreeType, publishes
+      * it, and then waits for readers of the old tree to finish before destroying it on that same thread.
+      * Post-Condition: Returns false, and does nothing, if a reload is already running.
+     */
+    template <typename Builder>
+    bool reload( Builder build )
+    {
+        if( reloading_.exchange( true ) )
+            return false;
+        if( worker_.joinable( ) )
+            worker_.join( );
+        worker_ = std::thread( [ this, build ]( ) mutable
+        {
+            std::shared_ptr<TreeType> fresh = std::make_shared<TreeType>( );
+            build( *fresh );
+            std::shared_ptr<const TreeType> old = publish( std::move( fresh ) );
+            retire( std::move( old ) );
+            reloading_.store( false );
+        } );
+        return true;
+    }
+
+    bool isReloading( ) const
+    {
+        return reloading_.load( );
+    }
+
+    void waitForReload( )
+    {
+        if( worker_.joinable( ) )
+            worker_.join( );
+    }
+
+    long generation( ) const
+    {
+        return generation_.load( );
+    }
+
+  private:
+#if defined( __cpp_lib_atomic_shared_ptr )
+    std::atomic<std::shared_ptr<const TreeType>> current_;
+#else
+    std::shared_ptr<const TreeType> current_;      // Only accessed through the std::atomic_* shared_ptr functions
+#endif
+    std::atomic<bool> reloading_;
+    std::atomic<long> generation_;
+    std::thread worker_;
+
+    /**
+     * Internal method to wait until this thread holds the only reference to a tree that is no longer published,
+     * then destroy it. No new reader can acquire it, so the count only goes down.
+     */
+    static void retire( std::shared_ptr<const TreeType> old )
+    {
+        while( old.use_count( ) > 1 )
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        old.reset( );
+    }
+};
+
+#endif
@@ -4,9 +4,18 @@
  Created on: February 28th, 2016
  Description: A Sequence Map object holds the name of a restriction enzyme, and the possible DNA sites this enzyme may cut.
  Modifications:
+    10.19.2026: getRecSequence() returns a const reference so lookups do not copy the key on every compare.
+    10.19.2026: Added getEnzymeAcronyms() for the acronym index.
+    10.19.2026: Added Remove_Acronym() for applying database deltas.
+    10.19.2026: Added operator== for comparing database releases.
+    10.19.2026: Print_Vector() takes an optional output stream.
+    10.19.2026: Added Encode_Payload() and Decode_Payload() for storing SequenceMaps in DiskBPlusTree pages.
+    10.19.2026: Added Merge(SequenceMap&&), which moves the acronyms instead of copying them, and Add_Acronym().
  */
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #ifndef SequenceMap_h
@@ -36,6 +45,12 @@ public:
      */
     bool operator<(const SequenceMap &rhs) const {return recognition_sequence_ < rhs.recognition_sequence_;}
     
+    /**
+      * Purpose: The == operator tells whether two SequenceMap objects hold the same recognition sequence and the same
+      * enzyme acronyms in the same order.
+     */
+    bool operator==(const SequenceMap &rhs) const {return recognition_sequence_ == rhs.recognition_sequence_ && enzyme_acronym_ == rhs.enzyme_acronym_;}
+    
     /**
       * Purpose: The overloaded output operator allows user to print the contents of a Sequence_Map object
       * to the screen.
@@ -62,19 +77,89 @@ public:
             enzyme_acronym_.push_back(other_sequence.enzyme_acronym_[i]); //add the values in the argument's enzyme_acronym_ to the vector of the calling object's enzyme_acronym_
     }
 
+    /**
+      * Purpose: Merge() for an other_sequence about to be discarded: its acronyms are moved rather than copied, and
+      * its whole vector is taken over if the calling object has none.
+      * Post-Condition: As for Merge(const SequenceMap&), except that other_sequence is left with no acronyms.
+     */
+    void Merge(SequenceMap &&other_sequence)
+    {
+        if (enzyme_acronym_.empty())
+            enzyme_acronym_ = std::move(other_sequence.enzyme_acronym_);
+        else
+            for (std::string &acronym : other_sequence.enzyme_acronym_)
+                enzyme_acronym_.push_back(std::move(acronym));
+        other_sequence.enzyme_acronym_.clear();
+    }
+
+    /**
+      * Purpose: Add_Acronym appends acronym to the object's enzyme_acronym_, as Merge() would with a SequenceMap
+      * holding only acronym, without building one; for the merge functions given to a tree's upsert().
+     */
+    void Add_Acronym(std::string acronym)
+    {
+        enzyme_acronym_.push_back(std::move(acronym));
+    }
+
+    /**
+      * Purpose: Remove_Acronym removes one occurrence of acronym from the object's enzyme_acronym_.
+      * Post-Condition: Returns true if acronym was present and has been removed. Returns false, leaving the object
+      * unchanged, if it was not present. The object may be left with no acronyms.
+     */
+    bool Remove_Acronym(const std::string &acronym)
+    {
+        for (size_t i = 0; i < enzyme_acronym_.size(); i++)
+            if (enzyme_acronym_[i] == acronym) {
+                enzyme_acronym_.erase(enzyme_acronym_.begin() + i);
+                return true;
+            }
+        return false;
+    }
+
+    /**
+      * Appends the enzyme acronyms to out, each followed by a '/'. Acronyms never contain '/', since it separates
+      * them in the database file.
+     */
+    void Encode_Payload(std::string &out) const
+    {
+        for (size_t i = 0; i < enzyme_acronym_.size(); i++) {
+            out += enzyme_acronym_[i];
+            out += '/';
+        }
+    }
+
+    /**
+      * Returns the SequenceMap with recognition sequence a_rec_seq and the acronyms Encode_Payload() wrote to the
+      * length bytes at payload.
+     */
+    static SequenceMap Decode_Payload(const std::string &a_rec_seq, const char *payload, size_t length)
+    {
+        SequenceMap s_map;
+        s_map.recognition_sequence_ = a_rec_seq;
+        for (const char *start = payload, *end = payload + length; start < end; ) {
+            const char *slash = static_cast<const char *>(std::memchr(start, '/', end - start));
+            s_map.enzyme_acronym_.emplace_back(start, slash - start);
+            start = slash + 1;
+        }
+        return s_map;
+    }
+
     //Getter
-    std::string getRecSequence() const {return recognition_sequence_;}
+    const std::string& getRecSequence() const {return recognition_sequence_;}
+    const std::vector<std::string>& getEnzymeAcronyms() const {return enzyme_acronym_;}
     
     /**
       * Prints enzyme_acronym_ in order with each element seperated by space. Ends with a new line. 
      */
-    void Print_Vector() {
+    void Print_Vector(std::ostream& out = std::cout) const {
         for (int i = 0; i < enzyme_acronym_.size(); i++)
-            std::cout << enzyme_acronym_[i] << " ";
-        std::cout << std::endl;
+            out << enzyme_acronym_[i] << " ";
+        out << std::endl;
     }
     
 private:
+    SequenceMap() = default;
+
     std::string recognition_sequence_;
     std::vector<std::string> enzyme_acronym_;
 };
@@ -0,0 +1,204 @@
+/*
+ Title: ShardedIndex.h
+ Description: Splits the recognition-sequence keyspace into ranges at sorted splitter keys and keeps one tree and
+        one reader/writer lock per range, so writers to different ranges do not serialize on a single root. Point
+        operations lock only the shard that owns the key. print_Between() renders each overlapping shard as a task on
+        the shared fork-join pool into a buffer and prints the buffers in key order.
+        Splitters are usually taken from a sample of the keys with sample_Splitters(), so shards hold about the same
+        number of keys even though recognition sequences are far from uniformly distributed.
+ Modifications:
+    10.19.2026: print_Between() runs its shards on ForkJoinPool( ) instead of a new thread each, and a range within one
+                shard is printed directly.
+ */
+#ifndef SHARDED_INDEX_H
+#define SHARDED_INDEX_H
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ForkJoin.h"
+
+// ShardedIndex class
+//
+// CONSTRUCTION: with sorted splitter keys; n splitters make n + 1 shards.
+//               Shard i holds the keys in [ splitters[ i - 1 ], splitters[ i ] ).
+//
+// ******************PUBLIC OPERATIONS*********************
+// sample_Splitters( k, n )--> Return splitters that cut keys k into n ranges of about equal size
+// void insert( x )       --> Insert x into the shard that owns its key
+// bool remove( x, i )    --> Remove x from its shard; i is the number of recursion calls
+// bool find( x, i )      --> Return true if x is present; i is the number of recursion calls
+// void find_and_print( x)--> Prints vector associated with x if x is present
+// print_Between(k1, k2)  --> Prints all elements with keys between k1 and k2, shards searched in parallel
+// int count_Nodes( )     --> Return number of nodes in all shards
+// bool isEmpty( )        --> Return true if every shard is empty
+// void makeEmpty( )      --> Empty every shard
+// void printTree( )      --> Print every shard in key order
+// size_t shard_Count( )  --> Return number of shards
+// size_t shard_Of( x )   --> Return the index of the shard that owns key x
+// ******************ERRORS********************************
+// None. TreeType must provide the driver interface of AvlTree, including the const print_Between( k1, k2, out ).
+
+template <typename TreeType>
+class ShardedIndex
+{
+  public:
+    explicit ShardedIndex( std::vector<std::string> splitters ) : splitters_{ std::move( splitters ) }
+    {
+        for( size_t i = 0; i <= splitters_.size( ); ++i )
+            shards_.emplace_back( new Shard );
+    }
+
+    ShardedIndex( const ShardedIndex & rhs ) = delete;
+    ShardedIndex & operator=( const ShardedIndex & rhs ) = delete;
+
+    /**
+      * Returns at most shards - 1 distinct splitters taken at evenly spaced ranks of a sorted sample of keys.
+     */
+    static std::vector<std::string> sample_Splitters( const std::vector<std::string> & keys, size_t shards )
+    {
+        const size_t kSamplesPerShard = 64;
+        std::vector<std::string> sample;
+        size_t step = std::max<size_t>( 1, keys.size( ) / ( shards * kSamplesPerShard ) );
+        for( size_t i = 0; i < keys.size( ); i += step )
+            sample.push_back( keys[ i ] );
+        std::sort( sample.begin( ), sample.end( ) );
+        sample.erase( std::unique( sample.begin( ), sample.end( ) ), sample.end( ) );
+
+        std::vector<std::string> splitters;
+        for( size_t s = 1; s < shards && !sample.empty( ); ++s )
+        {
+            const std::string & splitter = sample[ s * sample.size( ) / shards ];
+            if( splitters.empty( ) || splitters.back( ) < splitter )
+                splitters.push_back( splitter );
+        }
+        return splitters;
+    }
+
+    template <typename Comparable>
+    void insert( Comparable && x )
+    {
+        Shard & shard = *shards_[ shard_Of( x.getRecSequence( ) ) ];
+        std::unique_lock<std::shared_mutex> guard{ shard.lock_ };
+        shard.tree_.insert( std::forward<Comparable>( x ) );
+    }
+
+    bool remove( const std::string & x, int & recursion_calls )
+    {
+        Shard & shard = *shards_[ shard_Of( x ) ];
+        std::unique_lock<std::shared_mutex> guard{ shard.lock_ };
+        return shard.tree_.remove( x, recursion_calls );
+    }
+
+    bool find( const std::string & x, int & recursion_calls ) const
+    {
+        const Shard & shard = *shards_[ shard_Of( x ) ];
+        std::shared_lock<std::shared_mutex> guard{ shard.lock_ };
+        return shard.tree_.find( x, recursion_calls );
+    }
+
+    void find_and_print( const std::string & x ) const
+    {
+        const Shard & shard = *shards_[ shard_Of( x ) ];
+        std::shared_lock<std::shared_mutex> guard{ shard.lock_ };
+        shard.tree_.find_and_print( x );
+    }
+
+    /**
+      * Prints all elements between str1 and str2. A range inside one shard is printed straight from it. Otherwise
+      * each shard whose range overlaps ( str1, str2 ) is searched by a task on ForkJoinPool( ) into a private buffer,
+      * and the buffers are then printed in shard order, which is key order.
+     */
+    void print_Between( const std::string & str1, const std::string & str2 ) const
+    {
+        size_t first = shard_Of( str1 ), last = shard_Of( str2 );
+        if( first >= last )
+        {
+            std::shared_lock<std::shared_mutex> guard{ shards_[ first ]->lock_ };
+            shards_[ first ]->tree_.print_Between( str1, str2, std::cout );
+            return;
+        }
+        std::vector<std::string> parts( last - first + 1 );
+        ForkJoinPool( ).parallel_For( first, last + 1, 1, [ & ]( size_t begin, size_t end, size_t )
+        {
+            for( size_t i = begin; i < end; ++i )
+            {
+                std::ostringstream out;
+                std::shared_lock<std::shared_mutex> guard{ shards_[ i ]->lock_ };
+                shards_[ i ]->tree_.print_Between( str1, str2, out );
+                parts[ i - first ] = out.str( );
+            }
+        } );
+        for( const std::string & part : parts )
+            std::cout << part;
+    }
+
+    int count_Nodes( ) const
+    {
+        int nodes = 0;
+        for( const std::unique_ptr<Shard> & shard : shards_ )
+        {
+            std::shared_lock<std::shared_mutex> guard{ shard->lock_ };
+            nodes += shard->tree_.count_Nodes( );
+        }
+        return nodes;
+    }
+
+    bool isEmpty( ) const
+    {
+        for( const std::unique_ptr<Shard> & shard : shards_ )
+        {
+            std::shared_lock<std::shared_mutex> guard{ shard->lock_ };
+            if( !shard->tree_.isEmpty( ) )
+                return false;
+        }
+        return true;
+    }
+
+    void makeEmpty( )
+    {
+        for( const std::unique_ptr<Shard> & shard : shards_ )
+        {
+            std::unique_lock<std::shared_mutex> guard{ shard->lock_ };
+            shard->tree_.makeEmpty( );
+        }
+    }
+
+    void printTree( ) const
+    {
+        for( const std::unique_ptr<Shard> & shard : shards_ )
+        {
+            std::shared_lock<std::shared_mutex> guard{ shard->lock_ };
+            if( !shard->tree_.isEmpty( ) )
+                shard->tree_.printTree( );
+        }
+    }
+
+    size_t shard_Count( ) const
+    {
+        return shards_.size( );
+    }
+
+    size_t shard_Of( const std::string & x ) const
+    {
+        return std::upper_bound( splitters_.begin( ), splitters_.end( ), x ) - splitters_.begin( );
+    }
+
+  private:
+    struct Shard
+    {
+        mutable std::shared_mutex lock_;
+        TreeType tree_;
+    };
+
+    const std::vector<std::string> splitters_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+#endif
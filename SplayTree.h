@@ -0,0 +1,337 @@
+/*
+ Title: SplayTree.h
+ Description: A top-down splay tree with the same driver interface as AvlTree. Every find(), insert() and remove()
+        splays the key it looked for, or the last node on its path, to the root, so keys that are queried often stay
+        a few links from the root. On skewed query loads, where a few enzymes' sites make up most lookups, this
+        gives shorter searches than a balanced tree; on uniform loads it costs a constant factor more.
+        Because find() restructures the tree it is not const, and a SplayTree cannot be searched by several threads
+        at once.
+ Modifications:
+    10.19.26: insert() of an rvalue Merge()s a duplicate by move.
+ */
+#ifndef SPLAY_TREE_H
+#define SPLAY_TREE_H
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+#include "ForkJoin.h"
+
+// SplayTree class
+//
+// CONSTRUCTION: zero parameter
+//
+// ******************PUBLIC OPERATIONS*********************
+// void insert( x )       --> Insert x; Merge() into the existing element if x's key is present
+// void remove( x )       --> Remove x
+// bool remove( x, i)     --> If x is found in tree, it is removed and call returns true.
+// bool find( x, i )      --> Splay x; returns true if x is present. i is the number of nodes compared against,
+//                            plus one if x is not present, as in AvlTree::find( )
+// void find_and_print( x)--> Prints vector associated with x if x is present
+// boolean isEmpty( )     --> Return true if empty; else false
+// void makeEmpty( )      --> Remove all items
+// void printTree( )      --> Print tree in sorted order
+// int count_Nodes( )     --> Return number of nodes
+// int calculate_IPL()    --> Return Internal Path Length
+// int calculate_Avg_Depth()-> Return Average Depth of all Nodes
+// double calculate_ratio()-> Return Ratio of Avg Depth to log2n
+// print_Between(k1, k2)  --> prints all elements with keys between k1 and k2
+// ******************ERRORS********************************
+// None
+
+template <typename Comparable>
+class SplayTree
+{
+  public:
+    SplayTree( ) : root_{ nullptr }
+      { }
+
+    SplayTree( const SplayTree & rhs ) : root_{ clone( rhs.root_ ) }
+      { }
+
+    SplayTree( SplayTree && rhs ) : root_{ rhs.root_ }
+    {
+        rhs.root_ = nullptr;
+    }
+
+    ~SplayTree( )
+    {
+        makeEmpty( );
+    }
+
+    SplayTree & operator=( const SplayTree & rhs )
+    {
+        SplayTree copy = rhs;
+        std::swap( *this, copy );
+        return *this;
+    }
+
+    SplayTree & operator=( SplayTree && rhs )
+    {
+        std::swap( root_, rhs.root_ );
+        return *this;
+    }
+
+    /**
+     * Insert x into the tree; a duplicate key is merged into the existing element.
+     * This function assumes all Comparables have a Merge() function.
+     */
+    void insert( const Comparable & x )
+    {
+        insertNode( x );
+    }
+
+    void insert( Comparable && x )
+    {
+        insertNode( std::move( x ) );
+    }
+
+    /**
+     * Remove x from the tree. Nothing is done if x is not found.
+     */
+    void remove( const Comparable & x )
+    {
+        int recursion_calls = 0;
+        remove( x.getRecSequence( ), recursion_calls );
+    }
+
+    /**
+      * Remove x from the tree.
+      * Post-Condition: If x is not found, returns false. recursion_calls is the number of nodes compared against
+      * while splaying.
+     */
+    bool remove( const std::string & x, int & recursion_calls )
+    {
+        recursion_calls = 0;
+        if( root_ == nullptr || !splay( x, root_, recursion_calls ) )
+            return false;
+        SplayNode *old_root = root_;
+        if( root_->left_ == nullptr )
+            root_ = root_->right_;
+        else
+        {
+            // Every key in the left subtree is less than x, so splaying x there brings its maximum to the top,
+            // which then has no right child.
+            root_ = root_->left_;
+            splay( x, root_, recursion_calls );
+            root_->right_ = old_root->right_;
+        }
+        delete old_root;
+        return true;
+    }
+
+    /**
+      * Splays x to the root if it is present, else the last node on its search path.
+      * Post-Condition: Returns true if x is found. recursion_calls is the number of nodes compared against, plus one
+      * for the empty link reached when x is not present.
+     */
+    bool find( const std::string & x, int & recursion_calls )
+    {
+        recursion_calls = 0;
+        if( root_ == nullptr )
+        {
+            recursion_calls = 1;
+            return false;
+        }
+        if( splay( x, root_, recursion_calls ) )
+            return true;
+        ++recursion_calls;
+        return false;
+    }
+
+    /**
+      * If x is located in the tree, its associated vector is printed.
+     */
+    void find_and_print( const std::string & x )
+    {
+        int recursion_calls = 0;
+        if( root_ != nullptr && splay( x, root_, recursion_calls ) )
+            root_->element_.Print_Vector( );
+        else
+            std::cout << "Not found in this tree." << std::endl;
+    }
+
+    bool isEmpty( ) const
+    {
+        return root_ == nullptr;
+    }
+
+    void makeEmpty( )
+    {
+        ParallelFold<int>( root_, 0, [ ]( SplayNode *node, int, int, int ) { delete node; return 0; } );
+        root_ = nullptr;
+    }
+
+    /**
+     * Print the tree contents in sorted order.
+     */
+    void printTree( ) const
+    {
+        if( isEmpty( ) )
+            std::cout << "Empty tree" << std::endl;
+        else
+            ParallelInorder( root_, std::cout, [ ]( const SplayNode *node, std::ostream & out ) { out << node->element_ << " "; } );
+        std::cout << std::endl;
+    }
+
+    int count_Nodes( ) const
+    {
+        return ParallelFold<int>( root_, 0, [ ]( SplayNode *, int, int left_count, int right_count ) { return left_count + right_count + 1; } );
+    }
+
+    int calculate_IPL( ) const
+    {
+        return ParallelFold<int>( root_, 0, [ ]( SplayNode *, int depth, int left_ipl, int right_ipl ) { return left_ipl + right_ipl + depth; } );
+    }
+
+    int calculate_Avg_Depth( ) const
+    {
+        return calculate_IPL( ) / count_Nodes( );
+    }
+
+    double calculate_ratio( ) const
+    {
+        return calculate_Avg_Depth( ) / log2( count_Nodes( ) );
+    }
+
+    /**
+      * Prints all elements in tree between the value str1 and str2.
+     */
+    void print_Between( const std::string & str1, const std::string & str2 ) const
+    {
+        print_Between( str1, str2, root_ );
+    }
+
+  private:
+    struct SplayNode
+    {
+        Comparable element_;
+        SplayNode *left_;
+        SplayNode *right_;
+
+        SplayNode( const Comparable & ele, SplayNode *lt, SplayNode *rt )
+          : element_{ ele }, left_{ lt }, right_{ rt } { }
+
+        SplayNode( Comparable && ele, SplayNode *lt, SplayNode *rt )
+          : element_{ std::move( ele ) }, left_{ lt }, right_{ rt } { }
+    };
+
+    SplayNode *root_;
+
+    /**
+     * Internal method to insert x, splaying its key first.
+     */
+    template <typename X>
+    void insertNode( X && x )
+    {
+        if( root_ == nullptr )
+        {
+            root_ = new SplayNode{ std::forward<X>( x ), nullptr, nullptr };
+            return;
+        }
+        int recursion_calls = 0;
+        if( splay( x.getRecSequence( ), root_, recursion_calls ) )
+        {
+            root_->element_.Merge( std::forward<X>( x ) );
+            return;
+        }
+        SplayNode *new_node = new SplayNode{ std::forward<X>( x ), nullptr, nullptr };
+        if( new_node->element_ < root_->element_ )
+        {
+            new_node->left_ = root_->left_;
+            new_node->right_ = root_;
+            root_->left_ = nullptr;
+        }
+        else
+        {
+            new_node->right_ = root_->right_;
+            new_node->left_ = root_;
+            root_->right_ = nullptr;
+        }
+        root_ = new_node;
+    }
+
+    /**
+     * Internal method to perform a top-down splay of the non-empty subtree t. The node with key x, or the last node
+     * on x's search path, becomes the new root of t. recursion_calls is increased by the number of nodes compared
+     * against. Returns true if x is found.
+     */
+    static bool splay( const std::string & x, SplayNode * & t, int & recursion_calls )
+    {
+        SplayNode *left_root = nullptr, *right_root = nullptr;
+        SplayNode **left_hook = &left_root;     // Where the next node joins the tree of keys less than x
+        SplayNode **right_hook = &right_root;   // Where the next node joins the tree of keys greater than x
+        for( ;; )
+        {
+            ++recursion_calls;
+            if( x < t->element_.getRecSequence( ) )
+            {
+                if( t->left_ == nullptr )
+                    break;
+                if( x < t->left_->element_.getRecSequence( ) )    // Zig-zig: rotate with left child
+                {
+                    ++recursion_calls;
+                    SplayNode *child = t->left_;
+                    t->left_ = child->right_;
+                    child->right_ = t;
+                    t = child;
+                    if( t->left_ == nullptr )
+                        break;
+                }
+                *right_hook = t;                                // Link right
+                right_hook = &t->left_;
+                t = t->left_;
+            }
+            else if( t->element_.getRecSequence( ) < x )
+            {
+                if( t->right_ == nullptr )
+                    break;
+                if( t->right_->element_.getRecSequence( ) < x )   // Zag-zag: rotate with right child
+                {
+                    ++recursion_calls;
+                    SplayNode *child = t->right_;
+                    t->right_ = child->left_;
+                    child->left_ = t;
+                    t = child;
+                    if( t->right_ == nullptr )
+                        break;
+                }
+                *left_hook = t;                                 // Link left
+                left_hook = &t->right_;
+                t = t->right_;
+            }
+            else
+                break;
+        }
+        *left_hook = t->left_;                                  // Reassemble
+        *right_hook = t->right_;
+        t->left_ = left_root;
+        t->right_ = right_root;
+        return t->element_.getRecSequence( ) == x;
+    }
+
+    /**
+     * Internal method to clone subtree.
+     */
+    SplayNode * clone( SplayNode *t ) const
+    {
+        return ParallelFold<SplayNode *>( t, 0, [ ]( SplayNode *node, int, SplayNode *lt, SplayNode *rt )
+            { return new SplayNode{ node->element_, lt, rt }; } );
+    }
+
+    void print_Between( const std::string & str1, const std::string & str2, const SplayNode *t ) const
+    {
+        if( t != nullptr )
+        {
+            if( t->element_.getRecSequence( ) > str1 )
+                print_Between( str1, str2, t->left_ );
+            if( t->element_.getRecSequence( ) > str1 && t->element_.getRecSequence( ) < str2 )
+                std::cout << t->element_ << " ";
+            if( t->element_.getRecSequence( ) <= str2 )
+                print_Between( str1, str2, t->right_ );
+        }
+    }
+};
+
+#endif
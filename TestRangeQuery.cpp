@@ -6,6 +6,7 @@
  Usage: TestRangeQuery <database filename> <key1> <key2> where key1 and key2 are recognition sequences
  Build with: make TestRangeQuery
  Modifications:
+    10.19.2026: The database loader moves each SequenceMap into the tree instead of copying it.
  */
 
 #include <iostream>
@@ -82,7 +83,7 @@ void FillTree (std::string db_filename, TreeType &a_tree) {
         an_enz_acro = GetEnzymeAcronym(db_line, first_slash);
         while (GetNextRecognitionSequence(db_line, a_reco_seq, first_slash)) {
             SequenceMap new_sequence_map(a_reco_seq, an_enz_acro);
-            a_tree.insert(new_sequence_map);
+            a_tree.insert(std::move(new_sequence_map));
         }
     }
 }
@@ -4,20 +4,172 @@
  Created on: March 1st, 2016
  Description: This is a test program that makes use of a parser to input data from a file and into a BST or AVL tree. 
         Data about the tree is printed to the screen, such as the number of nodes and the average depth. 
- Usage: TestTrees <database filename> <queries filename> <flag>,  where <flag> is either "BST" or "AVL"
+ Usage: TestTrees <database filename> <queries filename> <flag> [options],  where <flag> is either "BST", "AVL", "INLINE", "HASH", "SPLAY", "RB", "DISK", "BUFFERED" or "SKIP"
+        Options: -filter   Repeat search_Sequences() with the tree's membership filter enabled and report its effect.
+                 -threads=N  Answer the queries of search_Sequences() on N threads. Counts match the serial run.
+                 -stats    Print the tree's per-operation latency and probe-depth statistics as JSON at the end.
+                           Only BST, AVL and RB record them, and only when built with -DTREE_STATS. DISK prints
+                           its buffer pool's counters instead.
+                 -memory=MB  Let the DISK tree keep at most MB megabytes of pages in memory (default 64).
+                 -buffer=N   Let the BUFFERED tree hold up to N keys in its write buffer (default 4096).
+                 -sorted   Have search_Sequences() sort the queries and answer them in key order, with a cursor
+                           on trees that have one (BST and AVL), keeping each answer in its query's place.
  Build with: make TestTrees
  Modifications:
     3.6.2016, Emma Kimlin: Added search_Sequences() and remove_Sequences(). 
     3.8.2016 Made class TestTree so that this is neater. 
+    10.19.2026: Added the HASH tree type.
+    10.19.2026: Added the -filter option.
+    10.19.2026: Added the INLINE tree type (AVL with inline keys and cold payloads).
+    10.19.2026: Added the -threads=N option.
+    10.19.2026: Added the SPLAY tree type.
+    10.19.2026: Added the RB (red-black) tree type.
+    10.19.2026: Added the -stats option.
+    10.19.2026: Added the DISK tree type (DiskBPlusTree) and the -memory=MB option. FillTree() uses the tree's bulk
+                loader when it has one.
+    10.19.2026: Added the BUFFERED tree type (BufferedAvlTree) and the -buffer=N option.
+    10.19.2026: Added the SKIP tree type (LockFreeSkipList).
+    10.19.2026: Added the -sorted option.
+    10.19.2026: FillTree() moves each SequenceMap into the tree instead of copying it.
  */
 
 #include <iostream>
 #include <string>
 #include <fstream>
 #include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
 #include "SequenceMap.h"
 #include "BinarySearchTree.h"
 #include "AvlTree.h"
+#include "InlineKeyAvlTree.h"
+#include "HashTable.h"
+#include "SplayTree.h"
+#include "RedBlackTree.h"
+#include "DiskBPlusTree.h"
+#include "BufferedAvlTree.h"
+#include "LockFreeSkipList.h"
+#include "WorkStealingPool.h"
+#include <type_traits>
+
+/**
+  * Optional switches given after the tree type on the command line.
+ */
+struct TestOptions {
+    bool use_filter = false;        // -filter
+    int threads = 1;                // -threads=N
+    bool dump_stats = false;        // -stats
+    size_t memory_budget = 0;       // -memory=MB, in bytes; 0 leaves the tree's default
+    size_t buffer_capacity = 0;     // -buffer=N; 0 leaves the tree's default
+    bool sorted = false;            // -sorted
+};
+
+/**
+  * Turns on the tree's membership filter and reports its size in bits per key.
+  * Post-Condition: Returns false, and leaves a_tree alone, for tree types that have no filter.
+ */
+template <typename TreeType>
+auto EnableFilter(TreeType& a_tree, double& bits_per_key, int) -> decltype(a_tree.enable_Filter(), bool()) {
+    a_tree.enable_Filter();
+    bits_per_key = a_tree.filter_Bits_Per_Key();
+    return true;
+}
+template <typename TreeType>
+bool EnableFilter(TreeType&, double&, long) {
+    return false;
+}
+
+/**
+  * Limits the memory a disk-backed tree keeps its pages in. Post-Condition: Returns false for in-memory trees.
+ */
+template <typename TreeType>
+auto SetMemoryBudget(TreeType& a_tree, size_t bytes, int) -> decltype(a_tree.set_Memory_Budget(bytes), bool()) {
+    a_tree.set_Memory_Budget(bytes);
+    return true;
+}
+template <typename TreeType>
+bool SetMemoryBudget(TreeType&, size_t, long) {
+    return false;
+}
+
+/**
+  * Sets how many keys a write-buffered tree holds before merging them. Post-Condition: Returns false for trees
+  * without a write buffer.
+ */
+template <typename TreeType>
+auto SetBufferCapacity(TreeType& a_tree, size_t keys, int) -> decltype(a_tree.set_Buffer_Capacity(keys), bool()) {
+    a_tree.set_Buffer_Capacity(keys);
+    return true;
+}
+template <typename TreeType>
+bool SetBufferCapacity(TreeType&, size_t, long) {
+    return false;
+}
+
+/**
+  * Answers queries[ order[ i ] ] for i in [ first, last ), storing each answer and its recursion calls at the
+  * query's own index. Uses one Cursor for the whole range if the tree has them, so each find() starts where the
+  * previous one ended.
+ */
+template <typename TreeType>
+auto FindInOrder(TreeType& a_tree, const std::vector<std::string>& queries, const std::vector<size_t>& order,
+                 size_t first, size_t last, std::vector<char>& found, std::vector<int>& calls, int)
+    -> decltype(typename TreeType::Cursor(), void()) {
+    typename TreeType::Cursor cursor;
+    for (size_t i = first; i < last; i++)
+        found[order[i]] = a_tree.find(queries[order[i]], calls[order[i]], cursor);
+}
+template <typename TreeType>
+void FindInOrder(TreeType& a_tree, const std::vector<std::string>& queries, const std::vector<size_t>& order,
+                 size_t first, size_t last, std::vector<char>& found, std::vector<int>& calls, long) {
+    for (size_t i = first; i < last; i++)
+        found[order[i]] = a_tree.find(queries[order[i]], calls[order[i]]);
+}
+
+/**
+  * Adds elements to a tree by insert(), for FillTree() on trees without a bulk loader.
+ */
+template <typename TreeType>
+struct InsertLoader {
+    TreeType& a_tree;
+    void add(SequenceMap&& x) { a_tree.insert(std::move(x)); }
+    void finish() {}
+};
+
+/**
+  * Returns the tree's bulk loader if it has one, which builds the tree when finish() is called, else an
+  * InsertLoader. Either way the tree ends up holding the same elements.
+ */
+template <typename TreeType>
+auto MakeLoader(TreeType& a_tree, int) -> decltype(a_tree.bulk_Loader()) {
+    return a_tree.bulk_Loader();
+}
+template <typename TreeType>
+InsertLoader<TreeType> MakeLoader(TreeType& a_tree, long) {
+    return InsertLoader<TreeType>{a_tree};
+}
+
+/**
+  * Writes the tree's operation statistics as JSON, or says that this tree type keeps none.
+ */
+template <typename TreeType>
+auto DumpStats(const TreeType& a_tree, int) -> decltype(a_tree.dump_stats(std::cout), void()) {
+    a_tree.dump_stats(std::cout);
+}
+template <typename TreeType>
+void DumpStats(const TreeType&, long) {
+    std::cout << "This tree type keeps no operation statistics." << std::endl;
+}
+
+/**
+  * True if TreeType::find() can be called on a const tree, so that several threads may search it at once.
+  * Self-adjusting trees such as SplayTree restructure themselves on find() and are searched on one thread.
+ */
+template <typename TreeType, typename = void>
+struct HasConstFind : std::false_type {};
+template <typename TreeType>
+struct HasConstFind<TreeType, std::void_t<decltype(std::declval<const TreeType&>().find(std::declval<const std::string&>(), std::declval<int&>()))> > : std::true_type {};
 
 template <typename TreeType>
 class TestTree {
@@ -25,7 +177,7 @@ public:
     /**
       * One Parameter Constructor
      */
-    TestTree(std::string database, std::string query) : db_filename(database), query_filename(query) {
+    TestTree(std::string database, std::string query, TestOptions opts = TestOptions()) : db_filename(database), query_filename(query), options(opts) {
         CheckFile();
         FillTree();
     }
@@ -38,7 +190,15 @@ public:
 private:
     std::string db_filename;
     std::string query_filename;
+    TestOptions options;
     TreeType a_tree;
+    /**
+      * Totals from one pass of search_Sequences(). probed_misses counts failed queries that reached the tree.
+     */
+    struct SearchResult {
+        int success_query_count = 0, total_queries = 0, probed_misses = 0;
+        double seconds = 0;
+    };
     /**
       * Takes the input from db_filename, parses it and stores it in either an AVL Tree or BST made of
       *     SequenceMap objects.
@@ -69,7 +229,27 @@ private:
     /**
       * Searches a_tree for each sequence in file and returns total number of successful queries.  
      */
-    void search_Sequences();
+    SearchResult search_Sequences();
+
+    /**
+      * search_Sequences() for options.threads > 1: the queries are read into memory, split into blocks and answered
+      * by a WorkStealingPool against the shared, unmodified tree. Each thread keeps its own counters, which are
+      * summed at the end, so the totals equal those of the serial run.
+     */
+    SearchResult search_Sequences_Parallel();
+
+    /**
+      * search_Sequences() for options.sorted: the queries are read into memory and sorted, and answered in key order
+      * through FindInOrder(), on options.threads threads if the tree allows it, each taking runs of the sorted
+      * queries. The answers are kept in the original order and the totals equal those of the unsorted run.
+     */
+    SearchResult search_Sequences_Sorted();
+
+    /**
+      * Enables the tree's membership filter, repeats search_Sequences() and compares it with the unfiltered pass.
+      * Prints the filter's false positive rate, memory per key and the speed-up.
+     */
+    void compare_Filter(const SearchResult& unfiltered);
 
     /** 
       * Removes every other sequence in file from the tree. Prints the total number of successfull removes.
@@ -79,25 +259,73 @@ private:
 };
 
 int main(int argc, char **argv) {
-    if (argc != 4) {
-        cout << "Usage: " << argv[0] << " <databasefilename> <queryfilename> <tree-type>" << endl;
+    if (argc < 4) {
+        cout << "Usage: " << argv[0] << " <databasefilename> <queryfilename> <tree-type> [-filter] [-threads=N] [-stats] [-memory=MB] [-buffer=N] [-sorted]" << endl;
         return 0;
     }
     string db_filename(argv[1]);
     string query_filename(argv[2]);
     string param_tree(argv[3]);
+    TestOptions options;
+    for (int i = 4; i < argc; i++) {
+        string option(argv[i]);
+        if (option == "-filter")
+            options.use_filter = true;
+        else if (option.compare(0, 9, "-threads=") == 0 && atoi(option.c_str() + 9) > 0)
+            options.threads = atoi(option.c_str() + 9);
+        else if (option == "-stats")
+            options.dump_stats = true;
+        else if (option.compare(0, 8, "-memory=") == 0 && atof(option.c_str() + 8) > 0)
+            options.memory_budget = size_t(atof(option.c_str() + 8) * (1 << 20));
+        else if (option.compare(0, 8, "-buffer=") == 0 && atol(option.c_str() + 8) > 0)
+            options.buffer_capacity = atol(option.c_str() + 8);
+        else if (option == "-sorted")
+            options.sorted = true;
+        else {
+            cout << "Unknown option " << option << endl;
+            return 0;
+        }
+    }
     cout << "Input file is " << db_filename << ", and query file is " << query_filename << endl;
     
     if (param_tree == "BST") {
         std::cout << "I will run the BST code" << std::endl;
-        TestTree<BinarySearchTree<SequenceMap> > a_tree(db_filename, query_filename);
+        TestTree<BinarySearchTree<SequenceMap> > a_tree(db_filename, query_filename, options);
         a_tree.TestQueryTree();
     } else if (param_tree == "AVL") {
         std::cout << "I will run the AVL code" << std::endl;
-        TestTree<AvlTree<SequenceMap> > a_tree(db_filename, query_filename);
+        TestTree<AvlTree<SequenceMap> > a_tree(db_filename, query_filename, options);
+        a_tree.TestQueryTree();
+    } else if (param_tree == "INLINE") {
+        std::cout << "I will run the INLINE code" << std::endl;
+        TestTree<InlineKeyAvlTree<SequenceMap> > a_tree(db_filename, query_filename, options);
+        a_tree.TestQueryTree();
+    } else if (param_tree == "HASH") {
+        std::cout << "I will run the HASH code" << std::endl;
+        TestTree<HashTable<SequenceMap> > a_tree(db_filename, query_filename, options);
+        a_tree.TestQueryTree();
+    } else if (param_tree == "SPLAY") {
+        std::cout << "I will run the SPLAY code" << std::endl;
+        TestTree<SplayTree<SequenceMap> > a_tree(db_filename, query_filename, options);
+        a_tree.TestQueryTree();
+    } else if (param_tree == "RB") {
+        std::cout << "I will run the RB code" << std::endl;
+        TestTree<RedBlackTree<SequenceMap> > a_tree(db_filename, query_filename, options);
+        a_tree.TestQueryTree();
+    } else if (param_tree == "DISK") {
+        std::cout << "I will run the DISK code" << std::endl;
+        TestTree<DiskBPlusTree<SequenceMap> > a_tree(db_filename, query_filename, options);
+        a_tree.TestQueryTree();
+    } else if (param_tree == "BUFFERED") {
+        std::cout << "I will run the BUFFERED code" << std::endl;
+        TestTree<BufferedAvlTree<SequenceMap> > a_tree(db_filename, query_filename, options);
+        a_tree.TestQueryTree();
+    } else if (param_tree == "SKIP") {
+        std::cout << "I will run the SKIP code" << std::endl;
+        TestTree<LockFreeSkipList<SequenceMap> > a_tree(db_filename, query_filename, options);
         a_tree.TestQueryTree();
     } else
-        std::cout << "Unknown tree type " << param_tree << " (User should provide BST, or AVL)" << std::endl;
+        std::cout << "Unknown tree type " << param_tree << " (User should provide BST, AVL, INLINE, HASH, SPLAY, RB, DISK, BUFFERED, or SKIP)" << std::endl;
     return 0;
 }
 
@@ -111,6 +339,11 @@ void TestTree<TreeType>::CheckFile() {
 }
 template <typename TreeType>
 void TestTree<TreeType>::FillTree () {
+    if (options.memory_budget > 0 && !SetMemoryBudget(a_tree, options.memory_budget, 0))
+        std::cout << "This tree type is kept in memory; -memory has no effect." << std::endl;
+    if (options.buffer_capacity > 0 && !SetBufferCapacity(a_tree, options.buffer_capacity, 0))
+        std::cout << "This tree type has no write buffer; -buffer has no effect." << std::endl;
+    auto loader = MakeLoader(a_tree, 0);
     ifstream inStream(db_filename);
     std::string db_line, an_enz_acro, a_reco_seq, garbage_line;
     for (int i = 0; i < 10; i ++)                               //Skip over the header and begin reading on line 11. 
@@ -121,9 +354,10 @@ void TestTree<TreeType>::FillTree () {
         an_enz_acro = GetEnzymeAcronym(db_line, first_slash);
         while (GetNextRecognitionSequence(db_line, a_reco_seq, first_slash)) {
             SequenceMap new_sequence_map(a_reco_seq, an_enz_acro);
-            a_tree.insert(new_sequence_map);
+            loader.add(std::move(new_sequence_map));
         }
     }
+    loader.finish();
 }
 template <typename TreeType>
 std::string TestTree<TreeType>::GetEnzymeAcronym(std::string db_line, size_t first_slash) {
@@ -150,31 +384,163 @@ void TestTree<TreeType>::TestQueryTree()
     std::cout << "This tree has " << a_tree.count_Nodes() << " nodes.\n";
     std::cout << "The Average Depth of this tree is " << a_tree.calculate_Avg_Depth() << ".\n";
     std::cout << "The ratio of the average depth to log2n is " << a_tree.calculate_ratio() <<".\n";
-    search_Sequences();
+    SearchResult unfiltered = search_Sequences();
+    if (options.use_filter)
+        compare_Filter(unfiltered);
     remove_Sequences();
     std::cout << "After remove_Sequences(): \n";
     std::cout << "This tree has " << a_tree.count_Nodes() << " nodes.\n"; 
     std::cout << "The Average Depth of this tree is " << a_tree.calculate_Avg_Depth() << ".\n";
     std::cout << "The ratio of the average depth to log2n is " << a_tree.calculate_ratio() <<".\n";
+    if (options.dump_stats)
+        DumpStats(a_tree, 0);
 }
 
 template <typename TreeType>
-void TestTree<TreeType>::search_Sequences()
+typename TestTree<TreeType>::SearchResult TestTree<TreeType>::search_Sequences()
 {
+    if (options.sorted)
+        return search_Sequences_Sorted();
+    if constexpr (HasConstFind<TreeType>::value) {
+        if (options.threads > 1)
+            return search_Sequences_Parallel();
+    } else if (options.threads > 1)
+        std::cout << "This tree type changes on find(), so search_Sequences() runs on one thread." << std::endl;
     ifstream inStream(query_filename);
     std::string sequence;
     int success_query_count = 0, total_queries = 0, recursion_calls = 0, sum_recursion_calls = 0, avg_recursion_calls;
+    SearchResult result;
+    auto start = std::chrono::steady_clock::now();
     while(std::getline(inStream, sequence)) {
         if (sequence.empty()) continue;
         total_queries++;
         if (a_tree.find(sequence, recursion_calls)) 
             success_query_count++;
+        else if (recursion_calls > 0)
+            result.probed_misses++;
         sum_recursion_calls += recursion_calls; 
     }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.success_query_count = success_query_count;
+    result.total_queries = total_queries;
     avg_recursion_calls = sum_recursion_calls / total_queries;
     std::cout << "The number of sucessful queries was " << success_query_count << "." << std::endl;
     std::cout << "The total number of queries was " << total_queries << "." << std::endl;
     std::cout << "The average number of recursion calls for search_Sequences() was " << avg_recursion_calls << "." << std::endl;
+    return result;
+}
+
+template <typename TreeType>
+typename TestTree<TreeType>::SearchResult TestTree<TreeType>::search_Sequences_Parallel()
+{
+    struct alignas(64) Counters {                           //One cache line per thread, so counting does not contend
+        int success_query_count = 0, probed_misses = 0, sum_recursion_calls = 0;
+    };
+    ifstream inStream(query_filename);
+    std::string sequence;
+    std::vector<std::string> queries;
+    while (std::getline(inStream, sequence))
+        if (!sequence.empty())
+            queries.push_back(sequence);
+
+    WorkStealingPool pool(options.threads - 1);             //The calling thread works too
+    std::vector<Counters> counters(pool.slot_Count());
+    const TreeType& shared_tree = a_tree;
+    auto start = std::chrono::steady_clock::now();
+    pool.parallel_For(0, queries.size(), 1024, [&](size_t first, size_t last, size_t slot) {
+        Counters& mine = counters[slot];
+        int recursion_calls = 0;
+        for (size_t i = first; i < last; i++) {
+            if (shared_tree.find(queries[i], recursion_calls))
+                mine.success_query_count++;
+            else if (recursion_calls > 0)
+                mine.probed_misses++;
+            mine.sum_recursion_calls += recursion_calls;
+        }
+    });
+    SearchResult result;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int sum_recursion_calls = 0;
+    for (size_t i = 0; i < counters.size(); i++) {
+        result.success_query_count += counters[i].success_query_count;
+        result.probed_misses += counters[i].probed_misses;
+        sum_recursion_calls += counters[i].sum_recursion_calls;
+    }
+    result.total_queries = queries.size();
+    std::cout << "The number of sucessful queries was " << result.success_query_count << "." << std::endl;
+    std::cout << "The total number of queries was " << result.total_queries << "." << std::endl;
+    std::cout << "The average number of recursion calls for search_Sequences() was " << sum_recursion_calls / result.total_queries << "." << std::endl;
+    std::cout << "search_Sequences() used " << options.threads << " threads and took " << result.seconds * 1000 << " ms." << std::endl;
+    return result;
+}
+
+template <typename TreeType>
+typename TestTree<TreeType>::SearchResult TestTree<TreeType>::search_Sequences_Sorted()
+{
+    ifstream inStream(query_filename);
+    std::string sequence;
+    std::vector<std::string> queries;
+    while (std::getline(inStream, sequence))
+        if (!sequence.empty())
+            queries.push_back(sequence);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<size_t> order(queries.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&queries](size_t lhs, size_t rhs) { return queries[lhs] < queries[rhs]; });
+    std::vector<char> found(queries.size());
+    std::vector<int> calls(queries.size());
+    int threads = options.threads;
+    if constexpr (HasConstFind<TreeType>::value) {
+        if (threads > 1) {
+            WorkStealingPool pool(threads - 1);             //The calling thread works too
+            const TreeType& shared_tree = a_tree;
+            pool.parallel_For(0, queries.size(), 1024, [&](size_t first, size_t last, size_t) {
+                FindInOrder(shared_tree, queries, order, first, last, found, calls, 0);
+            });
+        }
+    } else if (threads > 1) {
+        std::cout << "This tree type changes on find(), so search_Sequences() runs on one thread." << std::endl;
+        threads = 1;
+    }
+    if (threads == 1)
+        FindInOrder(a_tree, queries, order, 0, queries.size(), found, calls, 0);
+    SearchResult result;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long sum_recursion_calls = 0;
+    for (size_t i = 0; i < queries.size(); i++) {              //In the original order
+        if (found[i])
+            result.success_query_count++;
+        else if (calls[i] > 0)
+            result.probed_misses++;
+        sum_recursion_calls += calls[i];
+    }
+    result.total_queries = queries.size();
+    std::cout << "The number of sucessful queries was " << result.success_query_count << "." << std::endl;
+    std::cout << "The total number of queries was " << result.total_queries << "." << std::endl;
+    std::cout << "The average number of recursion calls for search_Sequences() was " << sum_recursion_calls / result.total_queries << "." << std::endl;
+    std::cout << "search_Sequences() answered the queries in sorted order on " << threads << " threads in "
+              << result.seconds * 1000 << " ms, sorting included." << std::endl;
+    return result;
+}
+
+template <typename TreeType>
+void TestTree<TreeType>::compare_Filter(const SearchResult& unfiltered)
+{
+    double bits_per_key = 0;
+    if (!EnableFilter(a_tree, bits_per_key, 0)) {
+        std::cout << "This tree type has no membership filter." << std::endl;
+        return;
+    }
+    std::cout << "With the membership filter enabled: " << std::endl;
+    SearchResult filtered = search_Sequences();
+    int misses = filtered.total_queries - filtered.success_query_count;
+    std::cout << "The filter passed " << filtered.probed_misses << " of " << misses << " missing sequences to the tree "
+              << "(false positive rate " << (misses > 0 ? double(filtered.probed_misses) / misses : 0.0) << ")." << std::endl;
+    std::cout << "The filter uses " << bits_per_key << " bits per key." << std::endl;
+    std::cout << "search_Sequences() took " << filtered.seconds * 1000 << " ms with the filter and "
+              << unfiltered.seconds * 1000 << " ms without it (speed-up " << unfiltered.seconds / filtered.seconds << "x)." << std::endl;
 }
 
 template <typename TreeType>
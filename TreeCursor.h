@@ -0,0 +1,93 @@
+/*
+ Title: TreeCursor.h
+ Description: A finger into a binary search tree without parent links, for answering lookups that arrive in or
+        near key order. The cursor keeps the path from the root to the node its last search ended at, and with
+        each node on it the open key range its subtree covers. The next search climbs the path only until it
+        reaches a subtree whose range holds the new key, then descends from there, so consecutive keys that lie
+        close together in the tree cost a few steps rather than a walk from the root. Over a sorted batch of m keys
+        in a balanced tree of n the climbs and descents add up to O( m log( n / m ) ) instead of O( m log n ).
+        The path points into the tree, so any change to the tree invalidates the cursor; a cursor used on a tree
+        whose root has changed starts over from the root, but other changes are not detected.
+ Modifications:
+ */
+#ifndef TREE_CURSOR_H
+#define TREE_CURSOR_H
+
+#include <string>
+#include <vector>
+
+// TreeCursor class
+//
+// CONSTRUCTION: zero parameter; the trees name it as their Cursor type
+//
+// ******************PUBLIC OPERATIONS*********************
+// seek( r, x, i )        --> Return the node with key x in the tree rooted at r, or nullptr, searching from where
+//                            the last seek( ) ended; i is the number of nodes climbed past and visited
+// void reset( )          --> Forget the path, so the next seek( ) starts at the root
+// ******************ERRORS********************************
+// None. Node must have element_, left_ and right_, and element_ a getRecSequence( ) key.
+
+template <typename Node>
+class TreeCursor
+{
+  public:
+    TreeCursor( ) : root_{ nullptr }
+      { }
+
+    const Node * seek( const Node *root, const std::string & x, int & steps )
+    {
+        if( root != root_ )
+        {
+            path_.clear( );
+            root_ = root;
+        }
+        while( !path_.empty( ) && !covers( path_.back( ), x ) )
+        {
+            path_.pop_back( );
+            ++steps;
+        }
+        if( path_.empty( ) )
+            path_.push_back( Frame{ root, nullptr, nullptr } );
+        for( ;; )
+        {
+            const Frame & frame = path_.back( );
+            ++steps;
+            if( frame.node_ == nullptr )
+            {
+                path_.pop_back( );      // The parent's range still covers x, and so does the next search's, often
+                return nullptr;
+            }
+            const std::string & key = frame.node_->element_.getRecSequence( );
+            if( x < key )
+                path_.push_back( Frame{ frame.node_->left_, frame.lower_, &key } );
+            else if( key < x )
+                path_.push_back( Frame{ frame.node_->right_, &key, frame.upper_ } );
+            else
+                return frame.node_;
+        }
+    }
+
+    void reset( )
+    {
+        path_.clear( );
+        root_ = nullptr;
+    }
+
+  private:
+    struct Frame
+    {
+        const Node *node_;
+        const std::string *lower_;      // The subtree holds keys strictly between *lower_ and *upper_;
+        const std::string *upper_;      // nullptr is unbounded
+    };
+
+    const Node *root_;
+    std::vector<Frame> path_;           // From the root down to where the last search ended
+
+    static bool covers( const Frame & frame, const std::string & x )
+    {
+        return ( frame.lower_ == nullptr || *frame.lower_ < x ) && ( frame.upper_ == nullptr || x < *frame.upper_ );
+    }
+};
+
+#endif
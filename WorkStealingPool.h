@@ -0,0 +1,255 @@
+/*
+ Title: WorkStealingPool.h
+ Description: A fixed set of worker threads, each with its own task deque. A worker runs its own newest task first
+        and, when its deque is empty, steals the oldest task of another worker, so blocks of uneven cost even out
+        without a central queue. A thread waiting on a TaskGroup runs that group's queued tasks instead of blocking,
+        so groups may be waited on from inside tasks. It never runs another group's task, which might need a lock
+        the waiting thread holds. Tasks must not throw.
+ Modifications:
+    10.19.2026: TaskGroup::wait( ) runs only its own group's tasks, so a thread holding a lock cannot pick up another
+                caller's task that takes the same lock.
+ */
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// WorkStealingPool class
+//
+// CONSTRUCTION: with the number of worker threads; 0 runs every task on the thread that waits for it
+//
+// ******************PUBLIC OPERATIONS*********************
+// size_t slot_Count( )   --> Return number of threads that may run tasks: the workers plus outside callers
+// size_t current_Slot( ) --> Return the calling thread's slot, in [ 0, slot_Count( ) )
+// parallel_For( b, e, n, f )-> Call f( first, last, slot ) on blocks of at most n indices covering [ b, e ),
+//                            and return when all have finished
+// TaskGroup g( pool )    --> A set of tasks to wait for:
+//     g.run( f )         --> Queue task f
+//     g.wait( )          --> Run g's queued tasks until every task of g has finished
+// ******************ERRORS********************************
+// None
+
+class WorkStealingPool
+{
+  public:
+    class TaskGroup
+    {
+      public:
+        explicit TaskGroup( WorkStealingPool & pool ) : pool_( pool ), pending_{ 0 }
+          { }
+
+        TaskGroup( const TaskGroup & rhs ) = delete;
+        TaskGroup & operator=( const TaskGroup & rhs ) = delete;
+
+        ~TaskGroup( )
+        {
+            wait( );
+        }
+
+        template <typename Task>
+        void run( Task task )
+        {
+            pending_.fetch_add( 1, std::memory_order_relaxed );
+            pool_.push( this, [ this, task ]( ) mutable
+            {
+                task( );
+                pending_.fetch_sub( 1, std::memory_order_release );
+            } );
+        }
+
+        /**
+          * Runs this group's queued tasks until every task of this group has finished. Tasks of other groups are
+          * left to the workers.
+         */
+        void wait( )
+        {
+            size_t slot = pool_.current_Slot( );
+            while( pending_.load( std::memory_order_acquire ) > 0 )
+                if( !pool_.runOne( slot, this ) )
+                    std::this_thread::yield( );
+        }
+
+      private:
+        WorkStealingPool & pool_;
+        std::atomic<long> pending_;
+    };
+
+    explicit WorkStealingPool( size_t num_threads ) : stop_{ false }, queued_{ 0 }
+    {
+        for( size_t i = 0; i <= num_threads; ++i )
+            queues_.emplace_back( new TaskQueue );
+        for( size_t i = 0; i < num_threads; ++i )
+            workers_.emplace_back( [ this, i ]( ) { workerLoop( i ); } );
+    }
+
+    WorkStealingPool( const WorkStealingPool & rhs ) = delete;
+    WorkStealingPool & operator=( const WorkStealingPool & rhs ) = delete;
+
+    ~WorkStealingPool( )
+    {
+        {
+            std::lock_guard<std::mutex> guard{ sleep_lock_ };
+            stop_ = true;
+        }
+        wake_.notify_all( );
+        for( std::thread & worker : workers_ )
+            worker.join( );
+    }
+
+    size_t slot_Count( ) const
+    {
+        return queues_.size( );
+    }
+
+    /**
+      * Returns the calling worker's index, or workers_.size( ) for any thread outside the pool.
+     */
+    size_t current_Slot( ) const
+    {
+        return current_pool( ) == this ? current_slot( ) : workers_.size( );
+    }
+
+    /**
+      * Splits [ begin, end ) into blocks of at most block_size indices and calls body( first, last, slot ) on each,
+      * where slot is the current_Slot( ) of the thread running the block. Returns when every block is done.
+     */
+    template <typename Body>
+    void parallel_For( size_t begin, size_t end, size_t block_size, Body body )
+    {
+        TaskGroup group{ *this };
+        block_size = std::max<size_t>( block_size, 1 );
+        for( size_t first = begin; first < end; first += block_size )
+        {
+            size_t last = std::min( end, first + block_size );
+            group.run( [ this, first, last, &body ]( ) { body( first, last, current_Slot( ) ); } );
+        }
+        group.wait( );
+    }
+
+  private:
+    struct Task
+    {
+        const TaskGroup *group_;
+        std::function<void( )> run_;
+    };
+
+    struct TaskQueue
+    {
+        std::mutex lock_;
+        std::deque<Task> tasks_;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues_;   // One per worker, then one shared by outside threads
+    std::vector<std::thread> workers_;
+    bool stop_;                                         // Guarded by sleep_lock_
+    std::atomic<long> queued_;
+    std::mutex sleep_lock_;
+    std::condition_variable wake_;
+
+    static const WorkStealingPool * & current_pool( )
+    {
+        static thread_local const WorkStealingPool *pool = nullptr;
+        return pool;
+    }
+
+    static size_t & current_slot( )
+    {
+        static thread_local size_t slot = 0;
+        return slot;
+    }
+
+    /**
+     * Internal method to queue group's task on the calling thread's deque and wake a sleeping worker.
+     */
+    void push( const TaskGroup *group, std::function<void( )> task )
+    {
+        TaskQueue & queue = *queues_[ current_Slot( ) ];
+        {
+            std::lock_guard<std::mutex> guard{ queue.lock_ };
+            queue.tasks_.push_back( Task{ group, std::move( task ) } );
+        }
+        queued_.fetch_add( 1 );
+        {
+            std::lock_guard<std::mutex> guard{ sleep_lock_ };
+        }
+        wake_.notify_one( );
+    }
+
+    /**
+     * Internal method to run one task: the newest on slot's own deque, else the oldest on another deque. If group
+     * is not nullptr only that group's tasks are taken. Returns false if there was none.
+     */
+    bool runOne( size_t slot, const TaskGroup *group = nullptr )
+    {
+        std::function<void( )> task;
+        for( size_t i = 0; i < queues_.size( ) && !task; ++i )
+        {
+            TaskQueue & queue = *queues_[ ( slot + i ) % queues_.size( ) ];
+            std::lock_guard<std::mutex> guard{ queue.lock_ };
+            if( queue.tasks_.empty( ) )
+                continue;
+            if( group == nullptr )
+            {
+                Task & taken = i == 0 ? queue.tasks_.back( ) : queue.tasks_.front( );
+                task = std::move( taken.run_ );
+                if( i == 0 )
+                    queue.tasks_.pop_back( );
+                else
+                    queue.tasks_.pop_front( );
+                continue;
+            }
+            if( i == 0 )        // Newest first, as above; a group's own tasks are usually at the back
+            {
+                auto found = std::find_if( queue.tasks_.rbegin( ), queue.tasks_.rend( ),
+                                           [ group ]( const Task & t ) { return t.group_ == group; } );
+                if( found != queue.tasks_.rend( ) )
+                {
+                    task = std::move( found->run_ );
+                    queue.tasks_.erase( std::next( found ).base( ) );
+                }
+            }
+            else
+            {
+                auto found = std::find_if( queue.tasks_.begin( ), queue.tasks_.end( ),
+                                           [ group ]( const Task & t ) { return t.group_ == group; } );
+                if( found != queue.tasks_.end( ) )
+                {
+                    task = std::move( found->run_ );
+                    queue.tasks_.erase( found );
+                }
+            }
+        }
+        if( !task )
+            return false;
+        queued_.fetch_sub( 1 );
+        task( );
+        return true;
+    }
+
+    void workerLoop( size_t slot )
+    {
+        current_pool( ) = this;
+        current_slot( ) = slot;
+        for( ;; )
+        {
+            if( runOne( slot ) )
+                continue;
+            std::unique_lock<std::mutex> guard{ sleep_lock_ };
+            wake_.wait( guard, [ this ]( ) { return stop_ || queued_.load( ) > 0; } );
+            if( stop_ )
+                return;
+        }
+    }
+};
+
+#endif